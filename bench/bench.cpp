@@ -0,0 +1,2528 @@
+#include "smbios.h"
+#include "wmisession.h"
+#include "snapshot.h"
+#include "fleet.h"
+#include "edid.h"
+#include "threadpool.h"
+#include "registry.h"
+#include "hardwareinfo.h"
+#include "hive.h"
+#include "usb.h"
+#include "trace.h"
+#include "textutil.h"
+#include "serialclass.h"
+#include "fingerprint.h"
+#include "serialindex.h"
+#include "consoleview.h"
+#include "cpuprobe.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <malloc.h>
+#include <map>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+
+#pragma comment(lib, "psapi.lib")
+#else
+#include <unistd.h>
+#endif
+
+static std::atomic<size_t> allocationcount{0};
+static std::atomic<size_t> allocatedbytes{0};
+static std::atomic<size_t> livebytes{0};
+
+static size_t blocksize(void* p) {
+#ifdef _WIN32
+    return _msize(p);
+#else
+    return malloc_usable_size(p);
+#endif
+}
+
+void* operator new(size_t size) {
+    allocationcount.fetch_add(1, std::memory_order_relaxed);
+    allocatedbytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = malloc(size ? size : 1)) {
+        livebytes.fetch_add(blocksize(p), std::memory_order_relaxed);
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+static void release(void* p) {
+    if (!p) return;
+    livebytes.fetch_sub(blocksize(p), std::memory_order_relaxed);
+    free(p);
+}
+
+static void (*volatile releasehook)(void*) = release;
+
+void operator delete(void* p) noexcept {
+    releasehook(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete[](void* p) noexcept {
+    operator delete(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+// correctness checks run alongside the timings; any that fails makes the run exit nonzero
+static size_t checkfailures = 0;
+
+static void expect(bool ok, const char* what) {
+    if (ok) return;
+    checkfailures++;
+    fprintf(stderr, "check failed: %s\n", what);
+}
+
+static size_t residentbytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return counters.WorkingSetSize;
+    return 0;
+#else
+    unsigned long pages = 0;
+    unsigned long resident = 0;
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    if (fscanf(file, "%lu %lu", &pages, &resident) != 2) resident = 0;
+    fclose(file);
+    return (size_t)resident * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+struct fixture {
+    std::string name;
+    std::vector<uint8_t> data;
+};
+
+static void appendstructure(std::vector<uint8_t>& table, uint8_t type, uint16_t handle,
+    const std::vector<uint8_t>& body, const std::vector<std::string>& strings) {
+    table.push_back(type);
+    table.push_back((uint8_t)(4 + body.size()));
+    table.push_back((uint8_t)(handle & 0xFF));
+    table.push_back((uint8_t)(handle >> 8));
+    table.insert(table.end(), body.begin(), body.end());
+    
+    for (const auto& s : strings) {
+        table.insert(table.end(), s.begin(), s.end());
+        table.push_back(0);
+    }
+    if (strings.empty()) table.push_back(0);
+    table.push_back(0);
+}
+
+static std::vector<uint8_t> synthesizetable(int memorydevices, int processors) {
+    std::vector<uint8_t> table;
+    uint16_t handle = 0;
+    
+    appendstructure(table, 0, handle++, std::vector<uint8_t>(20, 0x01), {"American Megatrends International, LLC.", "F.62", "07/14/2025"});
+    
+    std::vector<uint8_t> system(23, 0);
+    system[0] = 1; system[1] = 2; system[2] = 3; system[3] = 4;
+    for (int i = 0; i < 16; i++) system[4 + i] = (uint8_t)(i * 17);
+    appendstructure(table, 1, handle++, system, {"Micro-Star International Co., Ltd.", "MS-7D75", "1.0", "To Be Filled By O.E.M."});
+    
+    appendstructure(table, 2, handle++, std::vector<uint8_t>{1, 2, 3, 4, 0, 0x09, 0, 0, 0, 0x0A, 0}, {"Micro-Star International Co., Ltd.", "MAG B650 TOMAHAWK WIFI", "1.0", "07D7511_N41E123456"});
+    appendstructure(table, 3, handle++, std::vector<uint8_t>{1, 0x03, 2, 3, 4, 3, 3, 3, 2}, {"Micro-Star International Co., Ltd.", "1.0", "Default string", "Default string"});
+    
+    for (int i = 0; i < processors; i++) {
+        appendstructure(table, 4, handle++, std::vector<uint8_t>(44, 0x02), {"CPU" + std::to_string(i), "Advanced Micro Devices, Inc.", "AMD EPYC 9654 96-Core Processor", "Unknown", "Unknown", "Unknown"});
+    }
+    
+    appendstructure(table, 16, handle++, std::vector<uint8_t>(19, 0x00), {});
+    
+    for (int i = 0; i < memorydevices; i++) {
+        std::vector<uint8_t> body(36, 0);
+        body[12] = 1; body[13] = 2; body[19] = 3; body[20] = 4; body[21] = 5; body[22] = 6;
+        char serial[16];
+        snprintf(serial, sizeof(serial), "%08X", 0x80AD0000u + (unsigned)i);
+        appendstructure(table, 17, handle++, body, {"P0_Node0_Channel" + std::to_string(i % 12) + "_Dimm" + std::to_string(i / 12), "P0 CHANNEL " + std::to_string(i % 12), "Samsung", serial, "M321R8GA0BB0-CQKZJ", "Unknown"});
+    }
+    
+    appendstructure(table, 127, handle++, {}, {});
+    return table;
+}
+
+static std::vector<fixture> loadcorpus(const char* directory) {
+    std::vector<fixture> corpus;
+    std::error_code ec;
+    
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory, ec)) {
+        if (!entry.is_regular_file()) continue;
+        
+        std::ifstream file(entry.path(), std::ios::binary);
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        
+        size_t offset = 0;
+        size_t length = 0;
+        if (!locatesmbiostable(data.data(), data.size(), offset, length)) continue;
+        
+        corpus.push_back({entry.path().filename().string(), std::vector<uint8_t>(data.begin() + offset, data.begin() + offset + length)});
+    }
+    
+    return corpus;
+}
+
+static void benchsmbios(const std::vector<fixture>& corpus, int iterations) {
+    printf("%-28s %8s %10s %12s %12s %14s\n", "table", "bytes", "structs", "ns/table", "MB/s", "allocs/table");
+    
+    for (const auto& f : corpus) {
+        smbiostable table;
+        size_t structures = 0;
+        size_t checksum = 0;
+        
+        size_t allocationsbefore = allocationcount.load();
+        auto start = std::chrono::steady_clock::now();
+        
+        for (int i = 0; i < iterations; i++) {
+            table.parse(f.data.data(), f.data.size());
+            structures = table.size();
+            for (const auto& s : table.bytype(17)) {
+                checksum += s.stringat(0x14).size();
+            }
+        }
+        
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        size_t allocations = allocationcount.load() - allocationsbefore;
+        
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations;
+        double mbps = ns > 0 ? (double)f.data.size() / ns * 1000.0 : 0.0;
+        
+        printf("%-28s %8zu %10zu %12.0f %12.1f %14.2f\n", f.name.c_str(), f.data.size(), structures, ns, mbps,
+            (double)allocations / iterations);
+        
+        if (checksum == (size_t)-1) printf("\n");
+    }
+}
+
+static std::unique_ptr<wmiprovider> makewmifixture(fakewmiprovider*& raw) {
+    auto provider = std::make_unique<fakewmiprovider>();
+    provider->addrow(L"Win32_BaseBoard", {{L"SerialNumber", L"07D7511_N41E123456"}, {L"Manufacturer", L"Micro-Star International Co., Ltd."},
+        {L"Product", L"MAG B650 TOMAHAWK WIFI"}, {L"Version", L"1.0"}});
+    provider->addrow(L"Win32_ComputerSystemProduct", {{L"IdentifyingNumber", L"To Be Filled By O.E.M."}, {L"Vendor", L"Micro-Star International Co., Ltd."},
+        {L"Name", L"MS-7D75"}, {L"Version", L"1.0"}});
+    raw = provider.get();
+    return provider;
+}
+
+static const std::vector<std::pair<std::wstring, std::vector<std::wstring>>> wmilookups = {
+    {L"Win32_BaseBoard", {L"SerialNumber", L"Manufacturer", L"Product", L"Version"}},
+    {L"Win32_ComputerSystemProduct", {L"IdentifyingNumber", L"Vendor", L"Name", L"Version"}},
+};
+
+// the session against the fake provider: one connect however many lookups, one query per class when batched,
+// nothing asked twice, and the values the fixture rows hold
+static size_t checkwmi() {
+    size_t checked = 0;
+    
+    fakewmiprovider* raw = nullptr;
+    std::unique_ptr<wmiprovider> fixture = makewmifixture(raw);
+    std::vector<wmirow> expected;
+    for (const auto& lookup : wmilookups) {
+        std::vector<wmirow> rows;
+        raw->query(lookup.first, lookup.second, rows);
+        expected.push_back(rows.empty() ? wmirow() : rows[0]);
+    }
+    raw->querycount = 0;
+    
+    wmisession batched(std::move(fixture));
+    for (size_t i = 0; i < wmilookups.size(); i++) {
+        expect(batched.getproperties(wmilookups[i].first, wmilookups[i].second) == expected[i], "batched wmi values match the fixture rows");
+        checked++;
+    }
+    expect(raw->connectcount == 1, "a pooled wmi session connects once");
+    expect(raw->querycount == wmilookups.size() && batched.roundtrips() == wmilookups.size(), "a batched wmi scan makes one query per class");
+    checked += 2;
+    
+    for (const auto& lookup : wmilookups) {
+        for (const auto& property : lookup.second) batched.getproperty(lookup.first, property);
+    }
+    expect(batched.roundtrips() == wmilookups.size(), "wmi values already read are not queried again");
+    checked++;
+    
+    wmisession single(makewmifixture(raw));
+    size_t properties = 0;
+    for (size_t i = 0; i < wmilookups.size(); i++) {
+        for (const auto& property : wmilookups[i].second) {
+            expect(single.getproperty(wmilookups[i].first, property) == expected[i].at(property), "pooled wmi values match the fixture rows");
+            properties++;
+            checked++;
+        }
+    }
+    expect(raw->connectcount == 1 && raw->querycount == properties, "a pooled wmi session makes one query per property and connects once");
+    checked++;
+    
+    // a failed connection is not retried within a scan, and is once reset starts the next one
+    std::unique_ptr<wmiprovider> down = makewmifixture(raw);
+    raw->setavailable(false);
+    wmisession offline(std::move(down));
+    offline.getproperty(L"Win32_BaseBoard", L"SerialNumber");
+    offline.getproperty(L"Win32_BaseBoard", L"Product");
+    expect(raw->connectcount == 1 && raw->querycount == 0, "a failed wmi connection is tried once per scan");
+    raw->setavailable(true);
+    offline.reset();
+    expect(offline.getproperty(L"Win32_BaseBoard", L"SerialNumber") == L"07D7511_N41E123456" && raw->connectcount == 2,
+        "a reset wmi session connects again");
+    checked += 2;
+    
+    return checked;
+}
+
+static void benchwmi(int iterations) {
+    const auto& lookups = wmilookups;
+    
+    printf("\n%-28s %12s %12s %14s\n", "wmi", "connects", "queries", "ns/scan");
+    
+    auto run = [&](const char* name, bool pooled, bool batched) {
+        size_t connects = 0;
+        size_t queries = 0;
+        size_t checksum = 0;
+        
+        auto start = std::chrono::steady_clock::now();
+        
+        for (int i = 0; i < iterations; i++) {
+            fakewmiprovider* raw = nullptr;
+            std::unique_ptr<wmisession> session = std::make_unique<wmisession>(makewmifixture(raw));
+            
+            for (const auto& lookup : lookups) {
+                if (batched) {
+                    checksum += session->getproperties(lookup.first, lookup.second).size();
+                    continue;
+                }
+                
+                for (const auto& property : lookup.second) {
+                    if (!pooled) {
+                        session = std::make_unique<wmisession>(makewmifixture(raw));
+                    }
+                    checksum += session->getproperty(lookup.first, property).size();
+                    if (!pooled) {
+                        connects += raw->connectcount;
+                        queries += raw->querycount;
+                    }
+                }
+            }
+            
+            if (pooled) {
+                connects += raw->connectcount;
+                queries += raw->querycount;
+            }
+        }
+        
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / iterations;
+        
+        printf("%-28s %12.2f %12.2f %14.0f\n", name, (double)connects / iterations, (double)queries / iterations, ns);
+        if (checksum == (size_t)-1) printf("\n");
+    };
+    
+    run("per-property bring-up", false, false);
+    run("pooled session", true, false);
+    run("pooled session, batched", true, true);
+    
+    size_t failures = checkfailures;
+    size_t checked = checkwmi();
+    printf("%-28s %12zu %12s %14zu\n", "session checks", checked, "failed", checkfailures - failures);
+}
+
+static snapshot synthesizesnapshot(int disks, int adapters, int usbdevices, uint32_t seed) {
+    snapshot snap;
+    snap.host = "bench-" + std::to_string(seed);
+    
+    auto serial = [&](int i) {
+        char buffer[24];
+        snprintf(buffer, sizeof(buffer), "S%07X%08X", (unsigned)i, seed * 2654435761u + (unsigned)i);
+        return std::string(buffer);
+    };
+    
+    snap.add({"bios", "baseboard", "serial", serial(0), ""});
+    snap.add({"bios", "system", "uuid", "4C4C4544-0042-3510-8052-" + serial(1).substr(0, 12), ""});
+    
+    for (int i = 0; i < disks; i++) {
+        std::string n = std::to_string(i);
+        snap.add({"disk", "disk", "serial_" + n, serial(100 + i), "physical drive " + n});
+        snap.add({"disk", "disk", "model_" + n, "samsung ssd 990 pro 2tb", "physical drive " + n});
+    }
+    
+    for (int i = 0; i < adapters; i++) {
+        snap.add({"nic", "nic", "mac", serial(10000 + i).substr(0, 12), "adapter " + std::to_string(i)});
+    }
+    
+    for (int i = 0; i < usbdevices; i++) {
+        snap.add({"usb", "usb", "serial", serial(20000 + i), "USB\\VID_046D&PID_C52B"});
+    }
+    
+    return snap;
+}
+
+static bool samesnapshot(const snapshot& a, const snapshot& b) {
+    if (a.host != b.host || a.timestamp != b.timestamp || a.size() != b.size()) return false;
+    
+    const auto& left = a.records().records();
+    const auto& right = b.records().records();
+    for (size_t i = 0; i < left.size(); i++) {
+        if (left[i].section != right[i].section || left[i].category != right[i].category || left[i].name != right[i].name ||
+            left[i].value != right[i].value || left[i].notes != right[i].notes) return false;
+    }
+    
+    return true;
+}
+
+// a snapshot survives encode/decode, and a known edit diffs to exactly its three changes
+static size_t checksnapshot() {
+    size_t checked = 0;
+    
+    snapshot baseline = synthesizesnapshot(4, 2, 8, 1);
+    baseline.timestamp = 1700000000;
+    std::vector<uint8_t> encoded = baseline.encode();
+    snapshot decoded;
+    expect(decoded.decode(encoded.data(), encoded.size()), "snapshot decodes its own encoding");
+    expect(samesnapshot(decoded, baseline), "decode(encode(x)) equals x");
+    expect(diffsnapshots(baseline, decoded).empty(), "round tripped snapshot diffs clean");
+    checked += 3;
+    
+    // usb serial 3 changes, nic mac 1 goes missing, a ninth usb serial shows up
+    snapshot current;
+    current.host = baseline.host;
+    uint32_t usbseen = 0;
+    uint32_t nicseen = 0;
+    std::string changedbefore;
+    std::string removedbefore;
+    for (const auto& record : baseline.records().records()) {
+        if (record.category == "usb" && usbseen++ == 3) {
+            changedbefore = std::string(record.value);
+            current.add({record.section, record.category, record.name, "SPOOFED0003", record.notes});
+            continue;
+        }
+        if (record.category == "nic" && nicseen++ == 1) {
+            removedbefore = std::string(record.value);
+            continue;
+        }
+        current.add(record);
+    }
+    current.add({"usb", "usb", "serial", "ADDED0008", "USB\\VID_046D&PID_C52B"});
+    
+    std::vector<snapshotchange> changes = diffsnapshots(baseline, current);
+    expect(changes.size() == 3, "edited snapshot diffs to three changes");
+    
+    auto find = [&](const char* category, const char* name, uint32_t instance) -> const snapshotchange* {
+        for (const auto& change : changes) {
+            if (change.category == category && change.name == name && change.instance == instance) return &change;
+        }
+        return nullptr;
+    };
+    
+    const snapshotchange* changed = find("usb", "serial", 3);
+    expect(changed && changed->kind == snapshotchangekind::changed && changed->before == changedbefore && changed->after == "SPOOFED0003",
+        "usb serial 3 diffs as changed");
+    const snapshotchange* removed = find("nic", "mac", 1);
+    expect(removed && removed->kind == snapshotchangekind::removed && removed->before == removedbefore && removed->after.empty(),
+        "nic mac 1 diffs as removed");
+    const snapshotchange* added = find("usb", "serial", 8);
+    expect(added && added->kind == snapshotchangekind::added && added->before.empty() && added->after == "ADDED0008",
+        "usb serial 8 diffs as added");
+    checked += 4;
+    
+    return checked;
+}
+
+static void benchsnapshot(int iterations) {
+    printf("\n%-28s %8s %10s %12s %12s %12s\n", "snapshot", "records", "bytes", "ns/encode", "ns/decode", "ns/diff");
+    
+    const int shapes[][3] = {{4, 2, 8}, {64, 16, 256}, {2048, 256, 8192}};
+    
+    for (const auto& shape : shapes) {
+        snapshot baseline = synthesizesnapshot(shape[0], shape[1], shape[2], 1);
+        snapshot current = synthesizesnapshot(shape[0], shape[1], shape[2], (uint32_t)shape[0]);
+        int rounds = std::max(1, iterations / (int)(baseline.size() / 16 + 1));
+        
+        size_t bytes = 0;
+        size_t checksum = 0;
+        
+        auto start = std::chrono::steady_clock::now();
+        std::vector<uint8_t> encoded;
+        for (int i = 0; i < rounds; i++) {
+            encoded = baseline.encode();
+            bytes = encoded.size();
+        }
+        auto encodeelapsed = std::chrono::steady_clock::now() - start;
+        
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            snapshot decoded;
+            decoded.decode(encoded.data(), encoded.size());
+            checksum += decoded.size();
+        }
+        auto decodeelapsed = std::chrono::steady_clock::now() - start;
+        
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            checksum += diffsnapshots(baseline, current).size();
+        }
+        auto diffelapsed = std::chrono::steady_clock::now() - start;
+        
+        auto perround = [&](std::chrono::steady_clock::duration elapsed) {
+            return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / rounds;
+        };
+        
+        std::string name = "synthetic-" + std::to_string(baseline.size());
+        printf("%-28s %8zu %10zu %12.0f %12.0f %12.0f\n", name.c_str(), baseline.size(), bytes,
+            perround(encodeelapsed), perround(decodeelapsed), perround(diffelapsed));
+        
+        if (checksum == (size_t)-1) printf("\n");
+    }
+    
+    size_t failures = checkfailures;
+    size_t checked = checksnapshot();
+    printf("%-28s %8zu %10s %12zu\n", "round trip + diff checks", checked, "failed", checkfailures - failures);
+}
+
+// the item the collectors returned before the record store: four wide strings, each its own allocation
+struct legacyitem {
+    std::wstring category;
+    std::wstring name;
+    std::wstring value;
+    std::wstring notes;
+};
+
+static void benchrecordstore(int machines) {
+    std::vector<snapshot> scans(machines);
+    std::vector<std::vector<std::pair<std::string, legacyitem>>> sources(machines);
+    for (int m = 0; m < machines; m++) {
+        scans[m] = synthesizesnapshot(8, 4, 32, (uint32_t)m + 1);
+        for (const auto& record : scans[m].records().records()) {
+            sources[m].push_back({std::string(record.section),
+                {utf8towide(record.category), utf8towide(record.name), utf8towide(record.value), utf8towide(record.notes)}});
+        }
+    }
+    
+    printf("\n%-28s %10s %12s %12s %12s %12s %12s\n", "aggregate", "machines", "records", "allocs", "heap KB", "rss KB", "ns/record");
+    
+    auto report = [&](const char* name, size_t records, size_t allocations, size_t heap, size_t rss, std::chrono::steady_clock::duration elapsed) {
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (double)std::max<size_t>(records, 1);
+        printf("%-28s %10d %12zu %12zu %12zu %12zu %12.1f\n", name, machines, records, allocations, heap / 1024, rss / 1024, ns);
+    };
+    
+    {
+        size_t allocationsbefore = allocationcount.load();
+        size_t heapbefore = livebytes.load();
+        size_t rssbefore = residentbytes();
+        auto start = std::chrono::steady_clock::now();
+        
+        std::vector<recordstore> stores(machines);
+        size_t records = 0;
+        for (int m = 0; m < machines; m++) {
+            for (const auto& record : scans[m].records().records()) {
+                stores[m].add(record);
+            }
+            records += stores[m].size();
+        }
+        
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        report("recordstore", records, allocationcount.load() - allocationsbefore, livebytes.load() - heapbefore,
+            residentbytes() - std::min(rssbefore, residentbytes()), elapsed);
+    }
+    
+    {
+        size_t allocationsbefore = allocationcount.load();
+        size_t heapbefore = livebytes.load();
+        size_t rssbefore = residentbytes();
+        auto start = std::chrono::steady_clock::now();
+        
+        std::vector<std::vector<std::pair<std::string, legacyitem>>> results(machines);
+        size_t records = 0;
+        for (int m = 0; m < machines; m++) {
+            for (const auto& source : sources[m]) {
+                results[m].push_back({source.first, source.second});
+            }
+            records += results[m].size();
+        }
+        
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        report("vector<legacyitem>", records, allocationcount.load() - allocationsbefore, livebytes.load() - heapbefore,
+            residentbytes() - std::min(rssbefore, residentbytes()), elapsed);
+    }
+}
+
+static void benchfleet(int hosts) {
+    std::error_code ec;
+    std::filesystem::path root = std::filesystem::temp_directory_path(ec) / ("udbench-fleet-" + std::to_string(hosts));
+    std::filesystem::remove_all(root, ec);
+    std::filesystem::create_directories(root, ec);
+    
+    for (int h = 0; h < hosts; h++) {
+        snapshot snap = synthesizesnapshot(8, 4, 32, (uint32_t)(h % (hosts / 2 + 1)) + 1);
+        snap.host = "host-" + std::to_string(h);
+        snap.save((root / (snap.host + ".snap")).string());
+    }
+    
+    printf("\n%-28s %10s %12s %12s %12s %12s\n", "fleet", "hosts", "records", "collisions", "ms", "speedup");
+    
+    double baseline = 0;
+    for (size_t threads = 1; threads <= threadpool::defaultthreadcount(); threads *= 2) {
+        fleetoptions options;
+        options.threads = threads;
+        
+        auto start = std::chrono::steady_clock::now();
+        fleetreport report = scanfleet(root.string(), options);
+        double ms = (double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+        if (threads == 1) baseline = ms;
+        
+        std::string name = std::to_string(threads) + " threads";
+        printf("%-28s %10zu %12zu %12zu %12.1f %12.2f\n", name.c_str(), report.hosts, report.records, report.collisions.size(),
+            ms, ms > 0 ? baseline / ms : 0.0);
+    }
+    
+    std::filesystem::remove_all(root, ec);
+}
+
+static void benchindex(int identifiers) {
+    std::error_code ec;
+    std::filesystem::path path = std::filesystem::temp_directory_path(ec) / ("udbench-index-" + std::to_string(identifiers) + ".idx");
+    
+    // a disk serial per identifier, one in ten of them reported again by another host
+    size_t hostcount = std::max(1, identifiers / 40);
+    auto serial = [](uint64_t n) {
+        char text[24];
+        snprintf(text, sizeof(text), "WD-WX%016llX", (unsigned long long)(n * 0x9E3779B97F4A7C15ull));
+        return std::string(text);
+    };
+    
+    std::vector<std::string> hosts(hostcount);
+    std::vector<std::string> sources(hostcount);
+    for (size_t h = 0; h < hostcount; h++) {
+        hosts[h] = "host-" + std::to_string(h);
+        sources[h] = hosts[h] + ".snap";
+    }
+    
+    printf("\n%-28s %12s %12s %10s %12s %12s %12s\n", "serial index", "identifiers", "postings", "runs", "ms", "peak heap mb", "file mb");
+    
+    const size_t memory = (size_t)32 << 20;
+    serialindexstats stats;
+    size_t peak = 0;
+    size_t heapbefore = livebytes.load();
+    auto start = std::chrono::steady_clock::now();
+    {
+        serialindexwriter writer(path.string(), memory, 1);
+        std::mt19937 random(23);
+        for (int i = 0; i < identifiers; i++) {
+            uint64_t n = i % 10 == 9 ? random() % (uint64_t)(i + 1) : (uint64_t)i;
+            writer.add(0, 4, (uint32_t)((size_t)i / 40 % hostcount), (uint32_t)((size_t)i / 40 % hostcount), serial(n));
+            if ((i & 0xFFFF) == 0) peak = std::max(peak, livebytes.load() - heapbefore);
+        }
+        peak = std::max(peak, livebytes.load() - heapbefore);
+        writer.finish(hosts, sources, stats);
+    }
+    double ms = (double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+    printf("%-28s %12llu %12llu %10llu %12.1f %12.1f %12.1f\n", "build, 32mb limit", (unsigned long long)stats.identifiers,
+        (unsigned long long)stats.postings, (unsigned long long)stats.runs, ms, peak / 1048576.0, stats.bytes / 1048576.0);
+    
+    serialindex index;
+    if (!index.open(path.string())) {
+        printf("could not open %s\n", path.string().c_str());
+        return;
+    }
+    
+    printf("%-28s %12s %12s %12s %12s\n", "query", "queries", "ns/query", "matches", "allocs/query");
+    
+    auto measure = [&](const char* name, int queries, auto&& query) {
+        std::mt19937 random(29);
+        size_t matches = 0;
+        size_t allocationsbefore = allocationcount.load();
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < queries; i++) matches += query(random);
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+        printf("%-28s %12d %12.1f %12zu %12.3f\n", name, queries, ns / queries, matches, (double)(allocationcount.load() - allocationsbefore) / queries);
+    };
+    
+    int queries = std::min(identifiers, 1000000);
+    std::vector<std::string> known(4096);
+    std::vector<std::string> missing(4096);
+    std::vector<std::string> prefixes(4096);
+    for (size_t i = 0; i < known.size(); i++) {
+        known[i] = serial((uint64_t)(i * 7919) % (uint64_t)identifiers);
+        missing[i] = "ZZ" + known[i];
+        prefixes[i] = known[i].substr(0, 9);
+    }
+    
+    measure("lookup, present", queries, [&](std::mt19937& random) { return index.lookup(known[random() % known.size()]).size(); });
+    measure("lookup, absent", queries, [&](std::mt19937& random) { return index.lookup(missing[random() % missing.size()]).size(); });
+    measure("prefix, 10 matches", queries, [&](std::mt19937& random) { return index.prefix(prefixes[random() % prefixes.size()], 10).size(); });
+    
+    index.close();
+    std::filesystem::remove(path, ec);
+}
+
+static void sealblock(uint8_t* block) {
+    uint8_t sum = 0;
+    for (int i = 0; i < 127; i++) sum += block[i];
+    block[127] = (uint8_t)(0x100 - sum);
+}
+
+static void writedescriptor(uint8_t* d, uint8_t tag, const std::string& text) {
+    memset(d, 0, 18);
+    d[3] = tag;
+    memset(d + 5, ' ', 13);
+    memcpy(d + 5, text.data(), std::min<size_t>(text.size(), 13));
+    if (text.size() < 13) d[5 + text.size()] = 0x0A;
+}
+
+static std::vector<uint8_t> synthesizeedid(int variant, uint32_t serial) {
+    std::vector<uint8_t> edid(variant >= 2 ? 256 : 128, 0);
+    const uint8_t header[8] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+    memcpy(edid.data(), header, 8);
+    
+    edid[8] = 0x10; edid[9] = 0xAC;
+    edid[10] = 0xF1; edid[11] = 0xA0;
+    memcpy(&edid[12], &serial, 4);
+    edid[16] = 12; edid[17] = 33; edid[18] = 1; edid[19] = 4;
+    
+    uint8_t* dtd = &edid[54];
+    dtd[0] = 0x02; dtd[1] = 0x3A; dtd[2] = 0x80; dtd[4] = 0x70; dtd[5] = 0x38; dtd[7] = 0x40;
+    
+    char text[16];
+    snprintf(text, sizeof(text), "%08X", serial);
+    writedescriptor(&edid[72], 0xFD, "");
+    edid[72 + 5] = 48; edid[72 + 6] = 144; edid[72 + 7] = 30; edid[72 + 8] = 160; edid[72 + 9] = 60;
+    writedescriptor(&edid[90], 0xFC, "DELL U2723QE");
+    writedescriptor(&edid[108], variant == 1 || variant == 3 ? 0x10 : 0xFF, variant == 1 || variant == 3 ? "" : text);
+    
+    if (variant >= 2) {
+        edid[126] = 1;
+        uint8_t* block = &edid[128];
+        
+        if (variant == 2) {
+            block[0] = 0x02; block[1] = 0x03; block[2] = 4 + 8; block[3] = 0xF0;
+            uint8_t vsdb[8] = {(uint8_t)((3 << 5) | 7), 0x03, 0x0C, 0x00, 0x10, 0x00, 0x00, 0x00};
+            memcpy(block + 4, vsdb, 8);
+            uint8_t* cta = block + 12;
+            cta[0] = 0x02; cta[1] = 0x3A; cta[2] = 0x80; cta[4] = 0x70; cta[5] = 0x38; cta[7] = 0x40;
+        } else {
+            block[0] = 0x70;
+            uint8_t* section = block + 1;
+            section[0] = 0x12; section[1] = 3 + 12 + 8; section[2] = 0x03;
+            uint8_t* product = section + 4;
+            product[0] = 0x00; product[1] = 0x00; product[2] = 12 + 8;
+            memcpy(product + 3, "DEL", 3);
+            product[6] = 0xF1; product[7] = 0xA0;
+            memcpy(product + 8, &serial, 4);
+            product[12] = 12; product[13] = 33; product[14] = 8;
+            memcpy(product + 15, "U2723QE ", 8);
+        }
+        
+        sealblock(block);
+    }
+    
+    sealblock(edid.data());
+    return edid;
+}
+
+static void benchedid(int count, int iterations, const char* corpusdir) {
+    std::vector<std::vector<uint8_t>> corpus;
+    std::error_code ec;
+    
+    if (corpusdir) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(corpusdir, ec)) {
+            if (!entry.is_regular_file()) continue;
+            std::ifstream file(entry.path(), std::ios::binary);
+            std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (data.size() >= 128) corpus.push_back(std::move(data));
+        }
+    }
+    
+    if (corpus.empty()) {
+        for (int i = 0; i < count; i++) {
+            corpus.push_back(synthesizeedid(i % 4, 0x4A3B0000u + (uint32_t)i));
+        }
+    }
+    
+    size_t serials = 0;
+    size_t valid = 0;
+    size_t bytes = 0;
+    int rounds = std::max(1, iterations / 100);
+    
+    size_t allocationsbefore = allocationcount.load();
+    auto start = std::chrono::steady_clock::now();
+    
+    edidinfo info;
+    for (int r = 0; r < rounds; r++) {
+        for (const auto& edid : corpus) {
+            if (!decodeedid(edid.data(), edid.size(), info)) continue;
+            valid += info.checksumvalid;
+            serials += !edidserial(info).empty();
+            bytes += edid.size();
+        }
+    }
+    
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    size_t decoded = corpus.size() * (size_t)rounds;
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / (double)decoded;
+    
+    printf("\n%-28s %10s %12s %12s %12s %14s\n", "edid", "edids", "with serial", "checksum ok", "ns/edid", "allocs/edid");
+    printf("%-28s %10zu %12zu %12zu %12.1f %14.2f\n", corpusdir ? "corpus" : "synthetic", corpus.size(), serials / rounds, valid / rounds,
+        ns, (double)(allocationcount.load() - allocationsbefore) / (double)decoded);
+    
+    if (bytes == (size_t)-1) printf("\n");
+}
+
+static const wchar_t* benchcpukey = L"HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0";
+static const wchar_t* benchgpukey = L"SYSTEM\\CurrentControlSet\\Control\\Class\\{4d36e968-e325-11ce-bfc1-08002be10318}";
+static const wchar_t* benchnickey = L"SYSTEM\\CurrentControlSet\\Control\\Class\\{4D36E972-E325-11CE-BFC1-08002BE10318}";
+static const wchar_t* benchdisplaykey = L"SYSTEM\\CurrentControlSet\\Enum\\DISPLAY";
+
+static std::unique_ptr<fakeregistry> makeregistryfixture() {
+    auto registry = std::make_unique<fakeregistry>();
+    
+    registry->setstring(benchcpukey, L"ProcessorNameString", L"AMD Ryzen 9 7950X 16-Core Processor           ");
+    registry->setstring(benchcpukey, L"VendorIdentifier", L"AuthenticAMD");
+    registry->setstring(benchcpukey, L"Identifier", L"AMD64 Family 25 Model 97 Stepping 2");
+    registry->setdword(benchcpukey, L"~MHz", 4500);
+    
+    for (int i = 0; i < 3; i++) {
+        wchar_t name[8];
+        swprintf(name, 8, L"%04d", i);
+        std::wstring path = std::wstring(benchgpukey) + L"\\" + name;
+        registry->setstring(path, L"DriverDesc", i == 0 ? L"NVIDIA GeForce RTX 4080" : L"Microsoft Basic Display Adapter");
+        registry->setstring(path, L"DriverVersion", L"31.0.15.5176");
+        registry->setstring(path, L"DriverDate", L"2-13-2024");
+    }
+    registry->addkey(std::wstring(benchgpukey) + L"\\Configuration");
+    registry->addkey(std::wstring(benchgpukey) + L"\\Properties");
+    
+    for (int i = 0; i < 24; i++) {
+        wchar_t name[8];
+        swprintf(name, 8, L"%04d", i);
+        std::wstring path = std::wstring(benchnickey) + L"\\" + name;
+        registry->setstring(path, L"DriverDesc", L"WAN Miniport (IP)");
+        if (i % 8 == 0) registry->setstring(path, L"NetworkAddress", L"0A1B2C3D4E" + std::to_wstring(10 + i));
+    }
+    registry->addkey(std::wstring(benchnickey) + L"\\Properties");
+    
+    for (int m = 0; m < 3; m++) {
+        std::wstring monitor = std::wstring(benchdisplaykey) + L"\\DEL41" + std::to_wstring(m);
+        for (int i = 0; i < 2; i++) {
+            std::wstring instance = monitor + L"\\5&2a1b3c" + std::to_wstring(i) + L"&0&UID" + std::to_wstring(4352 + i);
+            registry->setbinary(instance + L"\\Device Parameters", L"EDID", synthesizeedid((m + i) % 4, 0x4A3B0000u + (uint32_t)(m * 2 + i)));
+        }
+    }
+    
+    return registry;
+}
+
+static std::wstring legacystring(registryprovider& registry, const std::wstring& path, const std::wstring& name) {
+    registrykey key;
+    if (!registry.openkey(registryroot, path, key)) return L"n/a";
+    
+    registryvalue value;
+    bool found = registry.queryvalue(key, name, value) && registry.queryvalue(key, name, value);
+    registry.closekey(key);
+    return found ? registrystring(value) : L"n/a";
+}
+
+// values, when given, collects what was read in the order the session collectors report it
+static size_t legacyscan(registryprovider& registry, std::vector<std::string>* values = nullptr) {
+    size_t found = 0;
+    auto keep = [&](const std::wstring& text) {
+        if (values) values->push_back(widetoutf8(text));
+    };
+    
+    for (const wchar_t* name : {L"ProcessorNameString", L"VendorIdentifier", L"Identifier"}) {
+        std::wstring text = legacystring(registry, benchcpukey, name);
+        found += text != L"n/a";
+        keep(text);
+    }
+    
+    registrykey key;
+    registryvalue value;
+    if (registry.openkey(registryroot, benchcpukey, key)) {
+        bool mhz = registry.queryvalue(key, L"~MHz", value);
+        found += mhz;
+        if (mhz && value.type == registryvaluetype::dword && value.number > 0) keep(std::to_wstring(value.number));
+        registry.closekey(key);
+    }
+    
+    for (const wchar_t* classkey : {benchgpukey, benchnickey}) {
+        bool gpu = classkey == benchgpukey;
+        std::vector<std::wstring> subkeys;
+        if (!registry.openkey(registryroot, classkey, key)) continue;
+        registry.enumeratesubkeys(key, subkeys);
+        
+        for (const auto& subkey : subkeys) {
+            if (subkey[0] != L'0') continue;
+            std::wstring path = std::wstring(classkey) + L"\\" + subkey;
+            
+            std::wstring first = legacystring(registry, path, gpu ? L"DriverDesc" : L"NetworkAddress");
+            if (first == L"n/a" || first.empty()) continue;
+            
+            if (gpu) {
+                std::wstring version = legacystring(registry, path, L"DriverVersion");
+                std::wstring date = legacystring(registry, path, L"DriverDate");
+                found += version.size() + date.size() > 0;
+                keep(first);
+                keep(version);
+                keep(date);
+            } else {
+                std::wstring description = legacystring(registry, path, L"DriverDesc");
+                found += !description.empty();
+                asciilower(first);
+                keep(first);
+                keep(description);
+            }
+        }
+        
+        registry.closekey(key);
+    }
+    
+    registrykey displaykey;
+    if (registry.openkey(registryroot, benchdisplaykey, displaykey)) {
+        std::vector<std::wstring> monitors;
+        registry.enumeratesubkeys(displaykey, monitors);
+        
+        for (const auto& monitor : monitors) {
+            registrykey monitorkey;
+            if (!registry.openkey(displaykey, monitor, monitorkey)) continue;
+            
+            std::vector<std::wstring> instances;
+            registry.enumeratesubkeys(monitorkey, instances);
+            
+            for (const auto& instance : instances) {
+                registrykey instancekey;
+                registrykey paramskey;
+                if (!registry.openkey(monitorkey, instance, instancekey)) continue;
+                
+                if (registry.openkey(instancekey, L"Device Parameters", paramskey)) {
+                    if (registry.queryvalue(paramskey, L"EDID", value) && registry.queryvalue(paramskey, L"EDID", value)) {
+                        edidinfo info;
+                        bool decoded = decodeedid(value.data.data(), value.data.size(), info);
+                        found += decoded;
+                        std::string serial = decoded ? edidserial(info) : "";
+                        asciiupper(serial);
+                        if (!serial.empty() && values) values->push_back(serial);
+                    }
+                    registry.closekey(paramskey);
+                }
+                
+                registry.closekey(instancekey);
+            }
+            
+            registry.closekey(monitorkey);
+        }
+        
+        registry.closekey(displaykey);
+    }
+    
+    return found;
+}
+
+static size_t sessionscan(hardwareinfo& hwinfo) {
+    size_t found = hwinfo.getprocessorinfo().size();
+    found += hwinfo.getvideocontrollerinfo().size();
+    found += hwinfo.getnetworkadapterinfo().size();
+    found += hwinfo.getmonitorinfo().size();
+    hwinfo.endscan();
+    return found;
+}
+
+// the session collectors over the fixture: the same values the per value reads found, for fewer calls
+static size_t checkregistry() {
+    std::unique_ptr<fakeregistry> legacyregistry = makeregistryfixture();
+    std::vector<std::string> expected;
+    legacyscan(*legacyregistry, &expected);
+    registrystats legacy = legacyregistry->stats();
+    
+    std::unique_ptr<fakeregistry> registry = makeregistryfixture();
+    fakeregistry* raw = registry.get();
+    hardwareinfo hwinfo(nullptr, std::move(registry));
+    
+    // registry macs come back with colons and the adapter as a note, so both are taken apart again
+    std::vector<std::string> reported;
+    recordstore (hardwareinfo::*fetches[])() = {
+        &hardwareinfo::getprocessorinfo, &hardwareinfo::getvideocontrollerinfo, &hardwareinfo::getnetworkadapterinfo, &hardwareinfo::getmonitorinfo,
+    };
+    for (auto fetch : fetches) {
+        recordstore items = (hwinfo.*fetch)();
+        for (const auto& record : items.records()) {
+            if (record.category != "nic") {
+                reported.emplace_back(record.value);
+                continue;
+            }
+            std::string mac(record.value);
+            mac.erase(std::remove(mac.begin(), mac.end(), ':'), mac.end());
+            reported.push_back(mac);
+            std::string_view notes = record.notes;
+            reported.emplace_back(notes.substr(std::min(notes.size(), sizeof("adapter: ") - 1)));
+        }
+    }
+    
+    // a value already read this scan comes from the cache
+    registrystats before = raw->stats();
+    hwinfo.getprocessorinfo();
+    registrystats again = raw->stats();
+    hwinfo.endscan();
+    registrystats session = raw->stats();
+    
+    expect(!expected.empty() && reported == expected, "session registry collectors report what the per value reads found");
+    expect(again.opens == before.opens && again.queries == before.queries, "registry values read earlier in a scan are not read again");
+    expect(session.opens < legacy.opens && session.closes < legacy.closes, "the handle cache opens fewer registry keys");
+    expect(session.queries < legacy.queries, "batched reads make fewer registry queries");
+    expect(session.enumerations == legacy.enumerations && session.total() < legacy.total(), "a session scan makes fewer registry calls");
+    return 5;
+}
+
+static void benchregistry(int iterations) {
+    printf("\n%-28s %10s %10s %10s %10s %10s\n", "registry calls per scan", "opens", "queries", "enums", "closes", "total");
+    
+    auto report = [&](const char* name, const registrystats& stats) {
+        printf("%-28s %10.1f %10.1f %10.1f %10.1f %10.1f\n", name, (double)stats.opens / iterations, (double)stats.queries / iterations,
+            (double)stats.enumerations / iterations, (double)stats.closes / iterations, (double)stats.total() / iterations);
+    };
+    
+    size_t checksum = 0;
+    
+    {
+        std::unique_ptr<fakeregistry> registry = makeregistryfixture();
+        for (int i = 0; i < iterations; i++) {
+            checksum += legacyscan(*registry);
+        }
+        report("open/query/close per value", registry->stats());
+    }
+    
+    {
+        std::unique_ptr<fakeregistry> registry = makeregistryfixture();
+        fakeregistry* raw = registry.get();
+        hardwareinfo hwinfo(nullptr, std::move(registry));
+        
+        for (int i = 0; i < iterations; i++) {
+            checksum += sessionscan(hwinfo);
+        }
+        report("cached session, batched", raw->stats());
+    }
+    
+#ifdef _WIN32
+    {
+        hardwareinfo hwinfo;
+        for (int i = 0; i < iterations; i++) {
+            checksum += sessionscan(hwinfo);
+        }
+        report("live registry, session", hwinfo.registrycalls());
+    }
+#endif
+    
+    if (checksum == (size_t)-1) printf("\n");
+    
+    size_t failures = checkfailures;
+    size_t checked = checkregistry();
+    printf("%-28s %10zu %10s %10zu\n", "session checks", checked, "failed", checkfailures - failures);
+}
+
+struct hivenode {
+    std::wstring name;
+    std::vector<hivenode> children;
+    std::vector<std::pair<std::wstring, std::pair<uint32_t, std::vector<uint8_t>>>> values;
+    
+    hivenode& child(const std::wstring& path) {
+        hivenode* current = this;
+        size_t begin = 0;
+        while (begin <= path.size()) {
+            size_t end = std::min(path.find(L'\\', begin), path.size());
+            std::wstring part = path.substr(begin, end - begin);
+            begin = end + 1;
+            
+            auto it = std::find_if(current->children.begin(), current->children.end(), [&](const hivenode& n) { return n.name == part; });
+            if (it == current->children.end()) {
+                current->children.push_back({part, {}, {}});
+                current = &current->children.back();
+            } else {
+                current = &*it;
+            }
+        }
+        return *current;
+    }
+    
+    void setstring(const std::wstring& name, const std::wstring& text) {
+        std::vector<uint8_t> data;
+        for (wchar_t c : text) {
+            data.push_back((uint8_t)(c & 0xFF));
+            data.push_back((uint8_t)((c >> 8) & 0xFF));
+        }
+        data.push_back(0);
+        data.push_back(0);
+        values.push_back({name, {1, data}});
+    }
+    
+    void setdword(const std::wstring& name, uint32_t number) {
+        values.push_back({name, {4, {(uint8_t)number, (uint8_t)(number >> 8), (uint8_t)(number >> 16), (uint8_t)(number >> 24)}}});
+    }
+};
+
+static void putle16(std::vector<uint8_t>& out, size_t at, uint32_t value) {
+    out[at] = (uint8_t)value;
+    out[at + 1] = (uint8_t)(value >> 8);
+}
+
+static void putle32(std::vector<uint8_t>& out, size_t at, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[at + i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint32_t hivecell(std::vector<uint8_t>& bins, size_t payload) {
+    size_t total = (payload + 4 + 7) & ~(size_t)7;
+    uint32_t offset = (uint32_t)bins.size();
+    bins.resize(bins.size() + total, 0);
+    putle32(bins, offset, (uint32_t)-(int32_t)total);
+    return offset;
+}
+
+static uint32_t writehivenode(std::vector<uint8_t>& bins, const hivenode& node, uint32_t parent) {
+    uint32_t nk = hivecell(bins, 0x4C + node.name.size());
+    bins[nk + 4] = 'n';
+    bins[nk + 5] = 'k';
+    putle16(bins, nk + 4 + 0x02, parent ? 0x20 : 0x24);
+    putle32(bins, nk + 4 + 0x10, parent);
+    putle32(bins, nk + 4 + 0x1C, 0xFFFFFFFF);
+    putle32(bins, nk + 4 + 0x28, 0xFFFFFFFF);
+    putle16(bins, nk + 4 + 0x48, (uint32_t)node.name.size());
+    for (size_t i = 0; i < node.name.size(); i++) bins[nk + 4 + 0x4C + i] = (uint8_t)node.name[i];
+    
+    std::vector<std::pair<uint32_t, uint32_t>> children;
+    for (const auto& child : node.children) {
+        uint32_t hash = 0;
+        for (wchar_t c : child.name) hash = hash * 37 + (uint32_t)towupper(c);
+        children.push_back({writehivenode(bins, child, nk), hash});
+    }
+    
+    if (!children.empty()) {
+        uint32_t list = hivecell(bins, 4 + children.size() * 8);
+        bins[list + 4] = 'l';
+        bins[list + 5] = 'h';
+        putle16(bins, list + 6, (uint32_t)children.size());
+        for (size_t i = 0; i < children.size(); i++) {
+            putle32(bins, list + 8 + i * 8, children[i].first);
+            putle32(bins, list + 12 + i * 8, children[i].second);
+        }
+        putle32(bins, nk + 4 + 0x14, (uint32_t)children.size());
+        putle32(bins, nk + 4 + 0x1C, list);
+    }
+    
+    std::vector<uint32_t> values;
+    for (const auto& value : node.values) {
+        const std::vector<uint8_t>& data = value.second.second;
+        uint32_t dataoffset = 0;
+        uint32_t datasize = (uint32_t)data.size();
+        
+        if (data.size() <= 4) {
+            for (size_t i = 0; i < data.size(); i++) dataoffset |= (uint32_t)data[i] << (8 * i);
+            datasize |= 0x80000000;
+        } else {
+            dataoffset = hivecell(bins, data.size());
+            std::copy(data.begin(), data.end(), bins.begin() + dataoffset + 4);
+        }
+        
+        uint32_t vk = hivecell(bins, 0x14 + value.first.size());
+        bins[vk + 4] = 'v';
+        bins[vk + 5] = 'k';
+        putle16(bins, vk + 4 + 0x02, (uint32_t)value.first.size());
+        putle32(bins, vk + 4 + 0x04, datasize);
+        putle32(bins, vk + 4 + 0x08, dataoffset);
+        putle32(bins, vk + 4 + 0x0C, value.second.first);
+        putle16(bins, vk + 4 + 0x10, 1);
+        for (size_t i = 0; i < value.first.size(); i++) bins[vk + 4 + 0x14 + i] = (uint8_t)value.first[i];
+        values.push_back(vk);
+    }
+    
+    if (!values.empty()) {
+        uint32_t list = hivecell(bins, values.size() * 4);
+        for (size_t i = 0; i < values.size(); i++) putle32(bins, list + 4 + i * 4, values[i]);
+        putle32(bins, nk + 4 + 0x24, (uint32_t)values.size());
+        putle32(bins, nk + 4 + 0x28, list);
+    }
+    
+    return nk;
+}
+
+static std::vector<uint8_t> synthesizehive(int services, uint32_t seed) {
+    hivenode root{L"ROOT", {}, {}};
+    root.child(L"Select").setdword(L"Current", 1);
+    root.child(L"HardwareConfig").setstring(L"LastConfig", L"{4c4c4544-0042-3510-8048-b2c04f4e3532}");
+    
+    hivenode& config = root.child(L"HardwareConfig\\{4c4c4544-0042-3510-8048-b2c04f4e3532}");
+    config.setstring(L"BIOSVendor", L"Dell Inc.");
+    config.setstring(L"BIOSVersion", L"1.21.0");
+    config.setstring(L"BIOSReleaseDate", L"03/14/2024");
+    config.setstring(L"BaseBoardManufacturer", L"Dell Inc.");
+    config.setstring(L"BaseBoardProduct", L"0K4DWR");
+    config.setstring(L"SystemManufacturer", L"Dell Inc.");
+    config.setstring(L"SystemProductName", L"Precision 3660");
+    
+    hivenode& nics = root.child(L"ControlSet001\\Control\\Class\\{4D36E972-E325-11CE-BFC1-08002BE10318}");
+    for (int i = 0; i < 24; i++) {
+        wchar_t name[8];
+        swprintf(name, 8, L"%04d", i);
+        hivenode& nic = nics.child(name);
+        nic.setstring(L"DriverDesc", i == 1 ? L"Intel(R) Ethernet Connection (17) I219-LM" : L"WAN Miniport (IP)");
+        if (i == 1) {
+            wchar_t mac[16];
+            swprintf(mac, 16, L"D4E0%08X", seed);
+            nic.setstring(L"NetworkAddress", mac);
+        }
+    }
+    
+    hivenode& gpu = root.child(L"ControlSet001\\Control\\Class\\{4d36e968-e325-11ce-bfc1-08002be10318}\\0000");
+    gpu.setstring(L"DriverDesc", L"NVIDIA RTX A2000 12GB");
+    gpu.setstring(L"DriverVersion", L"31.0.15.3742");
+    gpu.setstring(L"DriverDate", L"9-28-2023");
+    
+    for (int m = 0; m < 3; m++) {
+        std::vector<uint8_t> edid = synthesizeedid(m, seed * 4 + (uint32_t)m);
+        hivenode& parameters = root.child(L"ControlSet001\\Enum\\DISPLAY\\DELA1E" + std::to_wstring(m) + L"\\5&1f2e3d4c&0&UID4352" + std::to_wstring(m) + L"\\Device Parameters");
+        parameters.values.push_back({L"EDID", {3, edid}});
+    }
+    
+    hivenode& servicekey = root.child(L"ControlSet001\\Services");
+    for (int s = 0; s < services; s++) {
+        hivenode& service = servicekey.child(L"svc" + std::to_wstring(s));
+        service.setstring(L"DisplayName", L"@%SystemRoot%\\system32\\drivers\\svc" + std::to_wstring(s) + L".sys,-100");
+        service.setstring(L"ImagePath", L"\\SystemRoot\\System32\\drivers\\svc" + std::to_wstring(s) + L".sys");
+        service.setdword(L"Start", 3);
+        service.setdword(L"Type", 1);
+        service.child(L"Parameters").setdword(L"BusyWait", (uint32_t)s);
+    }
+    
+    std::vector<uint8_t> bins(32, 0);
+    uint32_t rootcell = writehivenode(bins, root, 0);
+    bins.resize((bins.size() + 4095) & ~(size_t)4095, 0);
+    memcpy(bins.data(), "hbin", 4);
+    putle32(bins, 8, (uint32_t)bins.size());
+    
+    std::vector<uint8_t> hive(4096, 0);
+    memcpy(hive.data(), "regf", 4);
+    putle32(hive, 0x24, rootcell);
+    putle32(hive, 0x28, (uint32_t)bins.size());
+    const std::wstring filename = L"\\REGISTRY\\MACHINE\\SYSTEM";
+    for (size_t i = 0; i < filename.size(); i++) putle16(hive, 0x30 + i * 2, (uint32_t)filename[i]);
+    
+    hive.insert(hive.end(), bins.begin(), bins.end());
+    return hive;
+}
+
+static size_t scanhive(const uint8_t* data, size_t size, size_t& found) {
+    auto hive = std::make_unique<hiveregistry>();
+    if (!hive->load(data, size)) return 0;
+    
+    hardwareinfo offline(nullptr, std::move(hive));
+    for (auto fetch : {&hardwareinfo::getregistrybiosinfo, &hardwareinfo::getregistryvideocontrollerinfo,
+        &hardwareinfo::getregistrynetworkadapterinfo, &hardwareinfo::getregistrymonitorinfo}) {
+        recordstore items = (offline.*fetch)();
+        for (const auto& record : items.records()) {
+            found += record.value != "n/a" && record.name != "info" && record.name != "error";
+        }
+    }
+    return 1;
+}
+
+static void benchhive(int iterations, const char* hivedir) {
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> hives;
+    std::error_code ec;
+    
+    if (hivedir) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(hivedir, ec)) {
+            if (!entry.is_regular_file()) continue;
+            std::ifstream file(entry.path(), std::ios::binary);
+            std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (data.size() > 4096 && memcmp(data.data(), "regf", 4) == 0) hives.push_back({entry.path().filename().string(), std::move(data)});
+        }
+    }
+    
+    if (hives.empty()) {
+        hives.push_back({"synthetic-small", synthesizehive(200, 1)});
+        hives.push_back({"synthetic-large", synthesizehive(20000, 2)});
+    }
+    
+    printf("\n%-28s %10s %10s %12s %12s %12s\n", "hive", "MB", "values", "us/hive", "hives/s", "allocs/hive");
+    
+    for (const auto& hive : hives) {
+        int rounds = std::max(1, iterations / 20);
+        size_t found = 0;
+        size_t allocationsbefore = allocationcount.load();
+        auto start = std::chrono::steady_clock::now();
+        
+        for (int r = 0; r < rounds; r++) {
+            scanhive(hive.second.data(), hive.second.size(), found);
+        }
+        
+        double us = (double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / rounds;
+        printf("%-28s %10.1f %10zu %12.1f %12.0f %12.0f\n", hive.first.c_str(), (double)hive.second.size() / (1024.0 * 1024.0), found / rounds,
+            us, us > 0 ? 1e6 / us : 0.0, (double)(allocationcount.load() - allocationsbefore) / rounds);
+    }
+}
+
+struct pnpnode {
+    std::wstring enumerator;
+    std::wstring instanceid;
+};
+
+static std::vector<pnpnode> synthesizepnptree(int usbdevices, int othernodes) {
+    static const wchar_t* others[] = {L"ACPI", L"PCI", L"HID", L"SWD", L"ROOT", L"DISPLAY", L"HDAUDIO", L"STORAGE", L"BTHENUM", L"SCSI"};
+    std::vector<pnpnode> nodes;
+    wchar_t buffer[160];
+    
+    for (int i = 0; i < othernodes; i++) {
+        swprintf(buffer, 160, L"%ls\\DEV_%04X\\%d&%X&0&%d", others[i % 10], i, i % 9, 0x2F3C0A1 + i, i % 16);
+        nodes.push_back({others[i % 10], buffer});
+    }
+    
+    for (int i = 0; i < usbdevices; i++) {
+        if (i % 2 == 0) swprintf(buffer, 160, L"USB\\VID_%04X&PID_%04X\\SN%08X", 0x0400 + i, 0x1000 + i, 0xA0000 + i);
+        else swprintf(buffer, 160, L"USB\\VID_%04X&PID_%04X\\5&%X&0&%d", 0x0400 + i, 0x1000 + i, 0x1A2B3C + i, i % 8);
+        nodes.push_back({L"USB", buffer});
+        
+        swprintf(buffer, 160, L"USB\\VID_%04X&PID_%04X&MI_00\\6&%X&0&0000", 0x0400 + i, 0x1000 + i, 0x3D4E5F + i);
+        nodes.push_back({L"USB", buffer});
+        
+        if (i % 4 == 0) {
+            swprintf(buffer, 160, L"USBSTOR\\Disk&Ven_Vendor&Prod_Flash&Rev_1.00\\SN%08X&0", 0xA0000 + i);
+            nodes.push_back({L"USBSTOR", buffer});
+        }
+    }
+    
+    std::mt19937 random(7);
+    std::shuffle(nodes.begin(), nodes.end(), random);
+    return nodes;
+}
+
+struct usbscan {
+    size_t visited = 0;
+    size_t propertycalls = 0;
+    size_t serials = 0;
+};
+
+static void legacyusbscan(const std::vector<pnpnode>& nodes, usbscan& scan) {
+    std::map<std::wstring, bool> seen;
+    
+    for (const auto& node : nodes) {
+        scan.visited++;
+        scan.propertycalls++;
+        if (node.enumerator != L"USB" && node.enumerator != L"USBSTOR") continue;
+        
+        scan.propertycalls += 2;
+        if (seen.find(node.instanceid) != seen.end()) continue;
+        seen[node.instanceid] = true;
+        
+        scan.serials += !extractserialfrominstance(node.instanceid, node.enumerator == L"USBSTOR").empty();
+    }
+}
+
+static void targetedusbscan(const std::vector<std::vector<const pnpnode*>>& byenumerator, usbscan& scan) {
+    std::unordered_set<std::wstring> seen;
+    
+    for (size_t e = 0; e < byenumerator.size(); e++) {
+        for (const pnpnode* node : byenumerator[e]) {
+            scan.visited++;
+            scan.propertycalls += 3;
+            if (!seen.insert(node->instanceid).second) continue;
+            
+            usbdevice device;
+            parseusbhardwareid(node->instanceid, device);
+            scan.serials += !extractserialfrominstance(node->instanceid, e == 1).empty();
+        }
+    }
+}
+
+struct usbfixture {
+    const char* entry;
+    const char* vendor;
+    const char* product;
+    const char* serial;
+    const char* interfaceclass;
+    const wchar_t* windowsusb;
+    const wchar_t* windowsstorage;
+    const wchar_t* usbserial;
+    const wchar_t* storageserial;
+};
+
+// the same physical devices as sysfs describes them and as windows names their usb and usbstor nodes, with the
+// serial both backends have to report for each node; generated instance ids and placeholders report none
+static const usbfixture usbfixtures[] = {
+    {"1-1", "046d", "c52b", "A1B2C3", "03", L"USB\\VID_046D&PID_C52B\\A1B2C3", nullptr, L"A1B2C3", nullptr},
+    {"1-2", "0781", "5581", "4C530001230529103491", "08", L"USB\\VID_0781&PID_5581\\4C530001230529103491",
+        L"USBSTOR\\Disk&Ven_SanDisk&Prod_Ultra&Rev_1.00\\4C530001230529103491&0", L"4C530001230529103491", L"4C530001230529103491"},
+    {"1-3", "8087", "0aaa", nullptr, "e0", L"USB\\VID_8087&PID_0AAA\\5&2F3C0A1&0&3", nullptr, L"", nullptr},
+    {"1-4", "090c", "1000", "0000000000000000", "08", L"USB\\VID_090C&PID_1000\\0000000000000000",
+        L"USBSTOR\\Disk&Ven_Samsung&Prod_Flash_Drive&Rev_1100\\0000000000000000&0", L"0000000000000000", L""},
+    {"1-5", "1234", "5678", "AB,CD", "08", L"USB\\VID_1234&PID_5678\\5&1A2B3C&0&5",
+        L"USBSTOR\\Disk&Ven_Generic&Prod_Flash&Rev_1.00\\7&3F4E5D&0", L"", L""},
+    {"usb1", "1d6b", "0002", "0000:00:14.0", "09", L"USB\\ROOT_HUB30\\4&1B2C3D&0&0", nullptr, L"", nullptr},
+};
+
+// the windows backend: serials cut out of the instance ids setupapi hands back
+static size_t checkusbinstanceids() {
+    size_t checked = 0;
+    for (const auto& fixture : usbfixtures) {
+        std::string name = std::string("instance id serial of ") + fixture.entry;
+        expect(extractserialfrominstance(fixture.windowsusb, false) == fixture.usbserial, name.c_str());
+        checked++;
+        if (fixture.windowsstorage) {
+            expect(extractserialfrominstance(fixture.windowsstorage, true) == fixture.storageserial, (name + " storage").c_str());
+            checked++;
+        }
+    }
+    return checked;
+}
+
+// the linux backend: the same devices written out as a sysfs tree and read back
+static size_t checkusbsysfs() {
+    size_t checked = 0;
+    
+#ifndef _WIN32
+    std::error_code ec;
+    std::filesystem::path root = std::filesystem::temp_directory_path(ec) / "udbench-usb";
+    std::filesystem::remove_all(root, ec);
+    
+    auto write = [&](const std::filesystem::path& path, const char* text) {
+        if (!text) return;
+        std::ofstream file(path);
+        file << text << "\n";
+    };
+    
+    std::vector<std::wstring> expected;
+    std::vector<std::string> names;
+    for (const auto& fixture : usbfixtures) {
+        std::filesystem::path device = root / fixture.entry;
+        std::filesystem::path interface = root / (std::string(fixture.entry) + ":1.0");
+        std::filesystem::create_directories(device, ec);
+        std::filesystem::create_directories(interface, ec);
+        
+        write(device / "idVendor", fixture.vendor);
+        write(device / "idProduct", fixture.product);
+        write(device / "bcdDevice", "0100");
+        write(device / "product", "Cl\xC3\xA9 USB");
+        write(device / "serial", fixture.serial);
+        write(interface / "bInterfaceClass", fixture.interfaceclass);
+        
+        expected.push_back(fixture.usbserial);
+        names.push_back(std::string("sysfs serial of ") + fixture.entry);
+        if (fixture.windowsstorage) {
+            expected.push_back(fixture.storageserial);
+            names.push_back(std::string("sysfs serial of ") + fixture.entry + " storage");
+        }
+    }
+    
+    std::vector<usbdevice> devices = readsysfsusbdevices(root.string());
+    expect(devices.size() == expected.size(), "sysfs reports one device per usb node and one per storage interface");
+    for (size_t i = 0; i < devices.size() && i < expected.size(); i++) {
+        expect(devices[i].serial == expected[i], names[i].c_str());
+        checked++;
+    }
+    
+    // sysfs descriptor strings are utf-8 and have to reach the records as the same text
+    if (!devices.empty()) {
+        hardwareinfo hwinfo;
+        recordstore items = hwinfo.getusbdevices({devices[0]});
+        expect(devices[0].name == L"Cl\u00E9 USB", "sysfs product decoded as utf-8");
+        expect(!items.empty() && items[0].name == "cl\xC3\xA9 usb", "sysfs product reaches the record as utf-8");
+        checked += 2;
+    }
+    
+    std::filesystem::remove_all(root, ec);
+#endif
+    
+    return checked;
+}
+
+static void benchusb(int iterations) {
+    std::vector<pnpnode> nodes = synthesizepnptree(64, 400);
+    
+    std::vector<std::vector<const pnpnode*>> byenumerator(2);
+    for (const auto& node : nodes) {
+        if (node.enumerator == L"USB") byenumerator[0].push_back(&node);
+        if (node.enumerator == L"USBSTOR") byenumerator[1].push_back(&node);
+    }
+    
+    printf("\n%-28s %10s %12s %12s\n", "usb enumeration per scan", "visited", "prop calls", "serials");
+    
+    auto report = [&](const char* name, const usbscan& scan) {
+        printf("%-28s %10zu %12zu %12zu\n", name, scan.visited / iterations, scan.propertycalls / iterations, scan.serials / iterations);
+    };
+    
+    usbscan legacy;
+    for (int i = 0; i < iterations; i++) legacyusbscan(nodes, legacy);
+    report("all classes, map dedup", legacy);
+    
+    usbscan targeted;
+    for (int i = 0; i < iterations; i++) targetedusbscan(byenumerator, targeted);
+    report("usb+usbstor, hash dedup", targeted);
+    
+    size_t failures = checkfailures;
+    size_t checked = checkusbinstanceids();
+    printf("%-28s %10zu %12s %12zu\n", "instance id serials", checked, "failed", checkfailures - failures);
+    
+    failures = checkfailures;
+    checked = checkusbsysfs();
+    if (checked > 0) printf("%-28s %10zu %12s %12zu\n", "sysfs serials", checked, "failed", checkfailures - failures);
+}
+
+static void appendneighbormessage(std::vector<uint8_t>& out, uint8_t family, uint32_t ifindex, uint16_t state, const uint8_t* address, const uint8_t* mac) {
+    size_t addresslength = family == 2 ? 4 : 16;
+    size_t length = 16 + 12 + 4 + ((addresslength + 3) & ~(size_t)3) + 4 + 8;
+    size_t at = out.size();
+    out.resize(at + length);
+    uint8_t* p = out.data() + at;
+    
+    auto put16 = [](uint8_t* to, uint16_t value) { memcpy(to, &value, 2); };
+    auto put32 = [](uint8_t* to, uint32_t value) { memcpy(to, &value, 4); };
+    
+    put32(p, (uint32_t)length);
+    put16(p + 4, 28);
+    p[16] = family;
+    put32(p + 20, ifindex);
+    put16(p + 24, state);
+    
+    uint8_t* attribute = p + 28;
+    put16(attribute, (uint16_t)(4 + addresslength));
+    put16(attribute + 2, 1);
+    memcpy(attribute + 4, address, addresslength);
+    
+    attribute += 4 + ((addresslength + 3) & ~(size_t)3);
+    put16(attribute, 10);
+    put16(attribute + 2, 2);
+    memcpy(attribute + 4, mac, 6);
+}
+
+static std::vector<uint8_t> synthesizeneighbordump(int entries, uint32_t seed) {
+    std::vector<uint8_t> dump;
+    std::mt19937 random(seed);
+    
+    for (int i = 0; i < entries; i++) {
+        // roughly one in twenty entries repeats an earlier neighbor, as a dump racing an update can
+        int id = (i % 20 == 19) ? (int)(random() % (uint32_t)(i + 1)) : i;
+        bool v6 = id % 3 == 0;
+        uint8_t address[16] = {};
+        if (v6) {
+            address[0] = 0xFE;
+            address[1] = 0x80;
+            for (int b = 8; b < 16; b++) address[b] = (uint8_t)(id >> ((b % 4) * 8));
+        } else {
+            address[0] = 10;
+            address[1] = (uint8_t)(id >> 16);
+            address[2] = (uint8_t)(id >> 8);
+            address[3] = (uint8_t)id;
+        }
+        uint8_t mac[6] = {0x02, 0x42, (uint8_t)(id >> 24), (uint8_t)(id >> 16), (uint8_t)(id >> 8), (uint8_t)id};
+        appendneighbormessage(dump, v6 ? 10 : 2, 2 + (uint32_t)(id % 8), id % 50 == 0 ? 0x80 : 0x04, address, mac);
+    }
+    
+    std::vector<uint8_t> done(16, 0);
+    uint32_t length = 16;
+    uint16_t type = 3;
+    memcpy(done.data(), &length, 4);
+    memcpy(done.data() + 4, &type, 2);
+    dump.insert(dump.end(), done.begin(), done.end());
+    return dump;
+}
+
+// the per-row formatting getarptable used before the neighbor engine
+static std::vector<legacyitem> legacyneighboritems(const neighbortable& table) {
+    std::vector<legacyitem> items;
+    
+    for (const auto& entry : table.records()) {
+        std::wstring ip;
+        ip = std::to_wstring(entry.address[0]) + L"." +
+             std::to_wstring(entry.address[1]) + L"." +
+             std::to_wstring(entry.address[2]) + L"." +
+             std::to_wstring(entry.address[3]);
+        
+        std::wostringstream macstream;
+        for (size_t j = 0; j < entry.maclength && j < 6; j++) {
+            if (j > 0) macstream << L":";
+            macstream << std::hex << std::setfill(L'0') << std::setw(2) << (int)entry.mac[j];
+        }
+        
+        std::wstring adaptername = L"ifindex " + std::to_wstring(entry.interfaceindex);
+        items.push_back({L"arp", ip, macstream.str(), std::wstring(entry.kind == neighborkind::permanent ? L"static" : L"dynamic") + L"; adapter: " + adaptername});
+    }
+    
+    return items;
+}
+
+static void benchneighbors(int entries) {
+    std::vector<uint8_t> dump = synthesizeneighbordump(entries, 3);
+    
+    printf("\n%-28s %10s %10s %12s %12s %14s\n", "neighbor table", "entries", "records", "ms", "ns/entry", "allocs/entry");
+    
+    auto measure = [&](const char* name, auto&& work) {
+        size_t allocationsbefore = allocationcount.load();
+        auto start = std::chrono::steady_clock::now();
+        size_t records = work();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        printf("%-28s %10d %10zu %12.2f %12.1f %14.2f\n", name, entries, records, ns / 1e6, ns / entries,
+            (double)(allocationcount.load() - allocationsbefore) / entries);
+    };
+    
+    neighbortable table;
+    measure("decode + sort/dedup", [&] {
+        bool done = false;
+        table.reserve((size_t)entries);
+        decodeneighbormessages(dump.data(), dump.size(), table, done);
+        table.normalize();
+        return table.size();
+    });
+    
+    // what a headless write or a snapshot reads, and what every scan used to pay up front
+    measure("format every record", [&] {
+        recordstore items;
+        items.reserve(table.size());
+        neighbortext text;
+        for (const auto& entry : table.records()) items.add(neighborrecord(table, entry, text));
+        return items.size();
+    });
+    measure("legacy format items", [&] { return legacyneighboritems(table).size(); });
+    
+    // what the menu pays now: the arp page copies the entries and formats only the rows it draws
+    pageview page;
+    std::string frame;
+    measure("page build + 40 row frame", [&] {
+        page.build(table);
+        frame.clear();
+        page.render(frame, page.size() / 2, 40, 100, page.size() / 2);
+        return page.total();
+    });
+    
+    printf("%-28s %10zu bytes per record, %zu KB for the table\n", "", sizeof(neighborentry), table.size() * sizeof(neighborentry) / 1024);
+    
+    // the records formatted on demand have to read as the old per row formatting did, where that handled the entry
+    std::vector<legacyitem> legacy = legacyneighboritems(table);
+    neighbortext text;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < table.size(); i++) {
+        const neighborentry& entry = table.records()[i];
+        if (entry.family != 4 || entry.maclength != 6) continue;
+        recordview record = neighborrecord(table, entry, text);
+        mismatches += widetoutf8(legacy[i].name) != record.name || widetoutf8(legacy[i].value) != record.value ||
+            widetoutf8(legacy[i].notes) != record.notes;
+    }
+    expect(mismatches == 0, "neighbor records format as the per row arp formatting did");
+    
+    // and the page has to find what it never formatted up front
+    if (!table.empty()) {
+        recordview last = neighborrecord(table, table.records().back(), text);
+        std::string address(last.name);
+        expect(page.find(address, 0, false) != pageview::npos, "arp page search finds an entry it formats on demand");
+        page.filter(address);
+        expect(page.matched() >= 1 && page.matched() < table.size(), "arp page filter narrows to the matching entries");
+        frame.clear();
+        page.render(frame, 0, 1, 100, pageview::npos);
+        expect(frame.find(address) != std::string::npos, "arp page draws the filtered entry");
+    }
+}
+
+// the formatting the collectors did before the text kernels, kept to measure against
+static std::string legacyuuid(const uint8_t* uuid) {
+    std::ostringstream oss;
+    oss << std::hex << std::uppercase << std::setfill('0');
+    for (int i = 0; i < 16; i++) {
+        if (i == 4 || i == 6 || i == 8 || i == 10) oss << "-";
+        oss << std::setw(2) << (int)uuid[i];
+    }
+    return oss.str();
+}
+
+static std::wstring legacymac(const uint8_t* mac, size_t size) {
+    std::wostringstream macstream;
+    for (size_t j = 0; j < size; j++) {
+        if (j > 0) macstream << L":";
+        macstream << std::hex << std::setfill(L'0') << std::setw(2) << (int)mac[j];
+    }
+    return macstream.str();
+}
+
+static std::wstring legacyserial(const std::string& value) {
+    size_t start = value.find_first_not_of(" \t\r\n");
+    size_t end = value.find_last_not_of(" \t\r\n");
+    std::string serial = start == std::string::npos ? "" : value.substr(start, end - start + 1);
+    std::transform(serial.begin(), serial.end(), serial.begin(), ::toupper);
+    return std::wstring(serial.begin(), serial.end());
+}
+
+static size_t scalarhex(const uint8_t* data, size_t size, char* out) {
+    static const char digits[] = "0123456789abcdef";
+    for (size_t i = 0; i < size; i++) {
+        out[i * 2] = digits[data[i] >> 4];
+        out[i * 2 + 1] = digits[data[i] & 0xF];
+    }
+    out[size * 2] = 0;
+    return size * 2;
+}
+
+// what the category pages did before pageview: regroup into a map and format every row on every visit
+static size_t legacyprintsection(std::ostream& out, const std::vector<legacyitem>& items) {
+    std::map<std::wstring, std::vector<legacyitem>> grouped;
+    for (const auto& item : items) grouped[item.category].push_back(item);
+    
+    size_t lines = 0;
+    for (const auto& [category, categoryitems] : grouped) {
+        out << "| [ " << widetoutf8(category) << " ]" << std::endl;
+        for (const auto& item : categoryitems) {
+            std::string name = widetoutf8(item.name);
+            std::string value = widetoutf8(item.value);
+            std::string notes = widetoutf8(item.notes);
+            if (name.length() > 25) name = name.substr(0, 22) + "...";
+            if (value.length() > 35) value = value.substr(0, 32) + "...";
+            if (notes.length() > 15) notes = notes.substr(0, 12) + "...";
+            out << "| " << std::left << std::setw(25) << name << " | " << std::left << std::setw(35) << value;
+            if (!notes.empty()) out << " | " << notes;
+            out << std::endl;
+            lines++;
+        }
+    }
+    return lines;
+}
+
+static void benchpages(int rows) {
+    printf("\n%-28s %10s %12s %12s %12s %12s %12s\n", "category page", "rows", "legacy ms", "build ms", "frame us", "filter us", "search us");
+    
+    std::mt19937 random(31);
+    for (size_t count = 1000; count <= (size_t)rows; count *= 10) {
+        std::vector<legacyitem> items;
+        recordstore records;
+        items.reserve(count);
+        records.reserve(count);
+        for (size_t i = 0; i < count; i++) {
+            char address[32];
+            char mac[32];
+            snprintf(address, sizeof(address), "10.%u.%u.%u", (unsigned)(i >> 16) & 0xFF, (unsigned)(i >> 8) & 0xFF, (unsigned)i & 0xFF);
+            snprintf(mac, sizeof(mac), "52:54:00:%02x:%02x:%02x", (unsigned)random() & 0xFF, (unsigned)random() & 0xFF, (unsigned)random() & 0xFF);
+            std::string category = "interface " + std::to_string(i % 8);
+            const char* notes = i % 5 ? "reachable" : "stale";
+            records.add("arp", category, address, mac, notes);
+            items.push_back({utf8towide(category), utf8towide(address), utf8towide(mac), utf8towide(notes)});
+        }
+        
+        auto elapsed = [](std::chrono::steady_clock::time_point start) {
+            return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        };
+        
+        std::ostringstream legacy;
+        auto start = std::chrono::steady_clock::now();
+        legacyprintsection(legacy, items);
+        double legacyns = elapsed(start);
+        
+        pageview page;
+        start = std::chrono::steady_clock::now();
+        page.build(records);
+        double buildns = elapsed(start);
+        
+        // a 40 row window at the top, the middle and the end of the page, as a redraw would draw it
+        std::string frame;
+        const int frames = 3000;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            frame.clear();
+            size_t top = i % 3 == 0 ? 0 : i % 3 == 1 ? page.size() / 2 : page.size() - 40;
+            page.render(frame, top, 40, 100, top + 5);
+        }
+        double framens = elapsed(start) / frames;
+        
+        // typing "10.1.2" one key at a time, each key narrowing what the one before left
+        const char* typed = "10.1.2";
+        size_t keys = strlen(typed);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 1; i <= keys; i++) page.filter(std::string_view(typed, i));
+        double filterns = elapsed(start) / keys;
+        size_t kept = page.matched();
+        page.filter("");
+        
+        start = std::chrono::steady_clock::now();
+        size_t found = page.find("stale", page.size() / 2, false);
+        double searchns = elapsed(start);
+        
+        std::string name = std::to_string(count) + " rows, " + std::to_string(kept) + " kept";
+        printf("%-28s %10zu %12.2f %12.2f %12.2f %12.2f %12.2f\n", name.c_str(), count, legacyns / 1e6, buildns / 1e6,
+            framens / 1e3, filterns / 1e3, found == pageview::npos ? 0.0 : searchns / 1e3);
+    }
+}
+
+static void benchtext(int records) {
+    std::mt19937 random(11);
+    std::vector<uint8_t> bytes((size_t)records * 32);
+    for (auto& b : bytes) b = (uint8_t)random();
+    
+    std::vector<std::string> serials((size_t)records);
+    for (size_t i = 0; i < serials.size(); i++) {
+        char text[40];
+        snprintf(text, sizeof(text), "  wd-wcc%08x%04x \n", (unsigned)random(), (unsigned)(i & 0xFFFF));
+        serials[i] = text;
+    }
+    
+    // the kernels have to print exactly what the code they replaced did
+    size_t mismatches = 0;
+    for (size_t i = 0; i < std::min<size_t>(serials.size(), 4096); i++) {
+        const uint8_t* record = bytes.data() + i * 32;
+        char text[80];
+        
+        formatuuidtext(record, text, sizeof(text));
+        mismatches += legacyuuid(record) != text;
+        
+        formatmactext(record, 6, text, sizeof(text));
+        mismatches += widetoutf8(legacymac(record, 6)) != text;
+        
+        hexencode(record, 32, text, sizeof(text), false);
+        char scalar[80];
+        scalarhex(record, 32, scalar);
+        mismatches += strcmp(text, scalar) != 0;
+        
+        formatipv4text(record, text, sizeof(text));
+        mismatches += widetoutf8(std::to_wstring(record[0]) + L"." + std::to_wstring(record[1]) + L"." + std::to_wstring(record[2]) + L"." + std::to_wstring(record[3])) != text;
+        
+        std::wstring serial(trimascii(serials[i]).begin(), trimascii(serials[i]).end());
+        asciiupper(serial);
+        mismatches += legacyserial(serials[i]) != serial;
+    }
+    
+    expect(mismatches == 0, "text kernels print what the formatting they replaced did");
+    
+    printf("\n%-28s %10s %12s %14s %10s\n", "text kernels", "records", "ns/record", "allocs/record", "mismatches");
+    
+    auto measure = [&](const char* name, auto&& work) {
+        size_t allocationsbefore = allocationcount.load();
+        auto start = std::chrono::steady_clock::now();
+        size_t sink = 0;
+        for (size_t i = 0; i < (size_t)records; i++) sink += work(i);
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        printf("%-28s %10d %12.1f %14.2f %10zu\n", name, records, ns / records,
+            (double)(allocationcount.load() - allocationsbefore) / records, mismatches);
+        if (sink == (size_t)-1) printf("\n");
+    };
+    
+    char text[80];
+    measure("uuid ostringstream", [&](size_t i) { return legacyuuid(bytes.data() + i * 32).size(); });
+    measure("uuid kernel", [&](size_t i) { return formatuuidtext(bytes.data() + i * 32, text, sizeof(text)); });
+    measure("hex 32 bytes scalar", [&](size_t i) { return scalarhex(bytes.data() + i * 32, 32, text); });
+    measure("hex 32 bytes kernel", [&](size_t i) { return hexencode(bytes.data() + i * 32, 32, text, sizeof(text), false); });
+    measure("mac wostringstream", [&](size_t i) { return legacymac(bytes.data() + i * 32, 6).size(); });
+    measure("mac kernel", [&](size_t i) { return formatmactext(bytes.data() + i * 32, 6, text, sizeof(text)); });
+    measure("ipv4 to_wstring", [&](size_t i) {
+        const uint8_t* a = bytes.data() + i * 32;
+        return (std::to_wstring(a[0]) + L"." + std::to_wstring(a[1]) + L"." + std::to_wstring(a[2]) + L"." + std::to_wstring(a[3])).size();
+    });
+    measure("ipv4 kernel", [&](size_t i) { return formatipv4text(bytes.data() + i * 32, text, sizeof(text)); });
+    measure("ipv6 kernel", [&](size_t i) { return formatipv6text(bytes.data() + i * 32, text, sizeof(text)); });
+    measure("serial trim + upper legacy", [&](size_t i) { return legacyserial(serials[i]).size(); });
+    measure("serial trim + upper kernel", [&](size_t i) {
+        std::string_view trimmed = trimascii(serials[i]);
+        std::wstring serial(trimmed.begin(), trimmed.end());
+        asciiupper(serial);
+        return serial.size();
+    });
+}
+
+// the check decodebiosinfo ran twice per table before the classifier, and only for bios serials
+static bool legacyvalidserial(std::string_view serialnumber) {
+    std::string serialcheck(serialnumber);
+    std::transform(serialcheck.begin(), serialcheck.end(), serialcheck.begin(), ::tolower);
+    return !(serialnumber.empty() || serialcheck == "n/a" || serialcheck == "none" ||
+        serialcheck.find("o.e.m.") != std::string::npos || serialcheck.find("default") != std::string::npos);
+}
+
+static void benchserials(int values) {
+    static const char* junk[] = {
+        "To Be Filled By O.E.M.", "Default string", "System Serial Number", "0123456789", "FFFFFFFF", "N/A", "None",
+        "", "   ", "00000000-0000", "Chassis Serial Number", "1", "XXXXXXXX1234", "Not Specified",
+    };
+    
+    // roughly what a fleet archive holds: mostly vendor serials, one in eight a placeholder of some kind
+    std::mt19937 random(17);
+    std::vector<std::string> serials((size_t)values);
+    for (auto& serial : serials) {
+        if (random() % 8 == 0) {
+            serial = junk[random() % (sizeof(junk) / sizeof(junk[0]))];
+        } else {
+            char text[32];
+            snprintf(text, sizeof(text), "%s%08X%u", random() % 2 ? "WD-WCC" : "PF", (unsigned)random(), (unsigned)(random() % 1000));
+            serial = text;
+        }
+    }
+    std::vector<std::wstring> wideserials(std::min<size_t>(serials.size(), 1000000));
+    for (size_t i = 0; i < wideserials.size(); i++) wideserials[i].assign(serials[i].begin(), serials[i].end());
+    
+    printf("\n%-28s %10s %12s %14s %12s %s\n", "serial classifier", "values", "ns/value", "allocs/value", "M values/s", "real/placeholder/blank/suspicious");
+    
+    auto measure = [&](const char* name, size_t count, auto&& classify) {
+        size_t counts[4] = {};
+        size_t allocationsbefore = allocationcount.load();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) counts[(int)classify(i)]++;
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        printf("%-28s %10zu %12.2f %14.2f %12.1f %zu/%zu/%zu/%zu\n", name, count, ns / count,
+            (double)(allocationcount.load() - allocationsbefore) / count, count / ns * 1e3, counts[0], counts[1], counts[2], counts[3]);
+    };
+    
+    measure("legacy bios check", serials.size(), [&](size_t i) {
+        return legacyvalidserial(serials[i]) ? serialclass::real : serialclass::placeholder;
+    });
+    measure("classifyserial", serials.size(), [&](size_t i) { return classifyserial(serials[i]); });
+    measure("classifyserial wide", wideserials.size(), [&](size_t i) { return classifyserial(wideserials[i]); });
+}
+
+static std::vector<std::pair<std::string, recordstore>> synthesizeidentity(uint32_t seed) {
+    std::mt19937 random(seed);
+    auto serial = [&](const char* prefix) {
+        char text[32];
+        snprintf(text, sizeof(text), "%s%08X", prefix, (unsigned)random());
+        return std::string(text);
+    };
+    
+    std::vector<std::pair<std::string, recordstore>> categories(5);
+    categories[0].first = "bios";
+    uint8_t uuid[16];
+    for (auto& b : uuid) b = (uint8_t)random();
+    recordstore& bios = categories[0].second;
+    bios.add("bios", "bios", "vendor", "American Megatrends Inc.", "");
+    bios.add("bios", "systemproduct", "serialnumber", serial("SYS"), "");
+    bios.add("bios", "systemproduct", "uuid", hardwareinfo::formatuuid(uuid), "");
+    bios.add("bios", "baseboard", "serialnumber", random() % 4 ? serial("MB") : "Default string", "");
+    bios.add("bios", "chassis", "serialnumber", "To Be Filled By O.E.M.", "placeholder serial");
+    
+    categories[1].first = "disk";
+    for (int i = 0; i < 4; i++) {
+        std::string index = std::to_string(i);
+        categories[1].second.add("disk", "disk", "serial_" + index, serial("WD-WCC"), "block device " + index);
+        categories[1].second.add("disk", "disk", "model_" + index, "wdc wd40efrx", "block device " + index);
+    }
+    
+    categories[2].first = "monitor";
+    categories[2].second.add("monitor", "monitor", "dell u2720q", serial("CN0"), "instance: edid 0");
+    
+    categories[3].first = "nic";
+    for (int i = 0; i < 2; i++) {
+        uint8_t mac[6];
+        for (auto& b : mac) b = (uint8_t)random();
+        char text[32];
+        size_t length = formatmactext(mac, 6, text, sizeof(text));
+        categories[3].second.add("nic", "nic", "kernelmac_" + std::to_string(i), std::string_view(text, length), "adapter: intel");
+    }
+    
+    categories[4].first = "usb";
+    categories[4].second.add("usb", "usb", "usb keyboard", "", "VID_046D&PID_C31C&REV_6400; blank serial");
+    categories[4].second.add("usb", "usb", "sandisk cruzer usb device", serial("4C53"), "VID_0781&PID_5567&REV_0100; storage");
+    return categories;
+}
+
+static void benchfingerprints(int count) {
+    const size_t distinct = 1024;
+    std::vector<std::vector<std::pair<std::string, recordstore>>> scans;
+    std::vector<snapshot> archived(distinct);
+    for (size_t i = 0; i < distinct; i++) {
+        scans.push_back(synthesizeidentity((uint32_t)i + 1));
+        for (const auto& [key, items] : scans.back()) {
+            for (const auto& record : items.records()) archived[i].add(record);
+        }
+    }
+    
+    // a live scan and the snapshot it was saved as have to agree
+    fingerprinter engine;
+    size_t mismatches = 0;
+    for (size_t i = 0; i < distinct; i++) {
+        fingerprint live;
+        fingerprint stored;
+        for (const auto& [key, items] : scans[i]) engine.update(live, key, items);
+        engine.compute(stored, archived[i].records());
+        mismatches += live.composite != stored.composite;
+    }
+    
+    expect(mismatches == 0, "a live scan and its stored snapshot fingerprint alike");
+    
+    printf("\n%-28s %10s %12s %14s %10s\n", "fingerprint", "prints", "ns/print", "allocs/print", "mismatches");
+    
+    auto measure = [&](const char* name, auto&& work) {
+        size_t allocationsbefore = allocationcount.load();
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sink = 0;
+        for (size_t i = 0; i < (size_t)count; i++) sink ^= work(i % distinct);
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        printf("%-28s %10d %12.1f %14.3f %10zu\n", name, count, ns / count,
+            (double)(allocationcount.load() - allocationsbefore) / count, mismatches);
+        if (sink == 1) printf("\n");
+    };
+    
+    fingerprint print;
+    measure("archived snapshot", [&](size_t i) {
+        engine.compute(print, archived[i].records());
+        return print.composite;
+    });
+    measure("full scan", [&](size_t i) {
+        for (const auto& [key, items] : scans[i]) engine.update(print, key, items);
+        return print.composite;
+    });
+    measure("one category changed", [&](size_t i) {
+        engine.update(print, "disk", scans[i][1].second);
+        return print.composite;
+    });
+}
+
+// a two socket hybrid part as cpuid describes it: per socket 16 performance cores of two threads with their own
+// l2, then 32 single thread efficient cores sharing an l2 per cluster of four, and one l3 over all of them
+static std::vector<cpuprobe> synthesizecpus() {
+    auto text = [](const char* value, size_t offset) {
+        uint32_t word = 0;
+        for (size_t i = 0; i < 4 && value[offset + i]; i++) word |= (uint32_t)(uint8_t)value[offset + i] << (i * 8);
+        return word;
+    };
+    const char* brand = "Synthetic(R) Hybrid Processor 128T              ";
+    
+    std::vector<cpuprobe> probes(128);
+    for (uint32_t i = 0; i < 128; i++) {
+        uint32_t package = i / 64;
+        uint32_t local = i % 64;
+        bool performance = local < 32;
+        uint32_t apicid = (package << 7) | (performance ? local : (16 + (local - 32)) << 1);
+        
+        cpuprobe& probe = probes[i];
+        probe.index = i;
+        probe.pinned = true;
+        probe.microcode = 0x2b000590;
+        probe.leaves.push_back({0, 0, 0x20, text("GenuineIntel", 0), text("GenuineIntel", 8), text("GenuineIntel", 4)});
+        probe.leaves.push_back({1, 0, 0x000b06a2, (apicid & 0xFF) << 24 | 128 << 16, 0, 1u << 28});
+        if (performance) {
+            probe.leaves.push_back({4, 0, 0x4121, 0x02C0003F, 63, 0});
+            probe.leaves.push_back({4, 1, 0x4122, 0x01C0003F, 63, 0});
+            probe.leaves.push_back({4, 2, 0x4143, 0x03C0003F, 2047, 0});
+        } else {
+            probe.leaves.push_back({4, 0, 0x121, 0x01C0003F, 63, 0});
+            probe.leaves.push_back({4, 1, 0x122, 0x01C0003F, 127, 0});
+            probe.leaves.push_back({4, 2, 0x1C143, 0x03C0003F, 4095, 0});
+        }
+        probe.leaves.push_back({4, 3, 0x1FC163, 0x0340003F, 49151, 6});
+        probe.leaves.push_back({4, 4, 0, 0, 0, 0});
+        probe.leaves.push_back({7, 0, 0, 0, 0, 1u << 15});
+        probe.leaves.push_back({0xB, 0, 1, performance ? 2u : 1u, 0x100, apicid});
+        probe.leaves.push_back({0xB, 1, 7, 64, 0x201, apicid});
+        probe.leaves.push_back({0xB, 2, 0, 0, 2, apicid});
+        probe.leaves.push_back({0x1A, 0, performance ? 0x40000001u : 0x20000001u, 0, 0, 0});
+        for (uint32_t leaf = 0; leaf < 3; leaf++) {
+            size_t offset = leaf * 16;
+            probe.leaves.push_back({0x80000002 + leaf, 0, text(brand, offset), text(brand, offset + 4), text(brand, offset + 8), text(brand, offset + 12)});
+        }
+    }
+    return probes;
+}
+
+static void benchcpu(int sweeps) {
+    printf("\n%-28s %10s %12s %10s %s\n", "cpu", "runs", "us/run", "probes", "result");
+    
+    auto measure = [&](const char* name, int runs, auto&& work) {
+        std::wstring result;
+        size_t probes = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; i++) probes = work(result);
+        double us = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+        std::string shown;
+        appendutf8(shown, result);
+        printf("%-28s %10d %12.2f %10zu %s\n", name, runs, us / runs, probes, shown.c_str());
+    };
+    
+    auto topologyof = [](const recordstore& items) {
+        for (const auto& record : items.records()) {
+            if (record.name == "topology") return utf8towide(record.value);
+        }
+        return std::wstring(L"n/a");
+    };
+    
+    // pinning every logical processor in turn is the cost; the same leaves read on one thread show how much
+    measure("pinned sweep", sweeps, [&](std::wstring& result) {
+        std::vector<cpuprobe> probes = probecpus();
+        size_t pinned = 0;
+        for (const auto& probe : probes) pinned += probe.pinned;
+        result = std::to_wstring(pinned) + L" pinned";
+        return probes.size();
+    });
+    measure("capture on one thread", sweeps * 10, [&](std::wstring& result) {
+        cpuprobe probe;
+        result = capturecpuid(probe) ? std::to_wstring(probe.leaves.size()) + L" leaves" : L"no cpuid";
+        return (size_t)1;
+    });
+    
+    hardwareinfo info;
+    std::vector<cpuprobe> live = probecpus();
+    std::vector<cpuprobe> synthetic = synthesizecpus();
+    measure("decode live", sweeps * 10, [&](std::wstring& result) {
+        result = topologyof(info.getprocessorinfo(live));
+        return live.size();
+    });
+    recordstore decoded = info.getprocessorinfo(synthetic);
+    auto finditem = [&](std::string_view name) {
+        const auto& records = decoded.records();
+        auto it = std::find_if(records.begin(), records.end(), [&](const recordview& record) { return record.name == name; });
+        return it == records.end() ? std::string() : std::string(it->value) + " | " + std::string(it->notes);
+    };
+    expect(finditem("topology") == "2 packages, 96 cores, 128 threads | ", "synthetic hybrid topology");
+    expect(finditem("l2 efficient") == "4 MB, 16-way, 64 byte lines | 16 instances, up to 4 logical processors each", "synthetic efficient core l2");
+    expect(finditem("l3") == "42 MB, 14-way, 64 byte lines | 2 instances, up to 64 logical processors each", "synthetic l3");
+    
+    measure("decode 2s hybrid", sweeps * 10, [&](std::wstring& result) {
+        recordstore items = info.getprocessorinfo(synthetic);
+        result = topologyof(items);
+        for (const auto& record : items.records()) {
+            if (record.name == "core types") result += L"; " + utf8towide(record.value);
+        }
+        return synthetic.size();
+    });
+}
+
+struct storagefixture {
+    const char* name;
+    const char* vendor;
+    const char* product;
+    const char* revision;
+    const char* serial;
+    uint32_t bustype;
+    bool removable;
+};
+
+static const storagefixture storagefixtures[] = {
+    {"sata-ssd", nullptr, "Samsung SSD 870 EVO 1TB", "SVT02B6Q", "S6PTNZ0R123456A", 11, false},
+    {"nvme", nullptr, "WDC WDS100T2B0C-00PXH0", "211070WD", "E823_8FA6_BF53_0001_001B_448B_4A9C_F2D1.", 17, false},
+    {"usb-flash", "SanDisk ", "Ultra           ", "1.00", "4C530001230529103491", 7, true},
+    {"sas-padded", "SEAGATE ", "ST4000NM0023    ", "0004", "    Z1Z0ABCD0000C4250RJK", 10, false},
+    {"virtual", "Msft    ", "Virtual Disk    ", "1.0 ", nullptr, 14, false},
+};
+
+// storage_device_descriptor as ioctl_storage_query_property returns it: 36 byte header, then the strings it points at
+static std::vector<uint8_t> synthesizestoragedescriptor(const storagefixture& f) {
+    std::vector<uint8_t> buffer(40, 0);
+    
+    auto putstring = [&](size_t field, const char* text) {
+        if (!text) return;
+        uint32_t offset = (uint32_t)buffer.size();
+        memcpy(&buffer[field], &offset, 4);
+        buffer.insert(buffer.end(), text, text + strlen(text));
+        buffer.push_back(0);
+    };
+    
+    buffer[10] = f.removable ? 1 : 0;
+    putstring(12, f.vendor);
+    putstring(16, f.product);
+    putstring(20, f.revision);
+    putstring(24, f.serial);
+    memcpy(&buffer[28], &f.bustype, 4);
+    
+    uint32_t version = 40;
+    uint32_t size = (uint32_t)buffer.size();
+    memcpy(&buffer[0], &version, 4);
+    memcpy(&buffer[4], &size, 4);
+    return buffer;
+}
+
+static const wchar_t* instancefixtures[] = {
+    L"USB\\VID_046D&PID_C52B\\A1B2C3",
+    L"USB\\VID_0781&PID_5581\\4C530001230529103491",
+    L"USB\\VID_8087&PID_0AAA\\5&2F3C0A1&0&3",
+    L"USB\\VID_046D&PID_C52B&MI_00\\7&1A2B3C4D&0&0000",
+    L"USB\\ROOT_HUB30\\4&1B2C3D&0&0",
+    L"USB\\VID_05AC&PID_12A8\\00008030001A2B3C0E01802E",
+    L"USB\\VID_0BDA&PID_8153\\000001000000",
+    L"USBSTOR\\Disk&Ven_SanDisk&Prod_Ultra&Rev_1.00\\4C530001230529103491&0",
+    L"USBSTOR\\Disk&Ven_Samsung&Prod_Flash_Drive&Rev_1100\\0000000000000000&0",
+    L"USBSTOR\\Disk&Ven_Generic&Prod_Flash&Rev_1.00\\7&3F4E5D&0",
+    L"USBSTOR\\CdRom&Ven_HL-DT-ST&Prod_DVDRAM_GP57EB40&Rev_PF00\\KZXE6HI1234&0",
+    L"USBSTOR\\Disk&Ven_WD&Prod_My_Passport_25E2&Rev_4004\\575837324441305052353139&0",
+};
+
+struct parsercorpus {
+    std::vector<fixture> smbios;
+    std::vector<fixture> edids;
+    std::vector<fixture> storage;
+    std::vector<std::wstring> instanceids;
+    std::vector<uint8_t> neighbors;
+};
+
+static std::vector<fixture> readfixtures(const std::filesystem::path& directory) {
+    std::vector<fixture> fixtures;
+    std::error_code ec;
+    
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        if (!entry.is_regular_file()) continue;
+        std::ifstream file(entry.path(), std::ios::binary);
+        std::string name = entry.path().stem().string();
+        std::replace_if(name.begin(), name.end(), [](char c) { return c == '"' || c == '\\' || (unsigned char)c < 0x20; }, '_');
+        fixtures.push_back({name, std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>())});
+    }
+    
+    std::sort(fixtures.begin(), fixtures.end(), [](const fixture& a, const fixture& b) { return a.name < b.name; });
+    return fixtures;
+}
+
+static parsercorpus synthesizeparsercorpus() {
+    parsercorpus corpus;
+    
+    corpus.smbios.push_back({"desktop", synthesizetable(4, 1)});
+    corpus.smbios.push_back({"server-2s-48dimm", synthesizetable(48, 2)});
+    
+    static const char* edidnames[] = {"serial-descriptor", "binary-serial-only", "cta-hdmi", "displayid"};
+    for (int i = 0; i < 4; i++) {
+        corpus.edids.push_back({edidnames[i], synthesizeedid(i, 0x4A3B0000u + (uint32_t)i)});
+    }
+    
+    for (const auto& f : storagefixtures) {
+        corpus.storage.push_back({f.name, synthesizestoragedescriptor(f)});
+    }
+    
+    corpus.instanceids.assign(std::begin(instancefixtures), std::end(instancefixtures));
+    corpus.neighbors = synthesizeneighbordump(512, 7);
+    return corpus;
+}
+
+// anything missing from the checked in fixtures falls back to the synthesized set
+static parsercorpus loadparsercorpus(const char* directory) {
+    parsercorpus corpus = synthesizeparsercorpus();
+    if (!directory) return corpus;
+    
+    std::filesystem::path root(directory);
+    
+    std::vector<fixture> tables;
+    for (auto& f : readfixtures(root / "smbios")) {
+        size_t offset = 0;
+        size_t length = 0;
+        if (!locatesmbiostable(f.data.data(), f.data.size(), offset, length)) continue;
+        tables.push_back({f.name, std::vector<uint8_t>(f.data.begin() + offset, f.data.begin() + offset + length)});
+    }
+    if (!tables.empty()) corpus.smbios = std::move(tables);
+    
+    std::vector<fixture> edids = readfixtures(root / "edid");
+    if (!edids.empty()) corpus.edids = std::move(edids);
+    
+    std::vector<fixture> storage = readfixtures(root / "storage");
+    if (!storage.empty()) corpus.storage = std::move(storage);
+    
+    std::ifstream instances(root / "instanceids.txt");
+    std::vector<std::wstring> instanceids;
+    for (std::string line; std::getline(instances, line);) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) instanceids.push_back(utf8towide(line));
+    }
+    if (!instanceids.empty()) corpus.instanceids = std::move(instanceids);
+    
+    std::ifstream dump(root / "neighbors.bin", std::ios::binary);
+    std::vector<uint8_t> neighbors((std::istreambuf_iterator<char>(dump)), std::istreambuf_iterator<char>());
+    if (!neighbors.empty()) corpus.neighbors = std::move(neighbors);
+    
+    return corpus;
+}
+
+static bool writeparsercorpus(const char* directory) {
+    parsercorpus corpus = synthesizeparsercorpus();
+    std::filesystem::path root(directory);
+    std::error_code ec;
+    
+    auto writefile = [&](const std::filesystem::path& path, const std::vector<uint8_t>& data) {
+        std::filesystem::create_directories(path.parent_path(), ec);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+        return file.good();
+    };
+    
+    bool ok = true;
+    for (const auto& f : corpus.smbios) ok &= writefile(root / "smbios" / (f.name + ".bin"), f.data);
+    for (const auto& f : corpus.edids) ok &= writefile(root / "edid" / (f.name + ".bin"), f.data);
+    for (const auto& f : corpus.storage) ok &= writefile(root / "storage" / (f.name + ".bin"), f.data);
+    ok &= writefile(root / "neighbors.bin", corpus.neighbors);
+    
+    std::ofstream instances(root / "instanceids.txt", std::ios::binary | std::ios::trunc);
+    for (const auto& id : corpus.instanceids) instances << widetoutf8(id) << "\n";
+    return ok && instances.good();
+}
+
+static bool parserndjson = false;
+
+// one line per benchmark and fixture; ns, bytes and allocations are per op, bytes counts what operator new handed out
+template <typename work>
+static void measureparser(const char* benchmark, const std::string& name, size_t inputbytes, size_t opsperround, int rounds, work&& run) {
+    size_t sink = run();
+    
+    size_t allocationsbefore = allocationcount.load();
+    size_t bytesbefore = allocatedbytes.load();
+    auto start = std::chrono::steady_clock::now();
+    
+    for (int r = 0; r < rounds; r++) {
+        sink += run();
+    }
+    
+    double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    double ops = (double)std::max<size_t>(1, opsperround) * rounds;
+    double allocations = (double)(allocationcount.load() - allocationsbefore) / ops;
+    double bytes = (double)(allocatedbytes.load() - bytesbefore) / ops;
+    
+    if (parserndjson) {
+        printf("{\"benchmark\":\"%s\",\"fixture\":\"%s\",\"ops\":%.0f,\"input_bytes\":%zu,\"ns_per_op\":%.1f,\"bytes_per_op\":%.1f,\"allocs_per_op\":%.3f}\n",
+            benchmark, name.c_str(), ops, inputbytes, ns / ops, bytes, allocations);
+    } else {
+        printf("%-26s %-24s %10.0f %12.1f %12.1f %12.3f\n", benchmark, name.c_str(), ops, ns / ops, bytes, allocations);
+    }
+    
+    if (sink == (size_t)-1) printf("\n");
+}
+
+static void benchparsers(const parsercorpus& corpus, int iterations) {
+    if (!parserndjson) {
+        printf("\n%-26s %-24s %10s %12s %12s %12s\n", "parser", "fixture", "ops", "ns/op", "bytes/op", "allocs/op");
+    }
+    
+    hardwareinfo hwinfo;
+    int corpusrounds = std::max(1, iterations / 10);
+    
+    for (const auto& f : corpus.smbios) {
+        smbiostable table;
+        measureparser("smbios parse", f.name, f.data.size(), 1, iterations, [&] {
+            table.parse(f.data.data(), f.data.size());
+            return table.size();
+        });
+        measureparser("smbios bios items", f.name, f.data.size(), 1, iterations, [&] {
+            return hwinfo.getbiosinfo(f.data).size();
+        });
+    }
+    
+    smbiostable table(corpus.smbios.front().data.data(), corpus.smbios.front().data.size());
+    const uint8_t* uuid = nullptr;
+    for (const auto& s : table.bytype(1)) uuid = s.field(8, 16);
+    if (uuid) {
+        measureparser("formatuuid", corpus.smbios.front().name, 16, 1, iterations * 10, [&] {
+            return hardwareinfo::formatuuid(uuid).size();
+        });
+    }
+    
+    std::vector<std::vector<BYTE>> edids;
+    for (const auto& f : corpus.edids) {
+        edidinfo info;
+        measureparser("edid decode", f.name, f.data.size(), 1, iterations, [&] {
+            return (size_t)decodeedid(f.data.data(), f.data.size(), info);
+        });
+        measureparser("edid name + serial", f.name, f.data.size(), 1, iterations, [&] {
+            decodeedid(f.data.data(), f.data.size(), info);
+            return edidname(info).size() + edidserial(info).size();
+        });
+        edids.push_back(f.data);
+    }
+    measureparser("monitor items", "all", 0, edids.size(), corpusrounds, [&] { return hwinfo.getmonitorinfo(edids).size(); });
+    
+    std::vector<diskprobe> probes;
+    for (const auto& f : corpus.storage) {
+        diskprobe probe;
+        measureparser("storage descriptor", f.name, f.data.size(), 1, iterations, [&] {
+            return (size_t)decodestoragedescriptor(f.data.data(), f.data.size(), probe.descriptor);
+        });
+        probe.device = {L"", L"descriptor " + utf8towide(f.name), (int)probes.size()};
+        probes.push_back(probe);
+    }
+    measureparser("disk items", "all", 0, probes.size(), corpusrounds, [&] { return hwinfo.getdiskinfo(probes).size(); });
+    
+    measureparser("usb instance serial", "instanceids", 0, corpus.instanceids.size(), iterations, [&] {
+        size_t serials = 0;
+        for (const auto& id : corpus.instanceids) {
+            serials += extractserialfrominstance(id, id.rfind(L"USBSTOR\\", 0) == 0).size();
+        }
+        return serials;
+    });
+    
+    neighbortable neighbors;
+    bool done = false;
+    decodeneighbormessages(corpus.neighbors.data(), corpus.neighbors.size(), neighbors, done);
+    neighbors.normalize();
+    size_t records = std::max<size_t>(1, neighbors.size());
+    
+    measureparser("neighbor decode", "neighbors", corpus.neighbors.size(), records, corpusrounds, [&] {
+        neighbortable decoded;
+        bool finished = false;
+        decodeneighbormessages(corpus.neighbors.data(), corpus.neighbors.size(), decoded, finished);
+        decoded.normalize();
+        return decoded.size();
+    });
+    
+    char text[64];
+    measureparser("mac format", "neighbors", 0, records, corpusrounds, [&] {
+        size_t length = 0;
+        for (const auto& entry : neighbors.records()) length += formatneighbormac(entry, text, 64);
+        return length;
+    });
+    measureparser("ip format", "neighbors", 0, records, corpusrounds, [&] {
+        size_t length = 0;
+        for (const auto& entry : neighbors.records()) length += formatneighboraddress(entry, text, 64);
+        return length;
+    });
+    measureparser("arp records", "neighbors", 0, records, corpusrounds, [&] {
+        recordstore items;
+        neighbortext record;
+        for (const auto& entry : neighbors.records()) items.add(neighborrecord(neighbors, entry, record));
+        return items.size();
+    });
+}
+
+static void benchtrace(int iterations) {
+    const int spans = iterations * 1000;
+    
+    printf("\n%-28s %10s %12s %12s\n", "trace span", "spans", "ns/span", "allocs/span");
+    
+    auto measure = [&](const char* name) {
+        size_t allocationsbefore = allocationcount.load();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < spans; i++) {
+            tracespan span("bench span");
+            span.bytes((size_t)i);
+        }
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        printf("%-28s %10d %12.2f %12.3f\n", name, spans, ns / spans, (double)(allocationcount.load() - allocationsbefore) / spans);
+    };
+    
+    measure("disabled");
+    starttrace();
+    measure("enabled");
+    
+    std::string path = (std::filesystem::temp_directory_path() / "ud-bench-trace.json").string();
+    auto start = std::chrono::steady_clock::now();
+    bool written = writetrace(path);
+    double ms = (double)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+    std::error_code ec;
+    printf("%-28s %10s %12.2f ms %s\n", "write chrome trace", written ? "ok" : "failed", ms, written ? "" : path.c_str());
+    std::filesystem::remove(path, ec);
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = 2000;
+    int machines = 2000;
+    int hosts = 2000;
+    int neighbors = 100000;
+    int textrecords = 1000000;
+    int serialvalues = 10000000;
+    int fingerprints = 1000000;
+    int indexidentifiers = 4000000;
+    int pagerows = 1000000;
+    int cpusweeps = 100;
+    bool parsersonly = false;
+    bool checksonly = false;
+    const char* fixturedir = nullptr;
+    const char* edidcorpus = nullptr;
+    const char* hivedir = nullptr;
+    const char* corpusdir = nullptr;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--machines" && i + 1 < argc) {
+            machines = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--edids" && i + 1 < argc) {
+            edidcorpus = argv[++i];
+        } else if (arg == "--hives" && i + 1 < argc) {
+            hivedir = argv[++i];
+        } else if (arg == "--neighbors" && i + 1 < argc) {
+            neighbors = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--text-records" && i + 1 < argc) {
+            textrecords = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--serial-values" && i + 1 < argc) {
+            serialvalues = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--fingerprints" && i + 1 < argc) {
+            fingerprints = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--index-identifiers" && i + 1 < argc) {
+            indexidentifiers = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--page-rows" && i + 1 < argc) {
+            pagerows = std::max(1000, atoi(argv[++i]));
+        } else if (arg == "--cpu-sweeps" && i + 1 < argc) {
+            cpusweeps = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--hosts" && i + 1 < argc) {
+            hosts = std::max(2, atoi(argv[++i]));
+        } else if (arg == "--fixtures" && i + 1 < argc) {
+            fixturedir = argv[++i];
+        } else if (arg == "--write-fixtures" && i + 1 < argc) {
+            return writeparsercorpus(argv[++i]) ? 0 : 1;
+        } else if (arg == "--parsers") {
+            parsersonly = true;
+        } else if (arg == "--checks") {
+            checksonly = true;
+        } else if (arg == "--ndjson") {
+            parsersonly = true;
+            parserndjson = true;
+        } else {
+            corpusdir = argv[i];
+        }
+    }
+    
+    // from the repository root or from bench/, where visual studio starts it
+    if (!fixturedir && std::filesystem::is_directory("bench/fixtures")) fixturedir = "bench/fixtures";
+    if (!fixturedir && std::filesystem::is_directory("fixtures")) fixturedir = "fixtures";
+    if (parsersonly) {
+        benchparsers(loadparsercorpus(fixturedir), iterations);
+        return checkfailures ? 1 : 0;
+    }
+    
+    // just the sections that check their output, at sizes that finish in moments
+    if (checksonly) {
+        benchwmi(1);
+        benchregistry(1);
+        benchsnapshot(1);
+        benchusb(1);
+        benchneighbors(4096);
+        benchtext(4096);
+        benchfingerprints(1024);
+        benchcpu(1);
+        printf("\n%zu checks failed\n", checkfailures);
+        return checkfailures ? 1 : 0;
+    }
+    
+    std::vector<fixture> corpus;
+    if (corpusdir) {
+        corpus = loadcorpus(corpusdir);
+    }
+    
+    if (corpus.empty()) {
+        corpus.push_back({"synthetic-desktop", synthesizetable(4, 1)});
+        corpus.push_back({"synthetic-server-2s-48dimm", synthesizetable(48, 2)});
+        corpus.push_back({"synthetic-server-8s-384dimm", synthesizetable(384, 8)});
+    }
+    
+    benchsmbios(corpus, iterations);
+    benchwmi(iterations);
+    benchsnapshot(iterations);
+    benchrecordstore(machines);
+    benchedid(4096, iterations, edidcorpus);
+    benchfleet(hosts);
+    benchindex(indexidentifiers);
+    benchregistry(iterations);
+    benchhive(iterations, hivedir);
+    benchusb(iterations);
+    benchneighbors(neighbors);
+    benchpages(pagerows);
+    benchtext(textrecords);
+    benchserials(serialvalues);
+    benchfingerprints(fingerprints);
+    benchcpu(cpusweeps);
+    benchparsers(loadparsercorpus(fixturedir), iterations);
+    benchtrace(iterations);
+    return checkfailures ? 1 : 0;
+}
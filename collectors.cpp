@@ -0,0 +1,88 @@
+#include "collectors.h"
+#include "threadpool.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+static std::vector<collector> bind(std::vector<collector> collectors, std::vector<collectorresult>& results) {
+    results.clear();
+    results.resize(collectors.size());
+    for (size_t i = 0; i < collectors.size(); i++) {
+        collectors[i].result = &results[i];
+    }
+    return collectors;
+}
+
+std::vector<collector> livecollectors(std::vector<collectorresult>& results) {
+    return bind({
+        {"bios", "bios/system", &hardwareinfo::getbiosinfo, nullptr},
+        {"cpu", "cpu", &hardwareinfo::getprocessorinfo, nullptr},
+        {"disk", "disk", &hardwareinfo::getdiskinfo, nullptr},
+        {"gpu", "gpu", &hardwareinfo::getvideocontrollerinfo, nullptr},
+        {"nic", "network adapter", &hardwareinfo::getnetworkadapterinfo, nullptr},
+        {"monitor", "monitor", &hardwareinfo::getmonitorinfo, nullptr},
+        {"usb", "usb device", &hardwareinfo::getusbdevices, nullptr},
+        {"arp", "arp table", nullptr, nullptr, &hardwareinfo::getarptable},
+    }, results);
+}
+
+std::vector<collector> registrycollectors(std::vector<collectorresult>& results) {
+    return bind({
+        {"bios", "bios/system", &hardwareinfo::getregistrybiosinfo, nullptr},
+        {"gpu", "gpu", &hardwareinfo::getregistryvideocontrollerinfo, nullptr},
+        {"nic", "network adapter", &hardwareinfo::getregistrynetworkadapterinfo, nullptr},
+        {"monitor", "monitor", &hardwareinfo::getregistrymonitorinfo, nullptr},
+    }, results);
+}
+
+std::vector<bool> runcollectors(hardwareinfo& hwinfo, const std::vector<collector>& collectors, int delay_per_fetch,
+    const std::function<void(size_t)>& oncomplete) {
+    std::vector<bool> succeeded(collectors.size(), false);
+    if (collectors.empty()) return succeeded;
+    
+    std::mutex completionlock;
+    threadpool pool(std::min(collectors.size(), threadpool::defaultthreadcount()));
+    
+    for (size_t i = 0; i < collectors.size(); i++) {
+        pool.submit([&, i] {
+            const collector& c = collectors[i];
+            if (delay_per_fetch > 0) std::this_thread::sleep_for(std::chrono::milliseconds(delay_per_fetch));
+            
+            bool failed = false;
+            std::string error;
+            {
+                tracespan span(c.key.c_str(), "collector");
+                try {
+                    c.result->clear();
+                    if (c.fetchneighbors) c.result->items = (hwinfo.*c.fetchneighbors)(c.result->neighbors);
+                    else c.result->items = (hwinfo.*c.fetch)();
+                } catch (const std::exception& e) {
+                    failed = true;
+                    error = e.what();
+                    if (error.empty()) error = "collector failed";
+                } catch (...) {
+                    failed = true;
+                    error = "unknown error";
+                }
+                span.check(!failed);
+            }
+            
+            // the category still completes, so the loading screen and a refresh see the failure instead of waiting on it
+            if (failed) {
+                c.result->clear();
+                c.result->items.add(c.key, c.key, "error", error, "");
+            }
+            
+            std::lock_guard<std::mutex> guard(completionlock);
+            succeeded[i] = !failed;
+            oncomplete(i);
+        });
+    }
+    
+    pool.wait();
+    hwinfo.endscan();
+    return succeeded;
+}
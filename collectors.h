@@ -0,0 +1,42 @@
+#pragma once
+
+#include "hardwareinfo.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+// what a collector leaves in its slot: records, and for arp the neighbor table, whose entries stay fixed size
+// until something reads them
+struct collectorresult {
+    recordstore items;
+    neighbortable neighbors;
+    
+    size_t size() const { return items.size() + neighbors.size(); }
+    void clear() { items.clear(); neighbors.clear(); }
+    
+    // every record in order; neighbor entries are formatted one at a time, so their views only last for the call
+    template <typename visitor>
+    void each(visitor&& visit) const {
+        for (const auto& record : items.records()) visit(record);
+        if (neighbors.empty()) return;
+        neighbortext text;
+        for (const auto& entry : neighbors.records()) visit(neighborrecord(neighbors, entry, text));
+    }
+};
+
+// a collector has fetch, or fetchneighbors when its entries are kept as a neighbor table
+struct collector {
+    std::string key;
+    std::string name;
+    recordstore (hardwareinfo::*fetch)();
+    collectorresult* result;
+    recordstore (hardwareinfo::*fetchneighbors)(neighbortable&) = nullptr;
+};
+
+// results is resized to match and each collector writes into its own slot
+std::vector<collector> livecollectors(std::vector<collectorresult>& results);
+std::vector<collector> registrycollectors(std::vector<collectorresult>& results);
+
+// a collector that throws leaves one error record in its slot and still completes; the result says which ones succeeded
+std::vector<bool> runcollectors(hardwareinfo& hwinfo, const std::vector<collector>& collectors, int delay_per_fetch,
+    const std::function<void(size_t)>& oncomplete);
@@ -0,0 +1,344 @@
+#include "consoleview.h"
+#include "textutil.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <conio.h>
+#else
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+// marks a place in the visible rows where a dashed line separates two groups
+static const uint32_t separatorrow = UINT32_MAX;
+
+static const size_t namewidth = 25;
+static const size_t valuewidth = 35;
+
+consolesize getconsolesize() {
+    consolesize size;
+#ifdef _WIN32
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        size.columns = (size_t)(info.srWindow.Right - info.srWindow.Left + 1);
+        size.rows = (size_t)(info.srWindow.Bottom - info.srWindow.Top + 1);
+    }
+#else
+    winsize window = {};
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &window) == 0 && window.ws_col > 0 && window.ws_row > 0) {
+        size.columns = window.ws_col;
+        size.rows = window.ws_row;
+    }
+#endif
+    return size;
+}
+
+void writeconsole(std::string_view frame) {
+    std::cout.flush();
+#ifdef _WIN32
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD written = 0;
+    WriteFile(out, frame.data(), (DWORD)frame.size(), &written, nullptr);
+#else
+    while (!frame.empty()) {
+        ssize_t written = write(STDOUT_FILENO, frame.data(), frame.size());
+        if (written <= 0) break;
+        frame.remove_prefix((size_t)written);
+    }
+#endif
+}
+
+#ifdef _WIN32
+int readconsolekey() {
+    while (true) {
+        int key = _getch();
+        if (key != 0 && key != 0xE0) return key;
+        
+        switch (_getch()) {
+            case 72: return keyup;
+            case 80: return keydown;
+            case 73: return keypageup;
+            case 81: return keypagedown;
+            case 71: return keyhome;
+            case 79: return keyend;
+        }
+    }
+}
+#else
+// escape sequences arrive together, so a lone escape is one with nothing behind it within a tenth of a second
+static int readsequencebyte() {
+    termios original;
+    if (tcgetattr(STDIN_FILENO, &original) != 0) return -1;
+    
+    termios raw = original;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 1;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    
+    unsigned char key = 0;
+    int result = read(STDIN_FILENO, &key, 1) == 1 ? key : -1;
+    
+    tcsetattr(STDIN_FILENO, TCSANOW, &original);
+    return result;
+}
+
+int readconsolekey() {
+    termios original;
+    if (tcgetattr(STDIN_FILENO, &original) != 0) return getchar();
+    
+    termios raw = original;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    
+    unsigned char key = 0;
+    int result = read(STDIN_FILENO, &key, 1) == 1 ? key : -1;
+    
+    tcsetattr(STDIN_FILENO, TCSANOW, &original);
+    if (result != 27) return result;
+    
+    int introducer = readsequencebyte();
+    if (introducer != '[' && introducer != 'O') return 27;
+    
+    int final = readsequencebyte();
+    switch (final) {
+        case 'A': return keyup;
+        case 'B': return keydown;
+        case 'H': return keyhome;
+        case 'F': return keyend;
+    }
+    if (final < '0' || final > '9' || readsequencebyte() != '~') return 0;
+    
+    switch (final) {
+        case '1': case '7': return keyhome;
+        case '4': case '8': return keyend;
+        case '5': return keypageup;
+        case '6': return keypagedown;
+    }
+    return 0;
+}
+#endif
+
+void appendfitted(std::string& out, std::string_view text, size_t width, bool pad) {
+    // counting code points is enough here: what the collectors report is not double width
+    size_t points = 0;
+    size_t cut = text.size();
+    size_t keep = width >= 3 ? width - 3 : width;
+    size_t kept = text.size();
+    for (size_t i = 0; i < text.size(); i++) {
+        if (((unsigned char)text[i] & 0xC0) == 0x80) continue;
+        if (points == keep) kept = i;
+        if (points == width) {
+            cut = i;
+            break;
+        }
+        points++;
+    }
+    
+    if (cut < text.size()) {
+        out.append(text.data(), width >= 3 ? kept : cut);
+        if (width >= 3) out += "...";
+        points = width;
+    } else {
+        out.append(text);
+    }
+    if (pad && points < width) out.append(width - points, ' ');
+}
+
+// name, value and the notes as the first columns of an item row
+static void appenditemtext(std::string& text, const recordview& item) {
+    text += "| ";
+    appendfitted(text, item.name, namewidth, true);
+    text += " | ";
+    appendfitted(text, item.value, valuewidth, true);
+}
+
+// what a filter or search matches an item against, folded to lower case
+static void appendhaystack(std::string& haystack, const recordview& item) {
+    haystack.append(item.name).append(1, '\n').append(item.value).append(1, '\n').append(item.notes).append(1, '\n').append(item.category);
+    asciilower(haystack);
+}
+
+void pageview::build(const recordstore& source) {
+    rows.clear();
+    items.clear();
+    headings.clear();
+    neighbors.clear();
+    
+    // grouped by category in the order a std::map would give, items keeping their order within a group
+    std::vector<uint32_t> order(source.size());
+    for (uint32_t i = 0; i < (uint32_t)source.size(); i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return source[a].category < source[b].category; });
+    
+    groups = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        if (i == 0 || source[order[i]].category != source[order[i - 1]].category) groups++;
+    }
+    
+    rows.reserve(source.size() + (groups > 1 ? groups : 0));
+    items.reserve(source.size());
+    
+    uint32_t group = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        const recordview& item = source[order[i]];
+        bool first = i == 0 || item.category != source[order[i - 1]].category;
+        if (first) {
+            if (i > 0) group++;
+            if (groups > 1) {
+                headings.push_back((uint32_t)rows.size());
+                rows.push_back({pagerowkind::heading, group, "| [ " + std::string(item.category) + " ]", {}, {}});
+            }
+        }
+        
+        pagerow row = {pagerowkind::item, group, {}, std::string(item.notes), {}};
+        
+        row.text.reserve(namewidth + valuewidth + 5);
+        appenditemtext(row.text, item);
+        
+        row.haystack.reserve(item.name.size() + item.value.size() + item.notes.size() + item.category.size() + 3);
+        appendhaystack(row.haystack, item);
+        
+        items.push_back((uint32_t)rows.size());
+        rows.push_back(std::move(row));
+    }
+    
+    std::string kept;
+    kept.swap(current);
+    matches = items;
+    if (!filter(kept)) layout();
+}
+
+void pageview::build(const neighbortable& table) {
+    rows.clear();
+    headings.clear();
+    
+    // every entry is one arp record, so there is a single group and a row is just the entry's index
+    neighbors = table;
+    groups = 1;
+    items.resize(neighbors.size());
+    for (uint32_t i = 0; i < (uint32_t)items.size(); i++) items[i] = i;
+    
+    std::string kept;
+    kept.swap(current);
+    matches = items;
+    if (!filter(kept)) layout();
+}
+
+bool pageview::contains(uint32_t row, std::string_view lowered, neighbortext& text, std::string& haystack) const {
+    if (neighbors.empty()) return rows[row].haystack.find(lowered) != std::string::npos;
+    
+    haystack.clear();
+    appendhaystack(haystack, neighborrecord(neighbors, neighbors.records()[row], text));
+    return haystack.find(lowered) != std::string::npos;
+}
+
+bool pageview::filter(std::string_view text) {
+    std::string lowered(text);
+    asciilower(lowered);
+    if (lowered == current) return false;
+    
+    // every row that matches the longer text also matched the shorter one
+    bool narrowing = lowered.size() >= current.size() && lowered.compare(0, current.size(), current) == 0;
+    const std::vector<uint32_t>& candidates = narrowing ? matches : items;
+    
+    std::vector<uint32_t> next;
+    next.reserve(candidates.size());
+    neighbortext scratch;
+    std::string haystack;
+    for (uint32_t row : candidates) {
+        if (lowered.empty() || contains(row, lowered, scratch, haystack)) next.push_back(row);
+    }
+    
+    matches.swap(next);
+    current = std::move(lowered);
+    layout();
+    return true;
+}
+
+void pageview::layout() {
+    visible.clear();
+    visible.reserve(matches.size() + (groups > 1 ? groups * 2 : 0));
+    
+    // a group with nothing left in it disappears along with its heading
+    uint32_t group = UINT32_MAX;
+    for (uint32_t row : matches) {
+        uint32_t rowgroup = neighbors.empty() ? rows[row].group : 0;
+        if (rowgroup != group) {
+            if (group != UINT32_MAX) visible.push_back(separatorrow);
+            group = rowgroup;
+            if (!headings.empty()) visible.push_back(headings[group]);
+        }
+        visible.push_back(row);
+    }
+}
+
+size_t pageview::find(std::string_view text, size_t start, bool backwards) const {
+    std::string lowered(text);
+    asciilower(lowered);
+    if (lowered.empty() || visible.empty()) return npos;
+    
+    neighbortext scratch;
+    std::string haystack;
+    auto matchesat = [&](size_t index) {
+        uint32_t row = visible[index];
+        if (row == separatorrow || (neighbors.empty() && rows[row].kind != pagerowkind::item)) return false;
+        return contains(row, lowered, scratch, haystack);
+    };
+    
+    if (backwards) {
+        for (size_t i = std::min(start, visible.size() - 1) + 1; i-- > 0;) {
+            if (matchesat(i)) return i;
+        }
+    } else {
+        for (size_t i = start; i < visible.size(); i++) {
+            if (matchesat(i)) return i;
+        }
+    }
+    return npos;
+}
+
+void pageview::render(std::string& frame, size_t top, size_t height, size_t width, size_t marked) const {
+    // one column short of the edge, so a full line never wraps the cursor onto the next one
+    size_t columns = width > 1 ? width - 1 : 1;
+    size_t notesstart = namewidth + valuewidth + 5;
+    
+    auto appendrow = [&](pagerowkind kind, std::string_view text, std::string_view notes) {
+        if (kind == pagerowkind::item && !notes.empty() && columns > notesstart + 3) {
+            appendfitted(frame, text, notesstart, false);
+            frame += " | ";
+            appendfitted(frame, notes, columns - notesstart - 3, false);
+        } else {
+            appendfitted(frame, text, columns, false);
+        }
+    };
+    
+    // neighbor rows are formatted here, for the few that are on screen
+    neighbortext scratch;
+    std::string text;
+    
+    for (size_t i = top; i < visible.size() && i < top + height; i++) {
+        if (i == marked) frame += "\033[7m";
+        
+        uint32_t index = visible[i];
+        if (index == separatorrow) {
+            frame.append(std::min<size_t>(columns, 80), '-');
+        } else if (!neighbors.empty()) {
+            recordview item = neighborrecord(neighbors, neighbors.records()[index], scratch);
+            text.clear();
+            appenditemtext(text, item);
+            appendrow(pagerowkind::item, text, item.notes);
+        } else {
+            const pagerow& row = rows[index];
+            appendrow(row.kind, row.text, row.notes);
+        }
+        
+        if (i == marked) frame += "\033[0m";
+        frame += "\033[K\n";
+    }
+}
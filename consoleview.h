@@ -0,0 +1,85 @@
+#pragma once
+
+#include "neighbor.h"
+#include "recordstore.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// what readconsolekey hands back for the keys that do not arrive as a single character
+constexpr int keyup = 0x100;
+constexpr int keydown = 0x101;
+constexpr int keypageup = 0x102;
+constexpr int keypagedown = 0x103;
+constexpr int keyhome = 0x104;
+constexpr int keyend = 0x105;
+
+struct consolesize {
+    size_t columns = 90;
+    size_t rows = 30;
+};
+
+consolesize getconsolesize();
+
+// one write for the whole frame, so a redraw never shows half of the old page
+void writeconsole(std::string_view frame);
+
+int readconsolekey();
+
+// appends text cut to width code points, ending in "..." when it had to be cut, padded with spaces if asked
+void appendfitted(std::string& out, std::string_view text, size_t width, bool pad);
+
+enum class pagerowkind : uint8_t {
+    heading,
+    item
+};
+
+struct pagerow {
+    pagerowkind kind;
+    uint32_t group;
+    std::string text;
+    std::string notes;
+    std::string haystack;
+};
+
+// a category page grouped and laid out once per scan; filtering and drawing only touch the
+// prepared rows, and drawing only the ones on screen, so a redraw costs the same for ten rows or a million.
+// an arp page keeps its neighbor entries as they are and formats a row only to draw, filter or search it
+class pageview {
+public:
+    // keeps the current filter and applies it to the new rows
+    void build(const recordstore& items);
+    void build(const neighbortable& table);
+    
+    // case insensitive over name, value, notes and category; a filter that extends the last one only
+    // rechecks the rows that still matched. false when nothing changed
+    bool filter(std::string_view text);
+    const std::string& filtertext() const { return current; }
+    
+    size_t size() const { return visible.size(); }
+    size_t total() const { return items.size(); }
+    size_t matched() const { return matches.size(); }
+    
+    // the nearest visible item row from start on (or back from it) containing text, or npos
+    size_t find(std::string_view text, size_t start, bool backwards) const;
+    
+    // visible rows from top on, one line each, at most width columns; marked is drawn in reverse video
+    void render(std::string& frame, size_t top, size_t height, size_t width, size_t marked) const;
+    
+    static constexpr size_t npos = (size_t)-1;
+
+private:
+    void layout();
+    bool contains(uint32_t row, std::string_view lowered, neighbortext& text, std::string& haystack) const;
+    
+    std::vector<pagerow> rows;
+    neighbortable neighbors;
+    std::vector<uint32_t> items;
+    std::vector<uint32_t> headings;
+    std::vector<uint32_t> matches;
+    std::vector<uint32_t> visible;
+    size_t groups = 0;
+    std::string current;
+};
@@ -0,0 +1,329 @@
+#include "cpuprobe.h"
+#include "textutil.h"
+#include "threadpool.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPUPROBEX86
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include "sysfs.h"
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#endif
+
+const cpuidleaf* findcpuidleaf(const cpuprobe& probe, uint32_t leaf, uint32_t subleaf) {
+    for (const auto& entry : probe.leaves) {
+        if (entry.leaf == leaf && entry.subleaf == subleaf) return &entry;
+    }
+    return nullptr;
+}
+
+static void appendregister(std::string& text, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) text.push_back((char)(value >> shift));
+}
+
+// registers read as text stop at the first nul and lose the padding around them
+static std::string registertext(std::string text) {
+    text.resize(std::min(text.size(), text.find('\0')));
+    return std::string(trimascii(text));
+}
+
+cpuidentity decodecpuidentity(const cpuprobe& probe) {
+    cpuidentity identity;
+    
+    if (const cpuidleaf* basic = findcpuidleaf(probe, 0)) {
+        std::string vendor;
+        appendregister(vendor, basic->ebx);
+        appendregister(vendor, basic->edx);
+        appendregister(vendor, basic->ecx);
+        identity.vendor = registertext(vendor);
+    }
+    
+    if (const cpuidleaf* features = findcpuidleaf(probe, 1)) {
+        uint32_t signature = features->eax;
+        uint32_t family = (signature >> 8) & 0xF;
+        uint32_t model = (signature >> 4) & 0xF;
+        
+        identity.signature = signature;
+        identity.stepping = signature & 0xF;
+        identity.family = family == 0xF ? family + ((signature >> 20) & 0xFF) : family;
+        identity.model = family == 0x6 || family == 0xF ? model + (((signature >> 16) & 0xF) << 4) : model;
+        identity.virtualized = (features->ecx & (1u << 31)) != 0;
+    }
+    
+    if (const cpuidleaf* hypervisor = findcpuidleaf(probe, 0x40000000)) {
+        std::string vendor;
+        appendregister(vendor, hypervisor->ebx);
+        appendregister(vendor, hypervisor->ecx);
+        appendregister(vendor, hypervisor->edx);
+        identity.hypervisor = registertext(vendor);
+    }
+    
+    std::string brand;
+    for (uint32_t leaf = 0x80000002; leaf <= 0x80000004; leaf++) {
+        const cpuidleaf* part = findcpuidleaf(probe, leaf);
+        if (!part) break;
+        appendregister(brand, part->eax);
+        appendregister(brand, part->ebx);
+        appendregister(brand, part->ecx);
+        appendregister(brand, part->edx);
+    }
+    identity.brand = registertext(brand);
+    
+    return identity;
+}
+
+std::vector<cpucache> decodecpucaches(const cpuprobe& probe) {
+    std::vector<cpucache> caches;
+    
+    // intel's deterministic cache leaf, or amd's copy of it in the extended range; both stop at a null type
+    for (uint32_t leaf : {4u, 0x8000001Du}) {
+        for (uint32_t subleaf = 0;; subleaf++) {
+            const cpuidleaf* entry = findcpuidleaf(probe, leaf, subleaf);
+            if (!entry || (entry->eax & 0x1F) == 0) break;
+            
+            cpucache cache;
+            uint32_t type = entry->eax & 0x1F;
+            cache.type = type == 1 ? 'd' : type == 2 ? 'i' : 'u';
+            cache.level = (entry->eax >> 5) & 0x7;
+            cache.sharing = ((entry->eax >> 14) & 0xFFF) + 1;
+            cache.ways = ((entry->ebx >> 22) & 0x3FF) + 1;
+            cache.linesize = (entry->ebx & 0xFFF) + 1;
+            uint64_t partitions = ((entry->ebx >> 12) & 0x3FF) + 1;
+            cache.size = (uint64_t)cache.ways * partitions * cache.linesize * ((uint64_t)entry->ecx + 1);
+            caches.push_back(cache);
+        }
+        if (!caches.empty()) break;
+    }
+    
+    return caches;
+}
+
+static uint32_t bitwidth(uint32_t count) {
+    uint32_t width = 0;
+    while (width < 32 && (1ull << width) < count) width++;
+    return width;
+}
+
+uint32_t cpucachegroup(const cpucache& cache, uint32_t apicid) {
+    uint32_t shift = bitwidth(cache.sharing);
+    return shift >= 32 ? 0 : apicid >> shift;
+}
+
+cputopology decodecputopology(const cpuprobe& probe) {
+    cputopology topology;
+    
+    const cpuidleaf* features = findcpuidleaf(probe, 1);
+    if (features) topology.apicid = features->ebx >> 24;
+    
+    // 0x1f adds dies and modules to what 0xb reports; either way the x2apic id splits at the smt and package shifts
+    uint32_t smtshift = 0;
+    uint32_t packageshift = 0;
+    bool levels = false;
+    for (uint32_t leaf : {0x1Fu, 0xBu}) {
+        const cpuidleaf* first = findcpuidleaf(probe, leaf, 0);
+        if (!first || first->ebx == 0) continue;
+        
+        topology.apicid = first->edx;
+        for (uint32_t subleaf = 0;; subleaf++) {
+            const cpuidleaf* level = findcpuidleaf(probe, leaf, subleaf);
+            if (!level) break;
+            uint32_t type = (level->ecx >> 8) & 0xFF;
+            if (type == 0) break;
+            if (type == 1) smtshift = level->eax & 0x1F;
+            packageshift = level->eax & 0x1F;
+        }
+        levels = true;
+        break;
+    }
+    
+    if (!levels && features && (features->edx & (1u << 28))) {
+        packageshift = bitwidth((features->ebx >> 16) & 0xFF);
+    }
+    
+    uint32_t coremask = packageshift > smtshift ? (uint32_t)((1ull << (packageshift - smtshift)) - 1) : 0;
+    topology.thread = topology.apicid & (uint32_t)((1ull << smtshift) - 1);
+    topology.core = (topology.apicid >> smtshift) & coremask;
+    topology.package = packageshift >= 32 ? 0 : topology.apicid >> packageshift;
+    
+    const cpuidleaf* extended = findcpuidleaf(probe, 7);
+    const cpuidleaf* hybrid = findcpuidleaf(probe, 0x1A);
+    if (extended && hybrid && (extended->edx & (1u << 15))) {
+        uint32_t type = hybrid->eax >> 24;
+        if (type == 0x40) topology.coretype = cpucoretype::performance;
+        if (type == 0x20) topology.coretype = cpucoretype::efficient;
+    }
+    
+    return topology;
+}
+
+#ifdef CPUPROBEX86
+static cpuidleaf readcpuid(uint32_t leaf, uint32_t subleaf) {
+    cpuidleaf entry;
+    entry.leaf = leaf;
+    entry.subleaf = subleaf;
+#ifdef _MSC_VER
+    int registers[4];
+    __cpuidex(registers, (int)leaf, (int)subleaf);
+    entry.eax = (uint32_t)registers[0];
+    entry.ebx = (uint32_t)registers[1];
+    entry.ecx = (uint32_t)registers[2];
+    entry.edx = (uint32_t)registers[3];
+#else
+    __cpuid_count(leaf, subleaf, entry.eax, entry.ebx, entry.ecx, entry.edx);
+#endif
+    return entry;
+}
+#endif
+
+bool capturecpuid(cpuprobe& probe) {
+    probe.leaves.clear();
+#ifdef CPUPROBEX86
+    auto read = [&](uint32_t leaf, uint32_t subleaf) {
+        probe.leaves.push_back(readcpuid(leaf, subleaf));
+        return probe.leaves.back();
+    };
+    
+    // enumerated leaves end at a null entry; the bound only guards against firmware that never sends one
+    auto readlist = [&](uint32_t leaf, auto&& last) {
+        for (uint32_t subleaf = 0; subleaf < 16; subleaf++) {
+            if (last(read(leaf, subleaf))) break;
+        }
+    };
+    
+    uint32_t maxleaf = read(0, 0).eax;
+    cpuidleaf features = maxleaf >= 1 ? read(1, 0) : cpuidleaf();
+    if (maxleaf >= 4) readlist(4, [](const cpuidleaf& entry) { return (entry.eax & 0x1F) == 0; });
+    if (maxleaf >= 7) read(7, 0);
+    if (maxleaf >= 0xB) readlist(0xB, [](const cpuidleaf& entry) { return ((entry.ecx >> 8) & 0xFF) == 0; });
+    if (maxleaf >= 0x1A) read(0x1A, 0);
+    if (maxleaf >= 0x1F) readlist(0x1F, [](const cpuidleaf& entry) { return ((entry.ecx >> 8) & 0xFF) == 0; });
+    if (features.ecx & (1u << 31)) read(0x40000000, 0);
+    
+    uint32_t maxextended = read(0x80000000, 0).eax;
+    if (maxextended < 0x80000000 || maxextended > 0x800000FF) maxextended = 0;
+    if (maxextended >= 0x80000004) {
+        for (uint32_t leaf = 0x80000002; leaf <= 0x80000004; leaf++) read(leaf, 0);
+    }
+    if (maxextended >= 0x8000001D) readlist(0x8000001D, [](const cpuidleaf& entry) { return (entry.eax & 0x1F) == 0; });
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef _WIN32
+std::vector<cpuprobe> probecpus() {
+    struct processor {
+        WORD group;
+        BYTE number;
+    };
+    
+    std::vector<processor> processors;
+    WORD groups = GetActiveProcessorGroupCount();
+    for (WORD group = 0; group < groups; group++) {
+        DWORD count = GetActiveProcessorCount(group);
+        for (DWORD number = 0; number < count && number < sizeof(KAFFINITY) * 8; number++) {
+            processors.push_back({group, (BYTE)number});
+        }
+    }
+    
+    std::vector<cpuprobe> probes(processors.size());
+    threadpool pool(std::min(processors.size(), threadpool::defaultthreadcount()));
+    pool.parallelfor(processors.size(), [&](size_t, size_t i) {
+        tracespan span("SetThreadGroupAffinity + cpuid");
+        GROUP_AFFINITY affinity = {};
+        affinity.Mask = (KAFFINITY)1 << processors[i].number;
+        affinity.Group = processors[i].group;
+        
+        // the pool goes away with this sweep, so its threads are never handed back their old affinity
+        probes[i].index = (uint32_t)i;
+        probes[i].pinned = span.check(SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0);
+        capturecpuid(probes[i]);
+    });
+    
+    return probes;
+}
+#else
+static const char* cpupath = "/sys/devices/system/cpu/";
+
+// "0-3,8,10-11" as the kernel writes cpu lists
+static std::vector<uint32_t> parsecpulist(const std::string& list) {
+    std::vector<uint32_t> cpus;
+    const char* cursor = list.c_str();
+    while (*cursor) {
+        char* end = nullptr;
+        unsigned long first = strtoul(cursor, &end, 10);
+        if (end == cursor) break;
+        unsigned long last = first;
+        if (*end == '-') {
+            cursor = end + 1;
+            last = strtoul(cursor, &end, 10);
+            if (end == cursor) break;
+        }
+        for (unsigned long cpu = first; cpu <= last && cpus.size() < 65536; cpu++) cpus.push_back((uint32_t)cpu);
+        if (*end != ',') break;
+        cursor = end + 1;
+    }
+    return cpus;
+}
+
+static int readsysfsnumber(const std::string& path) {
+    std::string text = readsysfsstring(path);
+    if (text.empty()) return -1;
+    return (int)strtol(text.c_str(), nullptr, 10);
+}
+
+std::vector<cpuprobe> probecpus() {
+    std::vector<uint32_t> cpus = parsecpulist(readsysfsstring(std::string(cpupath) + "online"));
+    if (cpus.empty()) {
+        for (uint32_t cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) cpus.push_back(cpu);
+    }
+    
+    std::vector<cpuprobe> probes(cpus.size());
+    threadpool pool(std::min(cpus.size(), threadpool::defaultthreadcount()));
+    pool.parallelfor(cpus.size(), [&](size_t, size_t i) {
+        cpuprobe& probe = probes[i];
+        probe.index = cpus[i];
+        
+        {
+            tracespan span("sched_setaffinity + cpuid");
+            // sized for the cpu number, since a fixed cpu_set_t stops at CPU_SETSIZE
+            cpu_set_t* set = CPU_ALLOC(cpus[i] + 1);
+            size_t setsize = CPU_ALLOC_SIZE(cpus[i] + 1);
+            bool pinned = false;
+            if (set) {
+                CPU_ZERO_S(setsize, set);
+                CPU_SET_S(cpus[i], setsize, set);
+                
+                // the pool goes away with this sweep, so its threads are never handed back their old affinity
+                pinned = pthread_setaffinity_np(pthread_self(), setsize, set) == 0 && sched_getcpu() == (int)cpus[i];
+                CPU_FREE(set);
+            }
+            probe.pinned = span.check(pinned);
+            capturecpuid(probe);
+        }
+        
+        std::string base = std::string(cpupath) + "cpu" + std::to_string(cpus[i]) + "/";
+        probe.package = readsysfsnumber(base + "topology/physical_package_id");
+        probe.die = readsysfsnumber(base + "topology/die_id");
+        probe.core = readsysfsnumber(base + "topology/core_id");
+        std::string microcode = readsysfsstring(base + "microcode/version");
+        if (!microcode.empty()) probe.microcode = strtoull(microcode.c_str(), nullptr, 16);
+    });
+    
+    return probes;
+}
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct cpuidleaf {
+    uint32_t leaf = 0;
+    uint32_t subleaf = 0;
+    uint32_t eax = 0;
+    uint32_t ebx = 0;
+    uint32_t ecx = 0;
+    uint32_t edx = 0;
+};
+
+// what one logical processor reported about itself, read on a thread pinned to it; the os ids are -1 where
+// the platform has none to give (linux reads them from /sys/devices/system/cpu)
+struct cpuprobe {
+    uint32_t index = 0;
+    bool pinned = false;
+    std::vector<cpuidleaf> leaves;
+    uint64_t microcode = 0;
+    int package = -1;
+    int die = -1;
+    int core = -1;
+};
+
+struct cpuidentity {
+    std::string vendor;
+    std::string brand;
+    std::string hypervisor;
+    uint32_t signature = 0;
+    uint32_t family = 0;
+    uint32_t model = 0;
+    uint32_t stepping = 0;
+    bool virtualized = false;
+};
+
+struct cpucache {
+    uint32_t level = 0;
+    char type = 'u';
+    uint64_t size = 0;
+    uint32_t ways = 0;
+    uint32_t linesize = 0;
+    // how many apic ids the cache spans, a power of two that can be more than there are processors sharing it
+    uint32_t sharing = 0;
+};
+
+enum class cpucoretype : uint8_t {
+    unknown,
+    performance,
+    efficient
+};
+
+struct cputopology {
+    uint32_t apicid = 0;
+    uint32_t package = 0;
+    uint32_t core = 0;
+    uint32_t thread = 0;
+    cpucoretype coretype = cpucoretype::unknown;
+};
+
+// null when the leaf was not captured
+const cpuidleaf* findcpuidleaf(const cpuprobe& probe, uint32_t leaf, uint32_t subleaf = 0);
+
+cpuidentity decodecpuidentity(const cpuprobe& probe);
+std::vector<cpucache> decodecpucaches(const cpuprobe& probe);
+cputopology decodecputopology(const cpuprobe& probe);
+
+// the same for every logical processor sharing one instance of the cache
+uint32_t cpucachegroup(const cpucache& cache, uint32_t apicid);
+
+// every leaf the decoders use, read on the calling thread; false where the instruction set has no cpuid
+bool capturecpuid(cpuprobe& probe);
+
+// one probe per online logical processor, each captured on a pool thread pinned to it
+std::vector<cpuprobe> probecpus();
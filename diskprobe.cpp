@@ -0,0 +1,246 @@
+#include "diskprobe.h"
+#include "textutil.h"
+#include "threadpool.h"
+#include "trace.h"
+#include <algorithm>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <initguid.h>
+#include <winioctl.h>
+#include <setupapi.h>
+
+#pragma comment(lib, "setupapi.lib")
+#else
+#include "sysfs.h"
+#include <climits>
+#include <cstdlib>
+#endif
+
+static uint32_t readle32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static std::string descriptorstring(const uint8_t* buffer, size_t length, uint32_t offset) {
+    if (offset == 0 || offset >= length) return "";
+    
+    const char* start = reinterpret_cast<const char*>(buffer + offset);
+    size_t available = length - offset;
+    size_t size = 0;
+    while (size < available && start[size] != 0) size++;
+    
+    return std::string(trimascii(std::string_view(start, size)));
+}
+
+bool decodestoragedescriptor(const uint8_t* buffer, size_t length, diskdescriptor& descriptor) {
+    descriptor = diskdescriptor();
+    if (!buffer || length < 36) return false;
+    
+    uint32_t size = readle32(buffer + 4);
+    if (size > 0 && size < length) length = size;
+    
+    descriptor.removable = buffer[10] != 0;
+    descriptor.vendor = descriptorstring(buffer, length, readle32(buffer + 12));
+    descriptor.model = descriptorstring(buffer, length, readle32(buffer + 16));
+    descriptor.revision = descriptorstring(buffer, length, readle32(buffer + 20));
+    descriptor.serial = descriptorstring(buffer, length, readle32(buffer + 24));
+    descriptor.bustype = readle32(buffer + 28);
+    return true;
+}
+
+std::string bustypename(uint32_t bustype) {
+    static const char* names[] = {
+        "unknown", "scsi", "atapi", "ata", "1394", "ssa", "fibre", "usb", "raid", "iscsi",
+        "sas", "sata", "sd", "mmc", "virtual", "filebackedvirtual", "spaces", "nvme", "scm", "ufs"
+    };
+    if (bustype < sizeof(names) / sizeof(names[0])) return names[bustype];
+    return "bus " + std::to_string(bustype);
+}
+
+#ifdef _WIN32
+std::vector<diskdevice> enumeratedisks() {
+    std::vector<diskdevice> devices;
+    tracespan span("SetupDi disk interfaces");
+    
+    HDEVINFO deviceinfoset = SetupDiGetClassDevsW(&GUID_DEVINTERFACE_DISK, nullptr, nullptr, DIGCF_PRESENT | DIGCF_DEVICEINTERFACE);
+    if (deviceinfoset != INVALID_HANDLE_VALUE) {
+        SP_DEVICE_INTERFACE_DATA interfacedata;
+        interfacedata.cbSize = sizeof(SP_DEVICE_INTERFACE_DATA);
+        
+        std::vector<BYTE> detailbuffer(1024);
+        
+        for (DWORD i = 0; SetupDiEnumDeviceInterfaces(deviceinfoset, nullptr, &GUID_DEVINTERFACE_DISK, i, &interfacedata); i++) {
+            DWORD required = 0;
+            SetupDiGetDeviceInterfaceDetailW(deviceinfoset, &interfacedata, nullptr, 0, &required, nullptr);
+            if (required == 0) continue;
+            if (required > detailbuffer.size()) detailbuffer.resize(required);
+            
+            auto detail = reinterpret_cast<PSP_DEVICE_INTERFACE_DETAIL_DATA_W>(detailbuffer.data());
+            detail->cbSize = sizeof(SP_DEVICE_INTERFACE_DETAIL_DATA_W);
+            if (!SetupDiGetDeviceInterfaceDetailW(deviceinfoset, &interfacedata, detail, required, nullptr, nullptr)) continue;
+            
+            devices.push_back({detail->DevicePath, L"", -1});
+        }
+        
+        SetupDiDestroyDeviceInfoList(deviceinfoset);
+    } else {
+        span.fail();
+    }
+    
+    if (devices.empty()) {
+        for (int i = 0; i < 32; i++) {
+            devices.push_back({L"\\\\.\\PhysicalDrive" + std::to_wstring(i), L"physical drive " + std::to_wstring(i), i});
+        }
+    }
+    
+    return devices;
+}
+
+bool probedisk(diskprobe& probe) {
+    HANDLE handle;
+    {
+        tracespan span("CreateFileW disk");
+        handle = CreateFileW(probe.device.path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE,
+            nullptr, OPEN_EXISTING, 0, nullptr);
+        if (!span.check(handle != INVALID_HANDLE_VALUE)) return false;
+    }
+    
+    STORAGE_PROPERTY_QUERY query = {};
+    query.PropertyId = StorageDeviceProperty;
+    query.QueryType = PropertyStandardQuery;
+    
+    BYTE buffer[4096];
+    DWORD bytesreturned = 0;
+    
+    bool ok;
+    {
+        tracespan span("IOCTL_STORAGE_QUERY_PROPERTY");
+        ok = span.check(DeviceIoControl(handle, IOCTL_STORAGE_QUERY_PROPERTY,
+            &query, sizeof(query), buffer, sizeof(buffer),
+            &bytesreturned, nullptr) && bytesreturned > 0);
+        span.bytes(bytesreturned);
+    }
+    
+    if (ok && probe.device.index < 0) {
+        tracespan span("IOCTL_STORAGE_GET_DEVICE_NUMBER");
+        STORAGE_DEVICE_NUMBER number = {};
+        DWORD numberreturned = 0;
+        if (span.check(DeviceIoControl(handle, IOCTL_STORAGE_GET_DEVICE_NUMBER, nullptr, 0,
+            &number, sizeof(number), &numberreturned, nullptr))) {
+            probe.device.index = (int)number.DeviceNumber;
+        }
+    }
+    
+    CloseHandle(handle);
+    
+    return ok && decodestoragedescriptor(buffer, bytesreturned, probe.descriptor);
+}
+#else
+std::vector<diskdevice> enumeratedisks() {
+    std::vector<diskdevice> devices;
+    
+    for (const auto& name : listsysfsdirectory("/sys/block")) {
+        if (name.rfind("loop", 0) == 0 || name.rfind("ram", 0) == 0 || name.rfind("zram", 0) == 0 ||
+            name.rfind("dm-", 0) == 0 || name.rfind("md", 0) == 0 || name.rfind("sr", 0) == 0) {
+            continue;
+        }
+        
+        std::string path = "/sys/block/" + name;
+        if (listsysfsdirectory(path + "/device").empty()) continue;
+        
+        diskdevice device;
+        device.path = std::wstring(path.begin(), path.end());
+        device.label = L"block device " + std::wstring(name.begin(), name.end());
+        device.index = (int)devices.size();
+        devices.push_back(device);
+    }
+    
+    return devices;
+}
+
+static std::string readvpdserial(const std::string& path) {
+    std::vector<uint8_t> page = readsysfsbinary(path, 512);
+    if (page.size() < 4 || page[1] != 0x80) return "";
+    
+    size_t length = ((size_t)page[2] << 8) | page[3];
+    length = std::min(length, page.size() - 4);
+    return std::string(trimascii(std::string_view(reinterpret_cast<const char*>(page.data()) + 4, length)));
+}
+
+bool probedisk(diskprobe& probe) {
+    diskdescriptor& descriptor = probe.descriptor;
+    descriptor = diskdescriptor();
+    
+    std::string path(probe.device.path.begin(), probe.device.path.end());
+    std::string name = path.substr(path.rfind('/') + 1);
+    std::string devicedir = path + "/device/";
+    
+    descriptor.model = readsysfsstring(devicedir + "model");
+    descriptor.vendor = readsysfsstring(devicedir + "vendor");
+    descriptor.serial = readsysfsstring(devicedir + "serial");
+    descriptor.revision = readsysfsstring(devicedir + "rev");
+    descriptor.removable = readsysfsstring(path + "/removable") == "1";
+    
+    char resolved[PATH_MAX];
+    std::string resolvedpath = realpath(path.c_str(), resolved) ? resolved : "";
+    
+    if (name.rfind("nvme", 0) == 0) {
+        descriptor.bustype = 17;
+        if (descriptor.revision.empty()) descriptor.revision = readsysfsstring(devicedir + "firmware_rev");
+        if (descriptor.serial.empty()) descriptor.serial = readsysfsstring(path + "/wwid");
+    } else if (name.rfind("mmcblk", 0) == 0) {
+        descriptor.bustype = readsysfsstring(devicedir + "type") == "SD" ? 12 : 13;
+        if (descriptor.model.empty()) descriptor.model = readsysfsstring(devicedir + "name");
+        if (descriptor.revision.empty()) descriptor.revision = readsysfsstring(devicedir + "fwrev");
+    } else if (name.rfind("vd", 0) == 0 || name.rfind("xvd", 0) == 0) {
+        descriptor.bustype = 14;
+        if (descriptor.serial.empty()) descriptor.serial = readsysfsstring(path + "/serial");
+    } else if (resolvedpath.find("/usb") != std::string::npos) {
+        descriptor.bustype = 7;
+    } else if (descriptor.vendor == "ATA") {
+        descriptor.bustype = 11;
+    } else {
+        descriptor.bustype = 1;
+    }
+    
+    if (descriptor.serial.empty()) descriptor.serial = readvpdserial(devicedir + "vpd_pg80");
+    
+    return !descriptor.model.empty() || !descriptor.serial.empty();
+}
+#endif
+
+std::vector<diskprobe> probedisks() {
+    std::vector<diskdevice> devices = enumeratedisks();
+    std::vector<diskprobe> probes;
+    std::mutex probelock;
+    
+    if (devices.empty()) return probes;
+    
+    {
+        threadpool pool(std::min(devices.size(), (size_t)8));
+        
+        for (const auto& device : devices) {
+            pool.submit([&, device] {
+                diskprobe probe;
+                probe.device = device;
+                if (!probedisk(probe)) return;
+                
+                if (probe.device.label.empty() && probe.device.index >= 0) {
+                    probe.device.label = L"physical drive " + std::to_wstring(probe.device.index);
+                }
+                
+                std::lock_guard<std::mutex> guard(probelock);
+                probes.push_back(std::move(probe));
+            });
+        }
+        
+        pool.wait();
+    }
+    
+    std::sort(probes.begin(), probes.end(), [](const diskprobe& a, const diskprobe& b) {
+        return a.device.index < b.device.index;
+    });
+    
+    return probes;
+}
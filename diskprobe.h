@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+struct diskdescriptor {
+    std::string serial;
+    std::string model;
+    std::string vendor;
+    std::string revision;
+    uint32_t bustype = 0;
+    bool removable = false;
+};
+
+struct diskdevice {
+    std::wstring path;
+    std::wstring label;
+    int index = 0;
+};
+
+struct diskprobe {
+    diskdevice device;
+    diskdescriptor descriptor;
+};
+
+bool decodestoragedescriptor(const uint8_t* buffer, size_t length, diskdescriptor& descriptor);
+std::string bustypename(uint32_t bustype);
+
+std::vector<diskdevice> enumeratedisks();
+bool probedisk(diskprobe& probe);
+std::vector<diskprobe> probedisks();
@@ -0,0 +1,194 @@
+#include "edid.h"
+#include <cstring>
+
+static const uint8_t edidheader[8] = {0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+
+static bool blockchecksum(const uint8_t* block) {
+    uint8_t sum = 0;
+    for (int i = 0; i < 128; i++) {
+        sum += block[i];
+    }
+    return sum == 0;
+}
+
+static std::string descriptortext(const uint8_t* text, size_t size) {
+    size_t end = 0;
+    while (end < size && text[end] != 0x0A && text[end] != 0x00) end++;
+    
+    size_t start = 0;
+    while (start < end && text[start] == ' ') start++;
+    while (end > start && text[end - 1] == ' ') end--;
+    
+    std::string result;
+    result.reserve(end - start);
+    for (size_t i = start; i < end; i++) {
+        if (text[i] >= 32 && text[i] <= 126) result += (char)text[i];
+    }
+    return result;
+}
+
+static void decodedescriptor(const uint8_t* d, edidinfo& info) {
+    uint16_t pixelclock = (uint16_t)(d[0] | (d[1] << 8));
+    
+    if (pixelclock != 0) {
+        if (info.preferred.pixelclockkhz == 0) {
+            info.preferred.pixelclockkhz = (uint32_t)pixelclock * 10;
+            info.preferred.width = (uint16_t)(d[2] | ((d[4] & 0xF0) << 4));
+            info.preferred.height = (uint16_t)(d[5] | ((d[7] & 0xF0) << 4));
+        }
+        return;
+    }
+    
+    uint8_t tag = d[3];
+    info.descriptortags.set(tag);
+    
+    switch (tag) {
+        case 0xFF:
+            if (info.serial.empty()) info.serial = descriptortext(d + 5, 13);
+            break;
+        case 0xFE: {
+            std::string text = descriptortext(d + 5, 13);
+            if (!text.empty()) info.text.push_back(text);
+            break;
+        }
+        case 0xFC:
+            info.name += descriptortext(d + 5, 13);
+            break;
+        case 0xFD:
+            info.minvrate = d[5];
+            info.maxvrate = d[6];
+            info.minhrate = d[7];
+            info.maxhrate = d[8];
+            info.maxpixelclockmhz = (uint16_t)(d[9] * 10);
+            break;
+        default:
+            break;
+    }
+}
+
+static void decodecta(const uint8_t* block, edidinfo& info) {
+    info.ctablocks++;
+    
+    uint8_t dtdoffset = block[2];
+    if (dtdoffset == 0 || dtdoffset > 127) return;
+    
+    if (block[1] >= 3) {
+        size_t cursor = 4;
+        while (cursor < dtdoffset) {
+            uint8_t tag = block[cursor] >> 5;
+            uint8_t size = block[cursor] & 0x1F;
+            if (cursor + 1 + size > dtdoffset) break;
+            
+            const uint8_t* payload = block + cursor + 1;
+            if (tag == 3 && size >= 5) {
+                uint32_t oui = (uint32_t)payload[0] | ((uint32_t)payload[1] << 8) | ((uint32_t)payload[2] << 16);
+                if (oui == 0x000C03) {
+                    info.hdmi = true;
+                    info.hdmiphysicaladdress = (uint16_t)((payload[3] << 8) | payload[4]);
+                }
+            }
+            
+            cursor += 1 + size;
+        }
+    }
+    
+    for (size_t offset = dtdoffset; offset + 18 <= 127; offset += 18) {
+        const uint8_t* d = block + offset;
+        if (d[0] == 0 && d[1] == 0 && d[2] == 0 && d[3] == 0) break;
+        decodedescriptor(d, info);
+    }
+}
+
+static void decodedisplayid(const uint8_t* block, edidinfo& info) {
+    info.displayidblocks++;
+    
+    const uint8_t* section = block + 1;
+    size_t sectionbytes = section[1];
+    if (5 + sectionbytes > 127) sectionbytes = 127 - 5;
+    
+    size_t cursor = 4;
+    size_t end = 4 + sectionbytes;
+    
+    while (cursor + 3 <= end) {
+        uint8_t tag = section[cursor];
+        uint8_t size = section[cursor + 2];
+        if (cursor + 3 + size > end) break;
+        
+        const uint8_t* payload = section + cursor + 3;
+        if ((tag == 0x00 || tag == 0x20) && size >= 12) {
+            info.displayidserial = (uint32_t)payload[5] | ((uint32_t)payload[6] << 8) | ((uint32_t)payload[7] << 16) | ((uint32_t)payload[8] << 24);
+            
+            uint8_t namesize = payload[11];
+            if (12 + (size_t)namesize <= size) {
+                info.displayidname = descriptortext(payload + 12, namesize);
+            }
+        }
+        
+        if (tag == 0 && size == 0) break;
+        cursor += 3 + size;
+    }
+}
+
+bool decodeedid(const uint8_t* data, size_t length, edidinfo& info) {
+    info = edidinfo();
+    if (!data || length < 128 || memcmp(data, edidheader, sizeof(edidheader)) != 0) return false;
+    
+    bool checksums = blockchecksum(data);
+    
+    uint16_t vendor = (uint16_t)((data[8] << 8) | data[9]);
+    char letters[3] = {
+        (char)('A' + ((vendor >> 10) & 0x1F) - 1),
+        (char)('A' + ((vendor >> 5) & 0x1F) - 1),
+        (char)('A' + (vendor & 0x1F) - 1)
+    };
+    info.manufacturer.assign(letters, 3);
+    
+    info.productcode = (uint16_t)(data[10] | (data[11] << 8));
+    info.binaryserial = (uint32_t)data[12] | ((uint32_t)data[13] << 8) | ((uint32_t)data[14] << 16) | ((uint32_t)data[15] << 24);
+    info.modelyear = data[16] == 0xFF;
+    info.week = info.modelyear ? 0 : data[16];
+    info.year = (uint16_t)(1990 + data[17]);
+    info.version = data[18];
+    info.revision = data[19];
+    
+    for (size_t offset = 54; offset <= 108; offset += 18) {
+        decodedescriptor(data + offset, info);
+    }
+    
+    info.extensions = data[126];
+    if (((size_t)info.extensions + 1) * 128 > length) checksums = false;
+    
+    for (size_t i = 1; i <= info.extensions && (i + 1) * 128 <= length; i++) {
+        const uint8_t* block = data + i * 128;
+        checksums = checksums && blockchecksum(block);
+        
+        switch (block[0]) {
+            case 0x02:
+                decodecta(block, info);
+                break;
+            case 0x70:
+                decodedisplayid(block, info);
+                break;
+            default:
+                break;
+        }
+    }
+    
+    info.checksumvalid = checksums;
+    return true;
+}
+
+std::string edidserial(const edidinfo& info) {
+    if (!info.serial.empty()) return info.serial;
+    if (info.displayidserial != 0) return std::to_string(info.displayidserial);
+    if (info.binaryserial != 0 && info.binaryserial != 0x01010101 && info.binaryserial != 0xFFFFFFFF) {
+        return std::to_string(info.binaryserial);
+    }
+    return "";
+}
+
+std::string edidname(const edidinfo& info) {
+    if (!info.name.empty()) return info.name;
+    if (!info.displayidname.empty()) return info.displayidname;
+    return "";
+}
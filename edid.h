@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <bitset>
+#include <string>
+#include <vector>
+
+struct edidtiming {
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint32_t pixelclockkhz = 0;
+};
+
+struct edidinfo {
+    bool checksumvalid = false;
+    uint8_t version = 0;
+    uint8_t revision = 0;
+    
+    std::string manufacturer;
+    uint16_t productcode = 0;
+    uint32_t binaryserial = 0;
+    uint8_t week = 0;
+    uint16_t year = 0;
+    bool modelyear = false;
+    
+    std::string name;
+    std::string serial;
+    std::vector<std::string> text;
+    std::bitset<256> descriptortags;
+    
+    edidtiming preferred;
+    uint8_t minvrate = 0;
+    uint8_t maxvrate = 0;
+    uint8_t minhrate = 0;
+    uint8_t maxhrate = 0;
+    uint16_t maxpixelclockmhz = 0;
+    
+    uint8_t extensions = 0;
+    uint8_t ctablocks = 0;
+    uint8_t displayidblocks = 0;
+    bool hdmi = false;
+    uint16_t hdmiphysicaladdress = 0;
+    
+    std::string displayidname;
+    uint32_t displayidserial = 0;
+};
+
+bool decodeedid(const uint8_t* data, size_t length, edidinfo& info);
+
+std::string edidserial(const edidinfo& info);
+std::string edidname(const edidinfo& info);
@@ -0,0 +1,167 @@
+#include "fingerprint.h"
+#include "serialclass.h"
+#include "textutil.h"
+#include <algorithm>
+
+static const char* componentnames[fingerprintcomponents] = {"bios", "disk", "monitor", "nic", "usb"};
+
+static const uint64_t fnvoffset = 0xCBF29CE484222325ull;
+static const uint64_t fnvprime = 0x100000001B3ull;
+
+const char* fingerprintcomponentname(size_t component) {
+    return component < fingerprintcomponents ? componentnames[component] : "";
+}
+
+int fingerprintcomponent(std::string_view key) {
+    for (size_t i = 0; i < fingerprintcomponents; i++) {
+        if (key == componentnames[i]) return (int)i;
+    }
+    return -1;
+}
+
+// fnv alone leaves the high bits of short inputs poorly mixed, which sorting and combining would inherit
+static uint64_t finish(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDull;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+static uint64_t addword(uint64_t hash, uint64_t word) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        hash = (hash ^ ((word >> shift) & 0xFF)) * fnvprime;
+    }
+    return hash;
+}
+
+static bool startswith(std::string_view text, std::string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+// which identifier a record holds within its component, or 0 for a record that is not one; the tag is hashed
+// with the value, so the same string moving from one field to another still counts as a change
+static uint8_t identitytag(size_t component, std::string_view category, std::string_view name, std::string_view notes) {
+    switch (component) {
+        case 0:
+            if (category == "systemproduct" && name == "uuid") return 1;
+            if (category == "systemproduct" && name == "serialnumber") return 2;
+            if (category == "baseboard" && name == "serialnumber") return 3;
+            if (category == "chassis" && name == "serialnumber") return 4;
+            return 0;
+        case 1:
+            return startswith(name, "serial_") ? 5 : 0;
+        case 2:
+            return category == "monitor" && name != "info" && name != "error" ? 6 : 0;
+        case 3:
+            // a registry override and the kernel address it replaces hash alike, so they collapse into one
+            return startswith(name, "kernelmac_") || startswith(name, "registrymac_") ? 7 : 0;
+        case 4:
+            return category == "usb" && notes.find("storage") != std::string_view::npos ? 8 : 0;
+    }
+    return 0;
+}
+
+static void addidentifier(std::vector<uint64_t>& hashes, uint8_t tag, std::string_view value) {
+    if (classifyserial(value) != serialclass::real) return;
+    
+    uint64_t hash = (fnvoffset ^ tag) * fnvprime;
+    for (char c : value) {
+        if (c == ' ' || c == '\t' || c == ':' || c == '-' || c == '.') continue;
+        hash = (hash ^ (uint8_t)asciiupper(c)) * fnvprime;
+    }
+    hashes.push_back(finish(hash));
+}
+
+static void digest(fingerprint& print, size_t component, std::vector<uint64_t>& hashes) {
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+    
+    uint64_t hash = addword(fnvoffset, component);
+    for (uint64_t value : hashes) hash = addword(hash, value);
+    
+    print.components[component] = hashes.empty() ? 0 : finish(hash);
+    print.identifiers[component] = (uint32_t)hashes.size();
+    hashes.clear();
+}
+
+static void combine(fingerprint& print) {
+    uint64_t hash = fnvoffset;
+    for (uint64_t component : print.components) hash = addword(hash, component);
+    print.composite = finish(hash);
+}
+
+bool fingerprinter::update(fingerprint& print, std::string_view key, const recordstore& items) {
+    int component = fingerprintcomponent(key);
+    if (component < 0) return false;
+    
+    std::vector<uint64_t>& pending = hashes[component];
+    for (const auto& record : items.records()) {
+        uint8_t tag = identitytag((size_t)component, record.category, record.name, record.notes);
+        if (tag) addidentifier(pending, tag, record.value);
+    }
+    
+    uint64_t before = print.components[component];
+    digest(print, (size_t)component, pending);
+    combine(print);
+    return print.components[component] != before;
+}
+
+void fingerprinter::compute(fingerprint& print, const recordstore& records) {
+    // a snapshot keeps each section together, so the lookup only runs when the section changes
+    std::string_view section;
+    int component = -1;
+    for (const auto& record : records.records()) {
+        if (record.section != section) {
+            section = record.section;
+            component = fingerprintcomponent(section);
+        }
+        if (component < 0) continue;
+        
+        uint8_t tag = identitytag((size_t)component, record.category, record.name, record.notes);
+        if (tag) addidentifier(hashes[component], tag, record.value);
+    }
+    
+    for (size_t i = 0; i < fingerprintcomponents; i++) digest(print, i, hashes[i]);
+    combine(print);
+}
+
+std::string fingerprinttext(uint64_t digest) {
+    uint8_t bytes[8];
+    for (int i = 0; i < 8; i++) bytes[i] = (uint8_t)(digest >> (56 - i * 8));
+    char text[17];
+    hexencode(bytes, sizeof(bytes), text, sizeof(text), false);
+    return text;
+}
+
+std::vector<size_t> changedcomponents(const fingerprint& before, const fingerprint& after) {
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < fingerprintcomponents; i++) {
+        if (before.components[i] != after.components[i]) changed.push_back(i);
+    }
+    return changed;
+}
+
+void writefingerprint(resultwriter& writer, const fingerprint& print, const fingerprint* baseline) {
+    std::string notes;
+    if (baseline) {
+        std::vector<size_t> changed = changedcomponents(*baseline, print);
+        for (size_t component : changed) {
+            notes += notes.empty() ? "changed: " : ", ";
+            notes += fingerprintcomponentname(component);
+        }
+        if (changed.empty()) notes = "unchanged";
+    }
+    
+    std::string composite = fingerprinttext(print.composite);
+    writer.writerecord({"fingerprint", "fingerprint", "composite", composite, notes});
+    
+    for (size_t i = 0; i < fingerprintcomponents; i++) {
+        std::string digest = fingerprinttext(print.components[i]);
+        std::string componentnotes = std::to_string(print.identifiers[i]) + " identifiers";
+        if (baseline && baseline->components[i] != print.components[i]) componentnotes += "; changed";
+        
+        writer.writerecord({"fingerprint", "fingerprint", fingerprintcomponentname(i), digest, componentnotes});
+    }
+}
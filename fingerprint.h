@@ -0,0 +1,41 @@
+#pragma once
+
+#include "output.h"
+#include "recordstore.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// one digest per category that carries identifiers, in this order, and a composite over all of them
+constexpr size_t fingerprintcomponents = 5;
+
+const char* fingerprintcomponentname(size_t component);
+int fingerprintcomponent(std::string_view key);
+
+struct fingerprint {
+    uint64_t composite = 0;
+    uint64_t components[fingerprintcomponents] = {};
+    uint32_t identifiers[fingerprintcomponents] = {};
+};
+
+// identifiers are trimmed, stripped of separators and upper cased, anything the serial classifier does not
+// take for real is left out, and each component is order independent, so re-enumeration alone changes nothing
+class fingerprinter {
+public:
+    // recomputes the component a collector's category feeds and the composite; false when nothing changed
+    bool update(fingerprint& print, std::string_view key, const recordstore& items);
+    
+    // every component at once, straight from a stored snapshot's records
+    void compute(fingerprint& print, const recordstore& records);
+
+private:
+    std::vector<uint64_t> hashes[fingerprintcomponents];
+};
+
+std::string fingerprinttext(uint64_t digest);
+std::vector<size_t> changedcomponents(const fingerprint& before, const fingerprint& after);
+
+// the composite and one record per component under the fingerprint section, noting changes against a baseline if given
+void writefingerprint(resultwriter& writer, const fingerprint& print, const fingerprint* baseline);
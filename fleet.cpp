@@ -0,0 +1,504 @@
+#include "fleet.h"
+#include "hardwareinfo.h"
+#include "hive.h"
+#include "recordstore.h"
+#include "snapshot.h"
+#include "smbios.h"
+#include "diskprobe.h"
+#include "serialclass.h"
+#include "serialindex.h"
+#include "threadpool.h"
+#include "textutil.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+enum class fleetinputkind {
+    unknown,
+    smbios,
+    edid,
+    storage,
+    arp,
+    snapshot,
+    hive
+};
+
+struct fleethost {
+    std::string name;
+    std::vector<std::filesystem::path> files;
+};
+
+struct fleetkey {
+    uint8_t kind;
+    uint32_t host;
+    std::string_view value;
+};
+
+struct fleetworker {
+    hardwareinfo parser;
+    recordstore values;
+    std::vector<std::vector<fleetkey>> partitions;
+    std::string scratch;
+    serialindexwriter* index = nullptr;
+    size_t slot = 0;
+    bool indexfailed = false;
+    size_t files = 0;
+    size_t skipped = 0;
+    size_t records = 0;
+};
+
+static const char* fleetkindnames[] = {
+    "system serial", "system uuid", "baseboard serial", "chassis serial", "disk serial", "monitor serial", "network address",
+    "hardware address"
+};
+
+// the collision report keeps to the addresses a host was configured with; the index takes the burned in ones too
+static const int hardwareaddresskind = 7;
+
+class ratelimiter {
+public:
+    explicit ratelimiter(double persecond) : interval(persecond > 0 ? 1.0 / persecond : 0) {}
+    
+    void acquire() {
+        if (interval <= 0) return;
+        
+        std::chrono::steady_clock::time_point slot;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            auto now = std::chrono::steady_clock::now();
+            if (next < now) next = now;
+            slot = next;
+            next += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval));
+        }
+        std::this_thread::sleep_until(slot);
+    }
+
+private:
+    double interval;
+    std::mutex lock;
+    std::chrono::steady_clock::time_point next;
+};
+
+static std::string lowercase(std::string text) {
+    asciilower(text);
+    return text;
+}
+
+static fleetinputkind classifyinput(const std::filesystem::path& path) {
+    std::string name = lowercase(path.filename().string());
+    std::string extension = lowercase(path.extension().string());
+    
+    if (extension == ".snap") return fleetinputkind::snapshot;
+    if (name == "system" || extension == ".hiv" || extension == ".hive") return fleetinputkind::hive;
+    if (name.find("entry_point") != std::string::npos) return fleetinputkind::unknown;
+    if (name == "dmi" || extension == ".dmi" || name.find("smbios") != std::string::npos) return fleetinputkind::smbios;
+    if (name.find("edid") != std::string::npos) return fleetinputkind::edid;
+    if (name.find("storage") != std::string::npos || extension == ".desc") return fleetinputkind::storage;
+    if (name.find("arp") != std::string::npos) return fleetinputkind::arp;
+    return fleetinputkind::unknown;
+}
+
+static std::vector<fleethost> discoverhosts(const std::string& root) {
+    std::vector<fleethost> hosts;
+    std::error_code ec;
+    
+    for (const auto& entry : std::filesystem::directory_iterator(root, ec)) {
+        if (entry.is_directory()) {
+            fleethost host;
+            host.name = entry.path().filename().string();
+            
+            for (const auto& file : std::filesystem::recursive_directory_iterator(entry.path(), ec)) {
+                if (file.is_regular_file()) host.files.push_back(file.path());
+            }
+            
+            std::sort(host.files.begin(), host.files.end());
+            hosts.push_back(std::move(host));
+        } else if (entry.is_regular_file() && classifyinput(entry.path()) == fleetinputkind::snapshot) {
+            hosts.push_back({entry.path().stem().string(), {entry.path()}});
+        }
+    }
+    
+    std::sort(hosts.begin(), hosts.end(), [](const fleethost& a, const fleethost& b) { return a.name < b.name; });
+    return hosts;
+}
+
+static std::vector<uint8_t> readinput(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+static int collisionkind(std::string_view category, std::string_view name) {
+    if (category == "systemproduct" && name == "serialnumber") return 0;
+    if (category == "systemproduct" && name == "uuid") return 1;
+    if (category == "baseboard" && name == "serialnumber") return 2;
+    if (category == "chassis" && name == "serialnumber") return 3;
+    if (category == "disk" && name.substr(0, 7) == "serial_") return 4;
+    if (category == "monitor" && name != "info" && name != "error") return 5;
+    if (category == "nic" && name.substr(0, 12) == "registrymac_") return 6;
+    if (category == "nic" && name.substr(0, 10) == "kernelmac_") return hardwareaddresskind;
+    return -1;
+}
+
+static void observe(fleetworker& worker, uint32_t host, uint32_t source, std::string_view category, std::string_view name, std::string_view value) {
+    worker.records++;
+    
+    int kind = collisionkind(category, name);
+    if (kind < 0) return;
+    
+    if (worker.index) {
+        if (!worker.index->add(worker.slot, (uint8_t)kind, host, source, value)) worker.indexfailed = true;
+        return;
+    }
+    if (kind == hardwareaddresskind) return;
+    
+    std::string_view trimmed = trimascii(value);
+    if (trimmed.empty()) return;
+    
+    worker.scratch.assign(trimmed);
+    asciiupper(worker.scratch);
+    if (classifyserial(worker.scratch) != serialclass::real) return;
+    
+    std::string_view stored = worker.values.intern(worker.scratch);
+    size_t partition = std::hash<std::string_view>()(stored) % worker.partitions.size();
+    worker.partitions[partition].push_back({(uint8_t)kind, host, stored});
+}
+
+static void observeitems(fleetworker& worker, uint32_t host, uint32_t source, const recordstore& items) {
+    for (const auto& record : items.records()) {
+        observe(worker, host, source, record.category, record.name, record.value);
+    }
+}
+
+// sources number every input file of every host in turn, starting at firstsource for this one; edids and storage
+// descriptors are parsed together and credited to the first file of their kind
+static void scanhost(fleetworker& worker, fleethost& host, uint32_t hostindex, uint32_t firstsource) {
+    std::vector<std::vector<BYTE>> edids;
+    std::vector<diskprobe> disks;
+    uint32_t edidsource = 0;
+    uint32_t disksource = 0;
+    
+    for (size_t fileindex = 0; fileindex < host.files.size(); fileindex++) {
+        const auto& path = host.files[fileindex];
+        uint32_t source = firstsource + (uint32_t)fileindex;
+        fleetinputkind kind = classifyinput(path);
+        if (kind == fleetinputkind::unknown) {
+            worker.skipped++;
+            continue;
+        }
+        
+        worker.files++;
+        
+        // neighbor entries are other machines' addresses and every host behind one gateway shares its mac,
+        // so an arp dump is recognized but carries nothing that identifies or collides for this host
+        if (kind == fleetinputkind::arp) continue;
+        
+        if (kind == fleetinputkind::snapshot) {
+            snapshot snap;
+            if (!snap.load(path.string())) {
+                worker.skipped++;
+                continue;
+            }
+            
+            if (!snap.host.empty() && snap.host != host.name) host.name = snap.host + " (" + host.name + ")";
+            for (const auto& record : snap.records().records()) {
+                observe(worker, hostindex, source, record.category, record.name, record.value);
+            }
+            continue;
+        }
+        
+        if (kind == fleetinputkind::hive) {
+            auto hive = std::make_unique<hiveregistry>();
+            if (!hive->open(path.u8string())) {
+                worker.skipped++;
+                continue;
+            }
+            
+            hardwareinfo offline(nullptr, std::move(hive));
+            observeitems(worker, hostindex, source, offline.getregistrybiosinfo());
+            observeitems(worker, hostindex, source, offline.getregistrynetworkadapterinfo());
+            observeitems(worker, hostindex, source, offline.getregistrymonitorinfo());
+            continue;
+        }
+        
+        std::vector<uint8_t> data = readinput(path);
+        
+        switch (kind) {
+            case fleetinputkind::smbios: {
+                size_t offset = 0;
+                size_t length = 0;
+                if (!locatesmbiostable(data.data(), data.size(), offset, length)) {
+                    worker.skipped++;
+                    break;
+                }
+                observeitems(worker, hostindex, source, worker.parser.getbiosinfo(std::vector<BYTE>(data.begin() + offset, data.begin() + offset + length)));
+                break;
+            }
+            case fleetinputkind::edid:
+                if (edids.empty()) edidsource = source;
+                edids.push_back(std::move(data));
+                break;
+            case fleetinputkind::storage: {
+                diskprobe probe;
+                std::wstring filename = path.filename().wstring();
+                probe.device = {path.wstring(), L"descriptor " + filename, (int)disks.size()};
+                if (decodestoragedescriptor(data.data(), data.size(), probe.descriptor)) {
+                    if (disks.empty()) disksource = source;
+                    disks.push_back(std::move(probe));
+                } else {
+                    worker.skipped++;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    
+    if (!edids.empty()) observeitems(worker, hostindex, edidsource, worker.parser.getmonitorinfo(edids));
+    if (!disks.empty()) observeitems(worker, hostindex, disksource, worker.parser.getdiskinfo(disks));
+}
+
+fleetreport scanfleet(const std::string& root, const fleetoptions& options) {
+    fleetreport report;
+    
+    std::vector<fleethost> hosts = discoverhosts(root);
+    report.hosts = hosts.size();
+    if (hosts.empty()) return report;
+    
+    threadpool pool(options.threads);
+    size_t workercount = std::min(pool.size(), hosts.size());
+    size_t partitioncount = pool.size() * 4;
+    
+    std::unique_ptr<fleetworker[]> workers(new fleetworker[workercount]);
+    for (size_t i = 0; i < workercount; i++) {
+        workers[i].partitions.resize(partitioncount);
+    }
+    
+    ratelimiter limiter(options.hostspersecond);
+    
+    pool.parallelfor(hosts.size(), [&](size_t worker, size_t index) {
+        limiter.acquire();
+        scanhost(workers[worker], hosts[index], (uint32_t)index, 0);
+    });
+    
+    for (size_t i = 0; i < workercount; i++) {
+        report.files += workers[i].files;
+        report.skipped += workers[i].skipped;
+        report.records += workers[i].records;
+    }
+    
+    std::vector<std::vector<fleetcollision>> found(partitioncount);
+    
+    pool.parallelfor(partitioncount, [&](size_t, size_t partition) {
+        std::vector<fleetkey> keys;
+        for (size_t i = 0; i < workercount; i++) {
+            const auto& source = workers[i].partitions[partition];
+            keys.insert(keys.end(), source.begin(), source.end());
+        }
+        
+        std::sort(keys.begin(), keys.end(), [](const fleetkey& a, const fleetkey& b) {
+            if (a.kind != b.kind) return a.kind < b.kind;
+            if (a.value != b.value) return a.value < b.value;
+            return a.host < b.host;
+        });
+        
+        for (size_t start = 0; start < keys.size();) {
+            size_t end = start + 1;
+            size_t distinct = 1;
+            while (end < keys.size() && keys[end].kind == keys[start].kind && keys[end].value == keys[start].value) {
+                if (keys[end].host != keys[end - 1].host) distinct++;
+                end++;
+            }
+            
+            if (distinct > 1) {
+                fleetcollision collision;
+                collision.kind = fleetkindnames[keys[start].kind];
+                collision.value = std::string(keys[start].value);
+                for (size_t i = start; i < end; i++) {
+                    if (i == start || keys[i].host != keys[i - 1].host) collision.hosts.push_back(hosts[keys[i].host].name);
+                }
+                found[partition].push_back(std::move(collision));
+            }
+            
+            start = end;
+        }
+    });
+    
+    for (auto& partition : found) {
+        std::move(partition.begin(), partition.end(), std::back_inserter(report.collisions));
+    }
+    
+    std::sort(report.collisions.begin(), report.collisions.end(), [](const fleetcollision& a, const fleetcollision& b) {
+        if (a.kind != b.kind) return a.kind < b.kind;
+        return a.value < b.value;
+    });
+    
+    return report;
+}
+
+fleetindexreport buildfleetindex(const std::string& root, const std::string& path, const fleetoptions& options) {
+    fleetindexreport report;
+    
+    std::vector<fleethost> hosts = discoverhosts(root);
+    report.hosts = hosts.size();
+    
+    std::vector<uint32_t> firstsource(hosts.size());
+    std::vector<std::string> sources;
+    for (size_t i = 0; i < hosts.size(); i++) {
+        firstsource[i] = (uint32_t)sources.size();
+        for (const auto& file : hosts[i].files) sources.push_back(file.lexically_relative(root).generic_string());
+    }
+    
+    threadpool pool(options.threads);
+    size_t workercount = std::max<size_t>(1, std::min(pool.size(), hosts.size()));
+    serialindexwriter index(path, options.memory, workercount);
+    
+    std::unique_ptr<fleetworker[]> workers(new fleetworker[workercount]);
+    for (size_t i = 0; i < workercount; i++) {
+        workers[i].index = &index;
+        workers[i].slot = i;
+    }
+    
+    ratelimiter limiter(options.hostspersecond);
+    
+    pool.parallelfor(hosts.size(), [&](size_t worker, size_t index) {
+        limiter.acquire();
+        scanhost(workers[worker], hosts[index], (uint32_t)index, firstsource[index]);
+    });
+    
+    bool failed = false;
+    for (size_t i = 0; i < workercount; i++) {
+        report.files += workers[i].files;
+        report.skipped += workers[i].skipped;
+        report.records += workers[i].records;
+        failed = failed || workers[i].indexfailed;
+    }
+    
+    std::vector<std::string> names;
+    for (const auto& host : hosts) names.push_back(host.name);
+    report.written = !failed && index.finish(names, sources, report.index);
+    return report;
+}
+
+static void writejsoncollision(std::ostream& out, const fleetcollision& collision) {
+    out << "{\"kind\":";
+    writejsonstring(out, collision.kind);
+    out << ",\"value\":";
+    writejsonstring(out, collision.value);
+    out << ",\"hosts\":[";
+    for (size_t i = 0; i < collision.hosts.size(); i++) {
+        if (i > 0) out << ',';
+        writejsonstring(out, collision.hosts[i]);
+    }
+    out << "]}";
+}
+
+void writefleetreport(std::ostream& out, outputformat format, const fleetreport& report) {
+    switch (format) {
+        case outputformat::json:
+            out << "{\"hosts\":" << report.hosts << ",\"files\":" << report.files << ",\"skipped\":" << report.skipped
+                << ",\"records\":" << report.records << ",\"collisions\":[";
+            for (size_t i = 0; i < report.collisions.size(); i++) {
+                out << (i == 0 ? "\n  " : ",\n  ");
+                writejsoncollision(out, report.collisions[i]);
+            }
+            out << (report.collisions.empty() ? "]}\n" : "\n]}\n");
+            break;
+        case outputformat::ndjson:
+            for (const auto& collision : report.collisions) {
+                writejsoncollision(out, collision);
+                out << '\n';
+            }
+            break;
+        case outputformat::csv:
+            out << "kind,value,hostcount,hosts\r\n";
+            for (const auto& collision : report.collisions) {
+                std::string hosts;
+                for (const auto& host : collision.hosts) {
+                    if (!hosts.empty()) hosts += ';';
+                    hosts += host;
+                }
+                
+                writecsvfield(out, collision.kind);
+                out << ',';
+                writecsvfield(out, collision.value);
+                out << ',' << collision.hosts.size() << ',';
+                writecsvfield(out, hosts);
+                out << "\r\n";
+            }
+            break;
+    }
+    out.flush();
+}
+
+void writefleetindexreport(std::ostream& out, outputformat format, const fleetindexreport& report) {
+    switch (format) {
+        case outputformat::json:
+        case outputformat::ndjson:
+            out << "{\"hosts\":" << report.hosts << ",\"files\":" << report.files << ",\"skipped\":" << report.skipped
+                << ",\"records\":" << report.records << ",\"identifiers\":" << report.index.identifiers
+                << ",\"postings\":" << report.index.postings << ",\"runs\":" << report.index.runs << ",\"bytes\":" << report.index.bytes << "}\n";
+            break;
+        case outputformat::csv:
+            out << "hosts,files,skipped,records,identifiers,postings,runs,bytes\r\n";
+            out << report.hosts << ',' << report.files << ',' << report.skipped << ',' << report.records << ','
+                << report.index.identifiers << ',' << report.index.postings << ',' << report.index.runs << ',' << report.index.bytes << "\r\n";
+            break;
+    }
+    out.flush();
+}
+
+static const char* fleetkindname(uint8_t kind) {
+    return kind < std::size(fleetkindnames) ? fleetkindnames[kind] : "unknown";
+}
+
+static void writejsonmatch(std::ostream& out, const serialindex& index, const serialindexmatch& match) {
+    out << "{\"value\":";
+    writejsonstring(out, match.value);
+    out << ",\"kind\":";
+    writejsonstring(out, fleetkindname(match.kind));
+    out << ",\"host\":";
+    writejsonstring(out, index.hostname(match.host));
+    out << ",\"source\":";
+    writejsonstring(out, index.sourcename(match.source));
+    out << '}';
+}
+
+void writefleetmatches(std::ostream& out, outputformat format, const serialindex& index, const std::vector<serialindexmatch>& matches) {
+    switch (format) {
+        case outputformat::json:
+            out << "{\"identifiers\":" << index.identifiers() << ",\"hosts\":" << index.hosts() << ",\"matches\":[";
+            for (size_t i = 0; i < matches.size(); i++) {
+                out << (i == 0 ? "\n  " : ",\n  ");
+                writejsonmatch(out, index, matches[i]);
+            }
+            out << (matches.empty() ? "]}\n" : "\n]}\n");
+            break;
+        case outputformat::ndjson:
+            for (const auto& match : matches) {
+                writejsonmatch(out, index, match);
+                out << '\n';
+            }
+            break;
+        case outputformat::csv:
+            out << "value,kind,host,source\r\n";
+            for (const auto& match : matches) {
+                writecsvfield(out, match.value);
+                out << ',';
+                writecsvfield(out, fleetkindname(match.kind));
+                out << ',';
+                writecsvfield(out, index.hostname(match.host));
+                out << ',';
+                writecsvfield(out, index.sourcename(match.source));
+                out << "\r\n";
+            }
+            break;
+    }
+    out.flush();
+}
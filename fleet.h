@@ -0,0 +1,46 @@
+#pragma once
+
+#include "output.h"
+#include "serialindex.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct fleetoptions {
+    size_t threads = 0;
+    double hostspersecond = 0;
+    size_t memory = (size_t)256 << 20;
+};
+
+struct fleetcollision {
+    std::string kind;
+    std::string value;
+    std::vector<std::string> hosts;
+};
+
+struct fleetreport {
+    size_t hosts = 0;
+    size_t files = 0;
+    size_t skipped = 0;
+    size_t records = 0;
+    std::vector<fleetcollision> collisions;
+};
+
+struct fleetindexreport {
+    size_t hosts = 0;
+    size_t files = 0;
+    size_t skipped = 0;
+    size_t records = 0;
+    serialindexstats index;
+    bool written = false;
+};
+
+fleetreport scanfleet(const std::string& root, const fleetoptions& options);
+void writefleetreport(std::ostream& out, outputformat format, const fleetreport& report);
+
+// the same inputs as scanfleet, every identifier of every host written to a serialindex at path
+fleetindexreport buildfleetindex(const std::string& root, const std::string& path, const fleetoptions& options);
+void writefleetindexreport(std::ostream& out, outputformat format, const fleetindexreport& report);
+void writefleetmatches(std::ostream& out, outputformat format, const serialindex& index, const std::vector<serialindexmatch>& matches);
@@ -1,998 +1,791 @@
-#include "hardwareinfo.h"
-#include <setupapi.h>
-#include <iphlpapi.h>
-#include <sstream>
-#include <iomanip>
-#include <algorithm>
-
-#pragma comment(lib, "setupapi.lib")
-#pragma comment(lib, "iphlpapi.lib")
-
-std::vector<BYTE> hardwareinfo::getsmbiosdata() {
-    std::vector<BYTE> result;
-    
-    DWORD totalsize = GetSystemFirmwareTable('RSMB', 0, nullptr, 0);
-    if (totalsize < 8) return result;
-    
-    std::vector<BYTE> buffer(totalsize);
-    DWORD written = GetSystemFirmwareTable('RSMB', 0, buffer.data(), totalsize);
-    if (written < 8) return result;
-    
-    int tablelength = *reinterpret_cast<int*>(&buffer[4]);
-    if (tablelength <= 0) return result;
-    
-    int available = (int)written - 8;
-    int copylen = std::min(tablelength, available);
-    if (copylen <= 0) return result;
-    
-    result.resize(copylen);
-    memcpy(result.data(), &buffer[8], copylen);
-    return result;
-}
-
-std::vector<hardwareinfo::smbiosstructure> hardwareinfo::parsesmbiosstructures(const std::vector<BYTE>& data) {
-    std::vector<smbiosstructure> structures;
-    
-    size_t offset = 0;
-    size_t end = data.size();
-    
-    while (offset + 4 < end) {
-        BYTE type = data[offset];
-        BYTE length = data[offset + 1];
-        
-        if (type == 127) break;
-        if (length < 4 || offset + length > end) break;
-        
-        smbiosstructure structure;
-        structure.type = type;
-        structure.length = length;
-        
-        structure.data.resize(length);
-        memcpy(structure.data.data(), &data[offset], length);
-        
-        size_t stringoffset = offset + length;
-        while (stringoffset < end - 1) {
-            if (data[stringoffset] == 0 && data[stringoffset + 1] == 0) {
-                stringoffset += 2;
-                break;
-            }
-            
-            std::string str;
-            while (stringoffset < end && data[stringoffset] != 0) {
-                str += static_cast<char>(data[stringoffset]);
-                stringoffset++;
-            }
-            
-            if (!str.empty()) {
-                structure.strings.push_back(str);
-            }
-            stringoffset++;
-            
-            if (stringoffset >= end) break;
-        }
-        
-        structures.push_back(structure);
-        offset = stringoffset;
-        
-        if (offset >= end) break;
-    }
-    
-    return structures;
-}
-
-std::string hardwareinfo::getsmbiosstring(const smbiosstructure& structure, BYTE index) {
-    if (index == 0 || index > structure.strings.size()) return "";
-    return structure.strings[index - 1];
-}
-
-std::string hardwareinfo::getsmbiosstringat(const smbiosstructure& structure, int dataindex) {
-    int actualoffset = 4 + dataindex;
-    if (structure.data.size() <= static_cast<size_t>(actualoffset)) return "n/a";
-    return getsmbiosstring(structure, structure.data[actualoffset]);
-}
-
-std::string hardwareinfo::formatuuid(const BYTE* uuid) {
-    std::ostringstream oss;
-    oss << std::hex << std::uppercase << std::setfill('0');
-    oss << std::setw(2) << (int)uuid[0] << std::setw(2) << (int)uuid[1]
-        << std::setw(2) << (int)uuid[2] << std::setw(2) << (int)uuid[3] << "-"
-        << std::setw(2) << (int)uuid[4] << std::setw(2) << (int)uuid[5] << "-"
-        << std::setw(2) << (int)uuid[6] << std::setw(2) << (int)uuid[7] << "-"
-        << std::setw(2) << (int)uuid[8] << std::setw(2) << (int)uuid[9] << "-"
-        << std::setw(2) << (int)uuid[10] << std::setw(2) << (int)uuid[11]
-        << std::setw(2) << (int)uuid[12] << std::setw(2) << (int)uuid[13]
-        << std::setw(2) << (int)uuid[14] << std::setw(2) << (int)uuid[15];
-    return oss.str();
-}
-
-std::vector<hardwareitem> hardwareinfo::getbiosinfo() {
-    std::vector<hardwareitem> items;
-    
-    auto smbiosdata = getsmbiosdata();
-    if (smbiosdata.empty()) {
-        items.push_back({L"bios", L"error", L"failed to retrieve smbios data", L"may require administrator privileges"});
-        return items;
-    }
-    
-    auto structures = parsesmbiosstructures(smbiosdata);
-    
-    for (const auto& s : structures) {
-        if (s.type == 0) {
-            std::string vendor = getsmbiosstringat(s, 0);
-            std::string version = getsmbiosstringat(s, 1);
-            std::string releasedate = getsmbiosstringat(s, 2);
-            
-            items.push_back({L"bios", L"vendor", std::wstring(vendor.begin(), vendor.end()), L""});
-            items.push_back({L"bios", L"version", std::wstring(version.begin(), version.end()), L""});
-            items.push_back({L"bios", L"releasedate", std::wstring(releasedate.begin(), releasedate.end()), L""});
-        }
-    }
-    
-    for (const auto& s : structures) {
-        if (s.type == 1) {
-            std::string manufacturer = getsmbiosstringat(s, 0);
-            std::string productname = getsmbiosstringat(s, 1);
-            std::string version = getsmbiosstringat(s, 2);
-            std::string serialnumber = getsmbiosstringat(s, 3);
-            
-            items.push_back({L"systemproduct", L"manufacturer", std::wstring(manufacturer.begin(), manufacturer.end()), L""});
-            items.push_back({L"systemproduct", L"productname", std::wstring(productname.begin(), productname.end()), L""});
-            items.push_back({L"systemproduct", L"version", std::wstring(version.begin(), version.end()), L""});
-            items.push_back({L"systemproduct", L"version", std::wstring(version.begin(), version.end()), L""});
-            
-            std::string serialcheck = serialnumber;
-            std::transform(serialcheck.begin(), serialcheck.end(), serialcheck.begin(), ::tolower);
-            
-            bool validserial = true;
-            if (serialnumber.empty() || serialcheck == "n/a" || serialcheck == "none" || 
-                serialcheck.find("o.e.m.") != std::string::npos || serialcheck.find("default") != std::string::npos) {
-                validserial = false;
-            }
-            
-            if (!validserial) {
-                 std::wstring wmiserial = getwmiproperty(L"Win32_ComputerSystemProduct", L"IdentifyingNumber");
-                 if (!wmiserial.empty()) {
-                     items.push_back({L"systemproduct", L"serialnumber", wmiserial, L""});
-                 } else {
-                     items.push_back({L"systemproduct", L"serialnumber", std::wstring(serialnumber.begin(), serialnumber.end()), L""});
-                 }
-            } else {
-                items.push_back({L"systemproduct", L"serialnumber", std::wstring(serialnumber.begin(), serialnumber.end()), L""});
-            }
-            
-            if (s.data.size() >= 24) {
-                std::string uuid = formatuuid(&s.data[8]);
-                items.push_back({L"systemproduct", L"uuid", std::wstring(uuid.begin(), uuid.end()), L""});
-            }
-        }
-    }
-    
-    for (const auto& s : structures) {
-        if (s.type == 2) {
-            std::string manufacturer = getsmbiosstringat(s, 0);
-            std::string product = getsmbiosstringat(s, 1);
-            std::string version = getsmbiosstringat(s, 2);
-            std::string serialnumber = getsmbiosstringat(s, 3);
-            
-            items.push_back({L"baseboard", L"manufacturer", std::wstring(manufacturer.begin(), manufacturer.end()), L""});
-            items.push_back({L"baseboard", L"product", std::wstring(product.begin(), product.end()), L""});
-            items.push_back({L"baseboard", L"version", std::wstring(version.begin(), version.end()), L""});
-            
-            std::string serialcheck = serialnumber;
-            std::transform(serialcheck.begin(), serialcheck.end(), serialcheck.begin(), ::tolower);
-            
-            bool validserial = true;
-            if (serialnumber.empty() || serialcheck == "n/a" || serialcheck == "none" || 
-                serialcheck.find("o.e.m.") != std::string::npos || serialcheck.find("default") != std::string::npos) {
-                validserial = false;
-            }
-            
-            if (!validserial) {
-                const std::wstring bbkey = L"HARDWARE\\DESCRIPTION\\System\\BIOS";
-                std::wstring regserial = readregistrystringraw(HKEY_LOCAL_MACHINE, bbkey, L"BaseBoardSerialNumber");
-                if (regserial == L"n/a" || regserial.empty()) {
-                    regserial = readregistrystringraw(HKEY_LOCAL_MACHINE, bbkey, L"BaseBoardSerial");
-                }
-                
-                if (regserial != L"n/a" && !regserial.empty()) {
-                    items.push_back({L"baseboard", L"serialnumber", regserial, L""});
-                } else {
-                     std::wstring wmiserial = getwmiproperty(L"Win32_BaseBoard", L"SerialNumber");
-                     if (!wmiserial.empty()) {
-                         items.push_back({L"baseboard", L"serialnumber", wmiserial, L""});
-                     } else {
-                         items.push_back({L"baseboard", L"serialnumber", std::wstring(serialnumber.begin(), serialnumber.end()), L""});
-                     }
-                }
-            } else {
-                items.push_back({L"baseboard", L"serialnumber", std::wstring(serialnumber.begin(), serialnumber.end()), L""});
-            }
-        }
-    }
-    
-    for (const auto& s : structures) {
-        if (s.type == 3) {
-            std::string manufacturer = getsmbiosstringat(s, 0);
-            std::string version = getsmbiosstringat(s, 2);
-            std::string serialnumber = getsmbiosstringat(s, 3);
-            std::string assettag = getsmbiosstringat(s, 4);
-            
-            items.push_back({L"chassis", L"manufacturer", std::wstring(manufacturer.begin(), manufacturer.end()), L""});
-            items.push_back({L"chassis", L"version", std::wstring(version.begin(), version.end()), L""});
-            items.push_back({L"chassis", L"serialnumber", std::wstring(serialnumber.begin(), serialnumber.end()), L""});
-            items.push_back({L"chassis", L"assettag", std::wstring(assettag.begin(), assettag.end()), L""});
-            
-            if (s.data.size() > 1) {
-                items.push_back({L"chassis", L"type", std::to_wstring(s.data[1]), L""});
-            }
-        }
-    }
-    
-    bool hasbaseboard = false;
-    bool hassystemproduct = false;
-    for (const auto& item : items) {
-        if (item.category == L"baseboard") hasbaseboard = true;
-        if (item.category == L"systemproduct") hassystemproduct = true;
-    }
-    
-    if (!hasbaseboard) {
-        const std::wstring bbkey = L"HARDWARE\\DESCRIPTION\\System\\BIOS";
-        std::wstring manufacturer = readregistrystringraw(HKEY_LOCAL_MACHINE, bbkey, L"BaseBoardManufacturer");
-        std::wstring product = readregistrystringraw(HKEY_LOCAL_MACHINE, bbkey, L"BaseBoardProduct");
-        std::wstring version = readregistrystringraw(HKEY_LOCAL_MACHINE, bbkey, L"BaseBoardVersion");
-        std::wstring serial = readregistrystringraw(HKEY_LOCAL_MACHINE, bbkey, L"BaseBoardSerialNumber");
-        
-        if (serial == L"n/a" || serial.empty()) {
-            serial = readregistrystringraw(HKEY_LOCAL_MACHINE, bbkey, L"BaseBoardSerial");
-        }
-        
-        if (serial == L"n/a" || serial.empty()) {
-             serial = getwmiproperty(L"Win32_BaseBoard", L"SerialNumber");
-        }
-        
-        items.push_back({L"baseboard", L"manufacturer", manufacturer, L""});
-        items.push_back({L"baseboard", L"product", product, L""});
-        items.push_back({L"baseboard", L"version", version, L""});
-        items.push_back({L"baseboard", L"serialnumber", serial, L""});
-    }
-    
-    if (!hassystemproduct) {
-        const std::wstring syskey = L"HARDWARE\\DESCRIPTION\\System\\BIOS";
-        std::wstring manufacturer = readregistrystringraw(HKEY_LOCAL_MACHINE, syskey, L"SystemManufacturer");
-        std::wstring productname = readregistrystringraw(HKEY_LOCAL_MACHINE, syskey, L"SystemProductName");
-        std::wstring version = readregistrystringraw(HKEY_LOCAL_MACHINE, syskey, L"SystemVersion");
-        std::wstring serial = readregistrystringraw(HKEY_LOCAL_MACHINE, syskey, L"SystemSerialNumber");
-        
-        if (serial == L"n/a" || serial.empty()) {
-             serial = getwmiproperty(L"Win32_ComputerSystemProduct", L"IdentifyingNumber");
-        }
-        
-        items.push_back({L"systemproduct", L"manufacturer", manufacturer, L""});
-        items.push_back({L"systemproduct", L"productname", productname, L""});
-        items.push_back({L"systemproduct", L"version", version, L""});
-        items.push_back({L"systemproduct", L"serialnumber", serial, L""});
-    }
-    
-    return items;
-}
-
-std::wstring hardwareinfo::readregistrystring(HKEY hkey, const std::wstring& subkey, const std::wstring& valuename) {
-    HKEY key;
-    if (RegOpenKeyExW(hkey, subkey.c_str(), 0, KEY_READ, &key) != ERROR_SUCCESS) {
-        return L"n/a";
-    }
-    
-    DWORD type = 0;
-    DWORD size = 0;
-    RegQueryValueExW(key, valuename.c_str(), nullptr, &type, nullptr, &size);
-    
-    if (size == 0 || (type != REG_SZ && type != REG_EXPAND_SZ)) {
-        RegCloseKey(key);
-        return L"n/a";
-    }
-    
-    std::vector<wchar_t> buffer(size / sizeof(wchar_t) + 1);
-    if (RegQueryValueExW(key, valuename.c_str(), nullptr, &type, reinterpret_cast<LPBYTE>(buffer.data()), &size) != ERROR_SUCCESS) {
-        RegCloseKey(key);
-        return L"n/a";
-    }
-    
-    RegCloseKey(key);
-    
-    std::wstring result(buffer.data());
-    size_t start = result.find_first_not_of(L" \t\r\n");
-    size_t end = result.find_last_not_of(L" \t\r\n");
-    if (start != std::wstring::npos && end != std::wstring::npos) {
-        return result.substr(start, end - start + 1);
-    }
-    return result;
-}
-
-std::wstring hardwareinfo::readregistrystringraw(HKEY hkey, const std::wstring& subkey, const std::wstring& valuename) {
-    HKEY key;
-    if (RegOpenKeyExW(hkey, subkey.c_str(), 0, KEY_READ, &key) != ERROR_SUCCESS) {
-        return L"n/a";
-    }
-    
-    DWORD type = 0;
-    DWORD size = 0;
-    RegQueryValueExW(key, valuename.c_str(), nullptr, &type, nullptr, &size);
-    
-    if (size == 0 || (type != REG_SZ && type != REG_EXPAND_SZ)) {
-        RegCloseKey(key);
-        return L"n/a";
-    }
-    
-    std::vector<wchar_t> buffer(size / sizeof(wchar_t) + 1);
-    if (RegQueryValueExW(key, valuename.c_str(), nullptr, &type, reinterpret_cast<LPBYTE>(buffer.data()), &size) != ERROR_SUCCESS) {
-        RegCloseKey(key);
-        return L"n/a";
-    }
-    
-    RegCloseKey(key);
-    
-    std::wstring result(buffer.data());
-    size_t start = result.find_first_not_of(L" \t\r\n");
-    size_t end = result.find_last_not_of(L" \t\r\n");
-    if (start != std::wstring::npos && end != std::wstring::npos) {
-        return result.substr(start, end - start + 1);
-    }
-    return result;
-}
-
-DWORD hardwareinfo::readregistrydword(HKEY hkey, const std::wstring& subkey, const std::wstring& valuename) {
-    HKEY key;
-    if (RegOpenKeyExW(hkey, subkey.c_str(), 0, KEY_READ, &key) != ERROR_SUCCESS) {
-        return 0;
-    }
-    
-    DWORD type = 0;
-    DWORD size = sizeof(DWORD);
-    DWORD value = 0;
-    if (RegQueryValueExW(key, valuename.c_str(), nullptr, &type, reinterpret_cast<LPBYTE>(&value), &size) != ERROR_SUCCESS || type != REG_DWORD) {
-        RegCloseKey(key);
-        return 0;
-    }
-    
-    RegCloseKey(key);
-    return value;
-}
-
-std::vector<hardwareitem> hardwareinfo::getprocessorinfo() {
-    std::vector<hardwareitem> items;
-    
-    const std::wstring cpukey = L"HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0";
-    
-    items.push_back({L"cpu", L"processor", readregistrystring(HKEY_LOCAL_MACHINE, cpukey, L"ProcessorNameString"), L""});
-    items.push_back({L"cpu", L"vendor", readregistrystring(HKEY_LOCAL_MACHINE, cpukey, L"VendorIdentifier"), L""});
-    items.push_back({L"cpu", L"identifier", readregistrystring(HKEY_LOCAL_MACHINE, cpukey, L"Identifier"), L""});
-    
-    DWORD mhz = readregistrydword(HKEY_LOCAL_MACHINE, cpukey, L"~MHz");
-    if (mhz > 0) {
-        items.push_back({L"cpu", L"mhz", std::to_wstring(mhz), L""});
-    }
-    
-    return items;
-}
-
-#define IOCTL_STORAGE_QUERY_PROPERTY 0x002D1400
-
-typedef enum _STORAGE_PROPERTY_ID {
-    StorageDeviceProperty = 0
-} STORAGE_PROPERTY_ID;
-
-typedef enum _STORAGE_QUERY_TYPE {
-    PropertyStandardQuery = 0
-} STORAGE_QUERY_TYPE;
-
-typedef struct _STORAGE_PROPERTY_QUERY {
-    STORAGE_PROPERTY_ID PropertyId;
-    STORAGE_QUERY_TYPE QueryType;
-    BYTE AdditionalParameters[1];
-} STORAGE_PROPERTY_QUERY;
-
-typedef struct _STORAGE_DEVICE_DESCRIPTOR {
-    DWORD Version;
-    DWORD Size;
-    BYTE DeviceType;
-    BYTE DeviceTypeModifier;
-    BOOLEAN RemovableMedia;
-    BOOLEAN CommandQueueing;
-    DWORD VendorIdOffset;
-    DWORD ProductIdOffset;
-    DWORD ProductRevisionOffset;
-    DWORD SerialNumberOffset;
-    DWORD BusType;
-    DWORD RawPropertiesLength;
-    BYTE RawDeviceProperties[1];
-} STORAGE_DEVICE_DESCRIPTOR;
-
-std::wstring hardwareinfo::getdiskserial(HANDLE handle) {
-    STORAGE_PROPERTY_QUERY query = {};
-    query.PropertyId = StorageDeviceProperty;
-    query.QueryType = PropertyStandardQuery;
-    
-    std::vector<BYTE> buffer(4096);
-    DWORD bytesreturned = 0;
-    
-    if (!DeviceIoControl(handle, IOCTL_STORAGE_QUERY_PROPERTY,
-        &query, sizeof(query), buffer.data(), (DWORD)buffer.size(),
-        &bytesreturned, nullptr) || bytesreturned == 0) {
-        return L"";
-    }
-    
-    auto descriptor = reinterpret_cast<STORAGE_DEVICE_DESCRIPTOR*>(buffer.data());
-    if (descriptor->SerialNumberOffset > 0 && descriptor->SerialNumberOffset < bytesreturned) {
-        const char* serial = reinterpret_cast<const char*>(buffer.data() + descriptor->SerialNumberOffset);
-        std::string s(serial);
-        std::transform(s.begin(), s.end(), s.begin(), ::toupper);
-        size_t start = s.find_first_not_of(" \t");
-        size_t end = s.find_last_not_of(" \t");
-        if (start != std::string::npos && end != std::string::npos) {
-            s = s.substr(start, end - start + 1);
-        }
-        return std::wstring(s.begin(), s.end());
-    }
-    
-    return L"";
-}
-
-std::wstring hardwareinfo::getdiskmodel(HANDLE handle) {
-    STORAGE_PROPERTY_QUERY query = {};
-    query.PropertyId = StorageDeviceProperty;
-    query.QueryType = PropertyStandardQuery;
-    
-    std::vector<BYTE> buffer(4096);
-    DWORD bytesreturned = 0;
-    
-    if (!DeviceIoControl(handle, IOCTL_STORAGE_QUERY_PROPERTY,
-        &query, sizeof(query), buffer.data(), (DWORD)buffer.size(),
-        &bytesreturned, nullptr) || bytesreturned == 0) {
-        return L"";
-    }
-    
-    auto descriptor = reinterpret_cast<STORAGE_DEVICE_DESCRIPTOR*>(buffer.data());
-    if (descriptor->ProductIdOffset > 0 && descriptor->ProductIdOffset < bytesreturned) {
-        const char* model = reinterpret_cast<const char*>(buffer.data() + descriptor->ProductIdOffset);
-        std::string s(model);
-        std::transform(s.begin(), s.end(), s.begin(), ::tolower);
-        size_t start = s.find_first_not_of(" \t");
-        size_t end = s.find_last_not_of(" \t");
-        if (start != std::string::npos && end != std::string::npos) {
-            s = s.substr(start, end - start + 1);
-        }
-        return std::wstring(s.begin(), s.end());
-    }
-    
-    return L"";
-}
-
-std::vector<hardwareitem> hardwareinfo::getdiskinfodirect(const std::wstring& devicepath, int index) {
-    std::vector<hardwareitem> items;
-    
-    HANDLE handle = CreateFileW(devicepath.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE,
-        nullptr, OPEN_EXISTING, 0, nullptr);
-    
-    if (handle == INVALID_HANDLE_VALUE) {
-        return items;
-    }
-    
-    std::wstring serial = getdiskserial(handle);
-    if (!serial.empty()) {
-        items.push_back({L"disk", L"serial_" + std::to_wstring(index), serial, L"physical drive " + std::to_wstring(index)});
-    }
-    
-    std::wstring model = getdiskmodel(handle);
-    if (!model.empty()) {
-        items.push_back({L"disk", L"model_" + std::to_wstring(index), model, L"physical drive " + std::to_wstring(index)});
-    }
-    
-    CloseHandle(handle);
-    return items;
-}
-
-std::vector<hardwareitem> hardwareinfo::getdiskinfo() {
-    std::vector<hardwareitem> items;
-    
-    for (int i = 0; i < 32; i++) {
-        std::wstring devicepath = L"\\\\.\\PhysicalDrive" + std::to_wstring(i);
-        auto diskinfo = getdiskinfodirect(devicepath, i);
-        items.insert(items.end(), diskinfo.begin(), diskinfo.end());
-    }
-    
-    if (items.empty()) {
-        items.push_back({L"disk", L"info", L"no physical drives found", L"may require administrator privileges"});
-    }
-    
-    return items;
-}
-
-std::vector<hardwareitem> hardwareinfo::getvideocontrollerinfo() {
-    std::vector<hardwareitem> items;
-    
-    const std::wstring basekey = L"SYSTEM\\CurrentControlSet\\Control\\Class\\{4d36e968-e325-11ce-bfc1-08002be10318}";
-    
-    HKEY key;
-    if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, basekey.c_str(), 0, KEY_READ, &key) != ERROR_SUCCESS) {
-        items.push_back({L"gpu", L"error", L"could not open registry key", L""});
-        return items;
-    }
-    
-    int index = 0;
-    wchar_t subkeyname[256];
-    DWORD subkeynamesize = 256;
-    
-    for (DWORD i = 0; RegEnumKeyExW(key, i, subkeyname, &subkeynamesize, nullptr, nullptr, nullptr, nullptr) == ERROR_SUCCESS; i++) {
-        subkeynamesize = 256;
-        
-        if (subkeyname[0] != L'0') continue;
-        
-        std::wstring fullpath = basekey + L"\\" + subkeyname;
-        std::wstring driverdesc = readregistrystring(HKEY_LOCAL_MACHINE, fullpath, L"DriverDesc");
-        
-        if (driverdesc == L"n/a" || driverdesc.empty()) continue;
-        
-        items.push_back({L"gpu", L"name_" + std::to_wstring(index), driverdesc, L""});
-        items.push_back({L"gpu", L"driverversion_" + std::to_wstring(index), readregistrystring(HKEY_LOCAL_MACHINE, fullpath, L"DriverVersion"), L""});
-        items.push_back({L"gpu", L"driverdate_" + std::to_wstring(index), readregistrystring(HKEY_LOCAL_MACHINE, fullpath, L"DriverDate"), L""});
-        
-        index++;
-    }
-    
-    RegCloseKey(key);
-    
-    if (items.empty()) {
-        items.push_back({L"gpu", L"info", L"no display adapters found", L""});
-    }
-    
-    return items;
-}
-
-std::vector<hardwareitem> hardwareinfo::getnetworkadapterinfo() {
-    std::vector<hardwareitem> items;
-    
-    const std::wstring nickey = L"SYSTEM\\CurrentControlSet\\Control\\Class\\{4D36E972-E325-11CE-BFC1-08002BE10318}";
-    
-    HKEY key;
-    if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, nickey.c_str(), 0, KEY_READ, &key) == ERROR_SUCCESS) {
-        wchar_t subkeyname[256];
-        DWORD subkeynamesize = 256;
-        int regindex = 0;
-        
-        for (DWORD i = 0; RegEnumKeyExW(key, i, subkeyname, &subkeynamesize, nullptr, nullptr, nullptr, nullptr) == ERROR_SUCCESS; i++) {
-            subkeynamesize = 256;
-            
-            if (subkeyname[0] != L'0') continue;
-            
-            std::wstring fullpath = nickey + L"\\" + subkeyname;
-            std::wstring mac = readregistrystring(HKEY_LOCAL_MACHINE, fullpath, L"NetworkAddress");
-            
-            if (mac == L"n/a" || mac.empty()) continue;
-            
-            std::wstring adaptername = readregistrystring(HKEY_LOCAL_MACHINE, fullpath, L"DriverDesc");
-            
-            if (mac.length() == 12) {
-                std::wstring formattedmac;
-                for (size_t j = 0; j < 12; j += 2) {
-                    if (j > 0) formattedmac += L":";
-                    formattedmac += mac.substr(j, 2);
-                }
-                mac = formattedmac;
-            }
-            std::transform(mac.begin(), mac.end(), mac.begin(), ::tolower);
-            
-            items.push_back({L"nic", L"registrymac_" + std::to_wstring(regindex), mac, L"adapter: " + adaptername});
-            regindex++;
-        }
-        
-        RegCloseKey(key);
-    }
-    
-    ULONG buffersize = 0;
-    GetAdaptersInfo(nullptr, &buffersize);
-    
-    if (buffersize > 0) {
-        std::vector<BYTE> buffer(buffersize);
-        PIP_ADAPTER_INFO adapterinfo = reinterpret_cast<PIP_ADAPTER_INFO>(buffer.data());
-        
-        if (GetAdaptersInfo(adapterinfo, &buffersize) == ERROR_SUCCESS) {
-            int kernelindex = 0;
-            PIP_ADAPTER_INFO current = adapterinfo;
-            
-            while (current) {
-                std::wostringstream macstream;
-                for (UINT j = 0; j < current->AddressLength; j++) {
-                    if (j > 0) macstream << L":";
-                    macstream << std::hex << std::setfill(L'0') << std::setw(2) << (int)current->Address[j];
-                }
-                
-                std::string desc(current->Description);
-                std::transform(desc.begin(), desc.end(), desc.begin(), ::tolower);
-                std::wstring wdesc(desc.begin(), desc.end());
-                
-                items.push_back({L"nic", L"kernelmac_" + std::to_wstring(kernelindex), macstream.str(), L"adapter: " + wdesc});
-                kernelindex++;
-                
-                current = current->Next;
-            }
-        }
-    }
-    
-    return items;
-}
-
-std::wstring hardwareinfo::extractedidstring(const BYTE* edid, int start) {
-    std::wstring result;
-    for (int i = 0; i < 13; i++) {
-        BYTE b = edid[start + i];
-        if (b == 0x0A) break;
-        if (b >= 32 && b <= 126) result += static_cast<wchar_t>(b);
-    }
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-    size_t startpos = result.find_first_not_of(L" \t");
-    size_t endpos = result.find_last_not_of(L" \t");
-    if (startpos != std::wstring::npos && endpos != std::wstring::npos) {
-        return result.substr(startpos, endpos - startpos + 1);
-    }
-    return result;
-}
-
-std::wstring hardwareinfo::getmonitornamefromedid(const BYTE* edid, size_t length) {
-    if (length < 128) return L"";
-    
-    int offsets[] = {54, 72, 90, 108};
-    for (int offset : offsets) {
-        if (edid[offset] == 0x00 && edid[offset + 1] == 0x00 && 
-            edid[offset + 2] == 0x00 && edid[offset + 3] == 0xFC) {
-            return extractedidstring(edid, offset + 5);
-        }
-    }
-    return L"";
-}
-
-std::wstring hardwareinfo::getmonitorserialfromedid(const BYTE* edid, size_t length) {
-    if (length < 128) return L"";
-    
-    int offsets[] = {54, 72, 90, 108};
-    for (int offset : offsets) {
-        if (edid[offset] == 0x00 && edid[offset + 1] == 0x00 && 
-            edid[offset + 2] == 0x00 && edid[offset + 3] == 0xFF) {
-            return extractedidstring(edid, offset + 5);
-        }
-    }
-    return L"";
-}
-
-std::vector<hardwareitem> hardwareinfo::getmonitorinfo() {
-    std::vector<hardwareitem> items;
-    
-    HKEY displaykey;
-    if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, L"SYSTEM\\CurrentControlSet\\Enum\\DISPLAY", 0, KEY_READ, &displaykey) != ERROR_SUCCESS) {
-        items.push_back({L"monitor", L"error", L"could not open display registry", L""});
-        return items;
-    }
-    
-    wchar_t monitorid[256];
-    DWORD monitoridsize = 256;
-    
-    for (DWORD i = 0; RegEnumKeyExW(displaykey, i, monitorid, &monitoridsize, nullptr, nullptr, nullptr, nullptr) == ERROR_SUCCESS; i++) {
-        monitoridsize = 256;
-        
-        HKEY monitorkey;
-        if (RegOpenKeyExW(displaykey, monitorid, 0, KEY_READ, &monitorkey) != ERROR_SUCCESS) continue;
-        
-        wchar_t instanceid[256];
-        DWORD instanceidsize = 256;
-        
-        for (DWORD j = 0; RegEnumKeyExW(monitorkey, j, instanceid, &instanceidsize, nullptr, nullptr, nullptr, nullptr) == ERROR_SUCCESS; j++) {
-            instanceidsize = 256;
-            
-            HKEY instancekey;
-            std::wstring instancepath = std::wstring(monitorid) + L"\\" + instanceid;
-            if (RegOpenKeyExW(monitorkey, instanceid, 0, KEY_READ, &instancekey) != ERROR_SUCCESS) continue;
-            
-            HKEY paramskey;
-            if (RegOpenKeyExW(instancekey, L"Device Parameters", 0, KEY_READ, &paramskey) == ERROR_SUCCESS) {
-                DWORD edidsize = 0;
-                DWORD type = 0;
-                RegQueryValueExW(paramskey, L"EDID", nullptr, &type, nullptr, &edidsize);
-                
-                if (edidsize >= 128 && type == REG_BINARY) {
-                    std::vector<BYTE> edid(edidsize);
-                    if (RegQueryValueExW(paramskey, L"EDID", nullptr, &type, edid.data(), &edidsize) == ERROR_SUCCESS) {
-                        std::wstring name = getmonitornamefromedid(edid.data(), edidsize);
-                        if (name.empty()) name = monitorid;
-                        
-                        std::wstring serial = getmonitorserialfromedid(edid.data(), edidsize);
-                        if (!serial.empty()) {
-                            std::transform(name.begin(), name.end(), name.begin(), ::tolower);
-                            std::transform(serial.begin(), serial.end(), serial.begin(), ::toupper);
-                            std::wstring inst(instanceid);
-                            std::transform(inst.begin(), inst.end(), inst.begin(), ::tolower);
-                            items.push_back({L"monitor", name, serial, L"instance: " + inst});
-                        }
-                    }
-                }
-                
-                RegCloseKey(paramskey);
-            }
-            
-            RegCloseKey(instancekey);
-        }
-        
-        RegCloseKey(monitorkey);
-    }
-    
-    RegCloseKey(displaykey);
-    
-    if (items.empty()) {
-        items.push_back({L"monitor", L"info", L"no monitors found with edid serials", L""});
-    }
-    
-    return items;
-}
-
-std::wstring hardwareinfo::extractserialfrominstance(const std::wstring& instanceid, bool isusbstor) {
-    if (instanceid.empty()) return L"";
-    
-    size_t idx = instanceid.rfind(L'\\');
-    std::wstring tail = (idx != std::wstring::npos) ? instanceid.substr(idx + 1) : instanceid;
-    
-    if (isusbstor) {
-        std::wstring serial = tail;
-        size_t amp = serial.find(L'&');
-        if (amp != std::wstring::npos && amp > 0) {
-            serial = serial.substr(0, amp);
-        }
-        
-        size_t start = serial.find_first_not_of(L" \t");
-        size_t end = serial.find_last_not_of(L" \t");
-        if (start != std::wstring::npos && end != std::wstring::npos) {
-            serial = serial.substr(start, end - start + 1);
-        }
-        
-        if (serial.empty()) return L"";
-        
-        bool allzeros = true;
-        for (wchar_t c : serial) {
-            if (c != L'0') { allzeros = false; break; }
-        }
-        if (allzeros) return L"";
-        
-        return serial;
-    } else {
-        if (tail.find(L'&') != std::wstring::npos) return L"";
-        
-        size_t start = tail.find_first_not_of(L" \t");
-        size_t end = tail.find_last_not_of(L" \t");
-        if (start != std::wstring::npos && end != std::wstring::npos) {
-            return tail.substr(start, end - start + 1);
-        }
-        return tail;
-    }
-}
-
-std::vector<hardwareitem> hardwareinfo::getusbdevices() {
-    std::vector<hardwareitem> items;
-    
-    HDEVINFO deviceinfoset = SetupDiGetClassDevsW(nullptr, nullptr, nullptr, DIGCF_PRESENT | DIGCF_ALLCLASSES);
-    if (deviceinfoset == INVALID_HANDLE_VALUE) {
-        items.push_back({L"usb", L"error", L"setupdigetclassdevs failed", L""});
-        return items;
-    }
-    
-    SP_DEVINFO_DATA deviceinfodata;
-    deviceinfodata.cbSize = sizeof(SP_DEVINFO_DATA);
-    
-    std::map<std::wstring, bool> seen;
-    
-    for (DWORD i = 0; SetupDiEnumDeviceInfo(deviceinfoset, i, &deviceinfodata); i++) {
-        wchar_t enumerator[256] = {};
-        if (!SetupDiGetDeviceRegistryPropertyW(deviceinfoset, &deviceinfodata, SPDRP_ENUMERATOR_NAME,
-            nullptr, reinterpret_cast<PBYTE>(enumerator), sizeof(enumerator), nullptr)) {
-            continue;
-        }
-        
-        std::wstring enumname(enumerator);
-        if (_wcsicmp(enumname.c_str(), L"USB") != 0 && _wcsicmp(enumname.c_str(), L"USBSTOR") != 0) {
-            continue;
-        }
-        
-        wchar_t devicename[256] = {};
-        if (!SetupDiGetDeviceRegistryPropertyW(deviceinfoset, &deviceinfodata, SPDRP_FRIENDLYNAME,
-            nullptr, reinterpret_cast<PBYTE>(devicename), sizeof(devicename), nullptr)) {
-            SetupDiGetDeviceRegistryPropertyW(deviceinfoset, &deviceinfodata, SPDRP_DEVICEDESC,
-                nullptr, reinterpret_cast<PBYTE>(devicename), sizeof(devicename), nullptr);
-        }
-        
-        if (wcslen(devicename) == 0) wcscpy_s(devicename, L"USB Device");
-        std::wstring wdevicename(devicename);
-        std::transform(wdevicename.begin(), wdevicename.end(), wdevicename.begin(), ::tolower);
-        
-        wchar_t instanceidbuf[512] = {};
-        if (!SetupDiGetDeviceInstanceIdW(deviceinfoset, &deviceinfodata, instanceidbuf, 512, nullptr)) {
-            continue;
-        }
-        
-        std::wstring instanceid(instanceidbuf);
-        if (seen.find(instanceid) != seen.end()) continue;
-        seen[instanceid] = true;
-        
-        bool isusbstor = (_wcsicmp(enumname.c_str(), L"USBSTOR") == 0);
-        std::wstring serial = extractserialfrominstance(instanceid, isusbstor);
-        std::transform(serial.begin(), serial.end(), serial.begin(), ::toupper);
-        
-        items.push_back({L"usb", wdevicename, serial.empty() ? L"" : serial, L""});
-    }
-    
-    SetupDiDestroyDeviceInfoList(deviceinfoset);
-    
-    if (items.empty()) {
-        items.push_back({L"usb", L"info", L"no connected usb devices found", L""});
-    }
-    
-    return items;
-}
-
-std::vector<hardwareitem> hardwareinfo::getarptable() {
-    std::vector<hardwareitem> items;
-    
-    std::map<DWORD, std::wstring> indertoname;
-    
-    ULONG buffersize = 0;
-    GetAdaptersInfo(nullptr, &buffersize);
-    
-    if (buffersize > 0) {
-        std::vector<BYTE> buffer(buffersize);
-        PIP_ADAPTER_INFO adapterinfo = reinterpret_cast<PIP_ADAPTER_INFO>(buffer.data());
-        
-        if (GetAdaptersInfo(adapterinfo, &buffersize) == ERROR_SUCCESS) {
-            PIP_ADAPTER_INFO current = adapterinfo;
-            while (current) {
-                std::string desc(current->Description);
-                std::transform(desc.begin(), desc.end(), desc.begin(), ::tolower);
-                indertoname[current->Index] = std::wstring(desc.begin(), desc.end());
-                current = current->Next;
-            }
-        }
-    }
-    
-    ULONG arpsize = 0;
-    GetIpNetTable(nullptr, &arpsize, TRUE);
-    
-    if (arpsize == 0) {
-        items.push_back({L"arp", L"info", L"no entries", L""});
-        return items;
-    }
-    
-    std::vector<BYTE> arpbuffer(arpsize);
-    PMIB_IPNETTABLE arptable = reinterpret_cast<PMIB_IPNETTABLE>(arpbuffer.data());
-    
-    if (GetIpNetTable(arptable, &arpsize, TRUE) != NO_ERROR) {
-        items.push_back({L"arp", L"error", L"getipnettable failed", L""});
-        return items;
-    }
-    
-    for (DWORD i = 0; i < arptable->dwNumEntries; i++) {
-        MIB_IPNETROW& row = arptable->table[i];
-        
-        if (row.dwPhysAddrLen == 0) continue;
-        if (row.dwType == 2) continue;
-        
-        IN_ADDR ipaddr;
-        ipaddr.S_un.S_addr = row.dwAddr;
-        std::wstring ip;
-        ip = std::to_wstring((row.dwAddr) & 0xFF) + L"." +
-             std::to_wstring((row.dwAddr >> 8) & 0xFF) + L"." +
-             std::to_wstring((row.dwAddr >> 16) & 0xFF) + L"." +
-             std::to_wstring((row.dwAddr >> 24) & 0xFF);
-        
-        std::wostringstream macstream;
-        for (DWORD j = 0; j < row.dwPhysAddrLen && j < 6; j++) {
-            if (j > 0) macstream << L":";
-            macstream << std::hex << std::setfill(L'0') << std::setw(2) << (int)row.bPhysAddr[j];
-        }
-        
-        std::wstring typestr;
-        switch (row.dwType) {
-            case 4: typestr = L"static"; break;
-            case 3: typestr = L"dynamic"; break;
-            case 1: typestr = L"other"; break;
-            default: typestr = L"type " + std::to_wstring(row.dwType); break;
-        }
-        
-        std::wstring adaptername = L"ifindex " + std::to_wstring(row.dwIndex);
-        auto it = indertoname.find(row.dwIndex);
-        if (it != indertoname.end()) {
-            adaptername = it->second;
-        }
-        
-        items.push_back({L"arp", ip, macstream.str(), typestr + L"; adapter: " + adaptername});
-    }
-    
-    if (items.empty()) {
-        items.push_back({L"arp", L"info", L"no arp entries found", L""});
-    }
-    
-    return items;
-}
-
-std::wstring hardwareinfo::getwmiproperty(const std::wstring& wmiclass, const std::wstring& property) {
-    std::wstring result = L"";
-    
-    HRESULT hres;
-    hres = CoInitializeEx(0, COINIT_MULTITHREADED);
-    if (FAILED(hres) && hres != RPC_E_CHANGED_MODE) {
-        return L"";
-    }
-    
-    hres = CoInitializeSecurity(NULL, -1, NULL, NULL, RPC_C_AUTHN_LEVEL_DEFAULT, RPC_C_IMP_LEVEL_IMPERSONATE, NULL, EOAC_NONE, NULL);
-    
-    IWbemLocator *ploc = NULL;
-    hres = CoCreateInstance(CLSID_WbemLocator, 0, CLSCTX_INPROC_SERVER, IID_IWbemLocator, (LPVOID *)&ploc);
-    
-    if (FAILED(hres)) {
-        CoUninitialize();
-        return L"";
-    }
-    
-    IWbemServices *psvc = NULL;
-    hres = ploc->ConnectServer(_bstr_t(L"ROOT\\CIMV2"), NULL, NULL, 0, NULL, 0, 0, &psvc);
-    
-    if (FAILED(hres)) {
-        ploc->Release();
-        CoUninitialize();
-        return L"";
-    }
-    
-    hres = CoSetProxyBlanket(psvc, RPC_C_AUTHN_WINNT, RPC_C_AUTHZ_NONE, NULL, RPC_C_AUTHN_LEVEL_CALL, RPC_C_IMP_LEVEL_IMPERSONATE, NULL, EOAC_NONE);
-    
-    if (FAILED(hres)) {
-        psvc->Release();
-        ploc->Release();
-        CoUninitialize();
-        return L"";
-    }
-    
-    IEnumWbemClassObject* penumerator = NULL;
-    std::wstring query = L"SELECT " + property + L" FROM " + wmiclass;
-    hres = psvc->ExecQuery(bstr_t("WQL"), bstr_t(query.c_str()), WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, NULL, &penumerator);
-    
-    if (FAILED(hres)) {
-        psvc->Release();
-        ploc->Release();
-        CoUninitialize();
-        return L"";
-    }
-    
-    IWbemClassObject *pcls = NULL;
-    ULONG ureturn = 0;
-    
-    while (penumerator) {
-        HRESULT hr = penumerator->Next(WBEM_INFINITE, 1, &pcls, &ureturn);
-        if (0 == ureturn) {
-            break;
-        }
-        
-        VARIANT vtprop;
-        hr = pcls->Get(property.c_str(), 0, &vtprop, 0, 0);
-        if (SUCCEEDED(hr)) {
-            if (vtprop.vt == VT_BSTR) {
-                result = std::wstring(vtprop.bstrVal, SysStringLen(vtprop.bstrVal));
-            } else if (vtprop.vt == VT_I4) {
-                 result = std::to_wstring(vtprop.intVal);
-            }
-            VariantClear(&vtprop);
-        }
-        
-        pcls->Release();
-        if (!result.empty()) break;
-    }
-    
-    psvc->Release();
-    ploc->Release();
-    if (penumerator) penumerator->Release();
-    CoUninitialize();
-    
-    return result;
-}
+#include "hardwareinfo.h"
+#include "diskprobe.h"
+#include "edid.h"
+#include "usb.h"
+#include "neighbor.h"
+#include "serialclass.h"
+#include "textutil.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+
+#ifdef _WIN32
+#include <setupapi.h>
+#include <iphlpapi.h>
+
+#pragma comment(lib, "setupapi.lib")
+#pragma comment(lib, "iphlpapi.lib")
+
+std::vector<BYTE> hardwareinfo::getsmbiosdata() {
+    std::vector<BYTE> result;
+    tracespan span("GetSystemFirmwareTable");
+    
+    DWORD totalsize = GetSystemFirmwareTable('RSMB', 0, nullptr, 0);
+    if (!span.check(totalsize >= 8)) return result;
+    
+    std::vector<BYTE> buffer(totalsize);
+    DWORD written = GetSystemFirmwareTable('RSMB', 0, buffer.data(), totalsize);
+    if (!span.check(written >= 8)) return result;
+    span.bytes(written);
+    
+    int tablelength = *reinterpret_cast<int*>(&buffer[4]);
+    if (tablelength <= 0) return result;
+    
+    int available = (int)written - 8;
+    int copylen = std::min(tablelength, available);
+    if (copylen <= 0) return result;
+    
+    result.resize(copylen);
+    memcpy(result.data(), &buffer[8], copylen);
+    return result;
+}
+#endif
+
+std::string hardwareinfo::formatuuid(const BYTE* uuid) {
+    char text[37];
+    formatuuidtext(uuid, text, sizeof(text));
+    return text;
+}
+
+std::wstring hardwareinfo::getwmiproperty(const std::wstring& wmiclass, const std::wstring& property) {
+    return wmi.getproperty(wmiclass, property);
+}
+
+recordstore hardwareinfo::getbiosinfo() {
+    return decodebiosinfo(getsmbiosdata(), true);
+}
+
+recordstore hardwareinfo::getbiosinfo(const std::vector<BYTE>& smbiosdata) {
+    return decodebiosinfo(smbiosdata, false);
+}
+
+static bool realserial(const std::wstring& serial) {
+    return classifyserial(serial) == serialclass::real;
+}
+
+// a fallback source only replaces a serial the classifier rejects, and then only with a real one,
+// unless there was nothing there at all
+template <typename text, typename source>
+static void fallbackserial(text& serial, source&& read) {
+    serialclass current = classifyserial(serial);
+    if (current == serialclass::real) return;
+    
+    std::wstring candidate = read();
+    if (current != serialclass::blank && classifyserial(candidate) != serialclass::real) return;
+    
+    if constexpr (std::is_same_v<text, std::string>) serial = widetoutf8(candidate);
+    else serial = std::move(candidate);
+}
+
+recordstore hardwareinfo::decodebiosinfo(const std::vector<BYTE>& smbiosdata, bool localsources) {
+    recordstore items;
+    
+    if (smbiosdata.empty()) {
+        items.add("bios", "bios", "error", "failed to retrieve smbios data", localsources ? "may require administrator privileges" : "");
+        return items;
+    }
+    
+    smbiostable table(smbiosdata.data(), smbiosdata.size());
+    std::string scratch;
+    
+    auto add = [&](std::string_view category, std::string_view name, std::string_view value) {
+        items.add("bios", category, name, latin1toutf8(value, scratch), "");
+    };
+    
+    auto addserial = [&](std::string_view category, std::string_view serial) {
+        items.add("bios", category, "serialnumber", serial, serialnotes(serial, ""));
+    };
+    
+    for (const auto& s : table.bytype(0)) {
+        add("bios", "vendor", s.stringat(0));
+        add("bios", "version", s.stringat(1));
+        add("bios", "releasedate", s.stringat(2));
+    }
+    
+    for (const auto& s : table.bytype(1)) {
+        std::string_view version = s.stringat(2);
+        
+        add("systemproduct", "manufacturer", s.stringat(0));
+        add("systemproduct", "productname", s.stringat(1));
+        add("systemproduct", "version", version);
+        add("systemproduct", "version", version);
+        
+        std::string serial(latin1toutf8(s.stringat(3), scratch));
+        if (localsources) {
+            fallbackserial(serial, [&] { return getwmiproperty(L"Win32_ComputerSystemProduct", L"IdentifyingNumber"); });
+        }
+        addserial("systemproduct", serial);
+        
+        if (const uint8_t* uuidfield = s.field(8, 16)) {
+            char uuid[37];
+            size_t length = formatuuidtext(uuidfield, uuid, sizeof(uuid));
+            add("systemproduct", "uuid", std::string_view(uuid, length));
+        }
+    }
+    
+    for (const auto& s : table.bytype(2)) {
+        add("baseboard", "manufacturer", s.stringat(0));
+        add("baseboard", "product", s.stringat(1));
+        add("baseboard", "version", s.stringat(2));
+        
+        std::string serial(latin1toutf8(s.stringat(3), scratch));
+        if (localsources) {
+            fallbackserial(serial, [&] { return readbiosfield(L"BaseBoardSerialNumber"); });
+            fallbackserial(serial, [&] { return readbiosfield(L"BaseBoardSerial"); });
+            fallbackserial(serial, [&] { return getwmiproperty(L"Win32_BaseBoard", L"SerialNumber"); });
+        }
+        addserial("baseboard", serial);
+    }
+    
+    for (const auto& s : table.bytype(3)) {
+        add("chassis", "manufacturer", s.stringat(0));
+        add("chassis", "version", s.stringat(2));
+        addserial("chassis", latin1toutf8(s.stringat(3), scratch));
+        add("chassis", "assettag", s.stringat(4));
+        
+        if (const uint8_t* chassistype = s.field(5, 1)) {
+            add("chassis", "type", std::to_string(*chassistype & 0x7F));
+        }
+    }
+    
+    auto missing = [](const std::wstring& value) {
+        return value == L"n/a" || value.empty();
+    };
+    
+    bool hasbaseboard = false;
+    bool hassystemproduct = false;
+    for (const auto& record : items.records()) {
+        if (record.category == "baseboard") hasbaseboard = true;
+        if (record.category == "systemproduct") hassystemproduct = true;
+    }
+    
+    // the fallbacks below read the registry and wmi, whose text is wide
+    auto addwide = [&](std::string_view category, std::string_view name, const std::wstring& value) {
+        scratch.clear();
+        appendutf8(scratch, value);
+        items.add("bios", category, name, scratch, "");
+    };
+    
+    if (!hasbaseboard && localsources) {
+        std::wstring manufacturer = readbiosfield(L"BaseBoardManufacturer");
+        std::wstring product = readbiosfield(L"BaseBoardProduct");
+        std::wstring version = readbiosfield(L"BaseBoardVersion");
+        std::wstring serial = readbiosfield(L"BaseBoardSerialNumber");
+        fallbackserial(serial, [&] { return readbiosfield(L"BaseBoardSerial"); });
+        
+        if (!realserial(serial) || missing(manufacturer) || missing(product) || missing(version)) {
+            wmirow row = wmi.getproperties(L"Win32_BaseBoard", {L"SerialNumber", L"Manufacturer", L"Product", L"Version"});
+            fallbackserial(serial, [&] { return row[L"SerialNumber"]; });
+            if (missing(manufacturer) && !row[L"Manufacturer"].empty()) manufacturer = row[L"Manufacturer"];
+            if (missing(product) && !row[L"Product"].empty()) product = row[L"Product"];
+            if (missing(version) && !row[L"Version"].empty()) version = row[L"Version"];
+        }
+        
+        addwide("baseboard", "manufacturer", manufacturer);
+        addwide("baseboard", "product", product);
+        addwide("baseboard", "version", version);
+        addserial("baseboard", widetoutf8(serial));
+    }
+    
+    if (!hassystemproduct && localsources) {
+        std::wstring manufacturer = readbiosfield(L"SystemManufacturer");
+        std::wstring productname = readbiosfield(L"SystemProductName");
+        std::wstring version = readbiosfield(L"SystemVersion");
+        std::wstring serial = readbiosfield(L"SystemSerialNumber");
+        
+        if (!realserial(serial) || missing(manufacturer) || missing(productname) || missing(version)) {
+            wmirow row = wmi.getproperties(L"Win32_ComputerSystemProduct", {L"IdentifyingNumber", L"Vendor", L"Name", L"Version"});
+            fallbackserial(serial, [&] { return row[L"IdentifyingNumber"]; });
+            if (missing(manufacturer) && !row[L"Vendor"].empty()) manufacturer = row[L"Vendor"];
+            if (missing(productname) && !row[L"Name"].empty()) productname = row[L"Name"];
+            if (missing(version) && !row[L"Version"].empty()) version = row[L"Version"];
+        }
+        
+        addwide("systemproduct", "manufacturer", manufacturer);
+        addwide("systemproduct", "productname", productname);
+        addwide("systemproduct", "version", version);
+        addserial("systemproduct", widetoutf8(serial));
+    }
+    
+    return items;
+}
+
+static const wchar_t* bioskey = L"HARDWARE\\DESCRIPTION\\System\\BIOS";
+static const wchar_t* cpukey = L"HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0";
+static const wchar_t* gpuclasskey = L"SYSTEM\\CurrentControlSet\\Control\\Class\\{4d36e968-e325-11ce-bfc1-08002be10318}";
+static const wchar_t* nicclasskey = L"SYSTEM\\CurrentControlSet\\Control\\Class\\{4D36E972-E325-11CE-BFC1-08002BE10318}";
+static const wchar_t* displayenumkey = L"SYSTEM\\CurrentControlSet\\Enum\\DISPLAY";
+
+void hardwareinfo::endscan() {
+    registry.reset();
+    wmi.reset();
+}
+
+registrystats hardwareinfo::registrycalls() {
+    return registry.stats();
+}
+
+std::wstring hardwareinfo::registrybiosfield(const std::wstring& valuename) {
+    // serial numbers are usually absent from this key and a missing name fails the whole batch, so they are read on their own
+    static const std::vector<std::wstring> fields = {
+        L"BIOSVendor", L"BIOSVersion", L"BIOSReleaseDate",
+        L"BaseBoardManufacturer", L"BaseBoardProduct", L"BaseBoardVersion",
+        L"SystemManufacturer", L"SystemProductName", L"SystemVersion"
+    };
+    
+    registry.getvalues(bioskey, fields);
+    return registry.getstring(bioskey, valuename);
+}
+
+recordstore hardwareinfo::getregistrybiosinfo() {
+    recordstore items;
+    
+    std::wstring serial = registrybiosfield(L"BaseBoardSerialNumber");
+    fallbackserial(serial, [&] { return registrybiosfield(L"BaseBoardSerial"); });
+    std::string baseboardserial = widetoutf8(serial);
+    std::string systemserial = widetoutf8(registrybiosfield(L"SystemSerialNumber"));
+    
+    auto add = [&](std::string_view category, std::string_view name, const wchar_t* valuename) {
+        items.add("bios", category, name, widetoutf8(registrybiosfield(valuename)), "");
+    };
+    
+    add("bios", "vendor", L"BIOSVendor");
+    add("bios", "version", L"BIOSVersion");
+    add("bios", "releasedate", L"BIOSReleaseDate");
+    add("baseboard", "manufacturer", L"BaseBoardManufacturer");
+    add("baseboard", "product", L"BaseBoardProduct");
+    add("baseboard", "version", L"BaseBoardVersion");
+    items.add("bios", "baseboard", "serialnumber", baseboardserial, serialnotes(baseboardserial, ""));
+    add("systemproduct", "manufacturer", L"SystemManufacturer");
+    add("systemproduct", "productname", L"SystemProductName");
+    add("systemproduct", "version", L"SystemVersion");
+    items.add("bios", "systemproduct", "serialnumber", systemserial, serialnotes(systemserial, ""));
+    
+    return items;
+}
+
+recordstore hardwareinfo::getregistryprocessorinfo() {
+    recordstore items;
+    
+    std::vector<registryvalue> values = registry.getvalues(cpukey, {L"ProcessorNameString", L"VendorIdentifier", L"Identifier", L"~MHz"});
+    
+    items.add("cpu", "cpu", "processor", widetoutf8(registrystring(values[0])), "");
+    items.add("cpu", "cpu", "vendor", widetoutf8(registrystring(values[1])), "");
+    items.add("cpu", "cpu", "identifier", widetoutf8(registrystring(values[2])), "");
+    
+    if (values[3].type == registryvaluetype::dword && values[3].number > 0) {
+        items.add("cpu", "cpu", "mhz", std::to_string(values[3].number), "");
+    }
+    
+    return items;
+}
+
+recordstore hardwareinfo::getregistryvideocontrollerinfo() {
+    recordstore items;
+    
+    std::vector<std::wstring> subkeys;
+    if (!registry.subkeys(gpuclasskey, subkeys)) {
+        items.add("gpu", "gpu", "error", "could not open registry key", "");
+        return items;
+    }
+    
+    int index = 0;
+    
+    for (const auto& subkey : subkeys) {
+        if (subkey.empty() || subkey[0] != L'0') continue;
+        
+        std::vector<registryvalue> values = registry.getvalues(std::wstring(gpuclasskey) + L"\\" + subkey, {L"DriverDesc", L"DriverVersion", L"DriverDate"});
+        std::wstring driverdesc = registrystring(values[0]);
+        
+        if (driverdesc == L"n/a" || driverdesc.empty()) continue;
+        
+        std::string suffix = std::to_string(index);
+        items.add("gpu", "gpu", "name_" + suffix, widetoutf8(driverdesc), "");
+        items.add("gpu", "gpu", "driverversion_" + suffix, widetoutf8(registrystring(values[1])), "");
+        items.add("gpu", "gpu", "driverdate_" + suffix, widetoutf8(registrystring(values[2])), "");
+        
+        index++;
+    }
+    
+    if (items.empty()) {
+        items.add("gpu", "gpu", "info", "no display adapters found", "");
+    }
+    
+    return items;
+}
+
+void hardwareinfo::appendregistrymacs(recordstore& items) {
+    std::vector<std::wstring> subkeys;
+    if (!registry.subkeys(nicclasskey, subkeys)) return;
+    
+    int regindex = 0;
+    
+    for (const auto& subkey : subkeys) {
+        if (subkey.empty() || subkey[0] != L'0') continue;
+        
+        std::wstring fullpath = std::wstring(nicclasskey) + L"\\" + subkey;
+        std::wstring mac = registry.getstring(fullpath, L"NetworkAddress");
+        
+        if (mac == L"n/a" || mac.empty()) continue;
+        
+        std::wstring adaptername = registry.getstring(fullpath, L"DriverDesc");
+        
+        if (mac.length() == 12) {
+            wchar_t formatted[18];
+            size_t length = 0;
+            for (size_t j = 0; j < 12; j += 2) {
+                if (j > 0) formatted[length++] = L':';
+                formatted[length++] = mac[j];
+                formatted[length++] = mac[j + 1];
+            }
+            mac.assign(formatted, length);
+        }
+        asciilower(mac);
+        
+        items.add("nic", "nic", "registrymac_" + std::to_string(regindex), widetoutf8(mac), "adapter: " + widetoutf8(adaptername));
+        regindex++;
+    }
+}
+
+recordstore hardwareinfo::getregistrynetworkadapterinfo() {
+    recordstore items;
+    appendregistrymacs(items);
+    
+    if (items.empty()) {
+        items.add("nic", "nic", "info", "no network addresses set in the registry", "");
+    }
+    
+    return items;
+}
+
+recordstore hardwareinfo::getregistrymonitorinfo() {
+    recordstore items;
+    
+    std::vector<std::wstring> monitorids;
+    if (!registry.subkeys(displayenumkey, monitorids)) {
+        items.add("monitor", "monitor", "error", "could not open display registry", "");
+        return items;
+    }
+    
+    for (const auto& monitorid : monitorids) {
+        std::wstring monitorpath = std::wstring(displayenumkey) + L"\\" + monitorid;
+        
+        std::vector<std::wstring> instanceids;
+        if (!registry.subkeys(monitorpath, instanceids)) continue;
+        
+        std::string name = widetoutf8(monitorid);
+        for (const auto& instanceid : instanceids) {
+            std::vector<uint8_t> edid = registry.getbinary(monitorpath + L"\\" + instanceid + L"\\Device Parameters", L"EDID");
+            if (edid.size() < 128) continue;
+            
+            appendmonitoritem(items, edid.data(), edid.size(), name, widetoutf8(instanceid));
+        }
+    }
+    
+    if (items.empty()) {
+        items.add("monitor", "monitor", "info", "no monitors found with edid serials", "");
+    }
+    
+    return items;
+}
+
+#ifdef _WIN32
+std::wstring hardwareinfo::readbiosfield(const std::wstring& valuename) {
+    return registrybiosfield(valuename);
+}
+#endif
+
+static std::string hexnumber(uint64_t value, int digits) {
+    char text[24];
+    snprintf(text, sizeof(text), "0x%0*llx", digits, (unsigned long long)value);
+    return text;
+}
+
+static std::string cachesize(uint64_t size) {
+    if (size >= (1ull << 20) && size % (1ull << 20) == 0) return std::to_string(size >> 20) + " MB";
+    return std::to_string(size >> 10) + " KB";
+}
+
+// mhz is what windows records for the first processor, or 0 when there is no such reading
+static recordstore decodeprocessors(const std::vector<cpuprobe>& probes, uint32_t mhz) {
+    recordstore items;
+    
+    const cpuprobe* first = nullptr;
+    for (const auto& probe : probes) {
+        if (!probe.leaves.empty()) {
+            first = &probe;
+            break;
+        }
+    }
+    
+    std::vector<cputopology> topologies(probes.size());
+    for (size_t i = 0; i < probes.size(); i++) topologies[i] = decodecputopology(probes[i]);
+    
+    // the os numbering is preferred where there is one, since apic ids leave gaps the os does not
+    auto packageof = [&](size_t i) { return probes[i].package >= 0 ? (uint64_t)probes[i].package : (uint64_t)topologies[i].package; };
+    auto coreof = [&](size_t i) {
+        uint64_t core = probes[i].core >= 0 ? (uint64_t)probes[i].core : (uint64_t)topologies[i].core;
+        uint64_t die = probes[i].die >= 0 ? (uint64_t)probes[i].die : 0;
+        return (packageof(i) << 40) | (die << 20) | core;
+    };
+    
+    if (first) {
+        cpuidentity identity = decodecpuidentity(*first);
+        
+        bool mixedsignature = false;
+        bool mixedmicrocode = false;
+        for (const auto& probe : probes) {
+            if (probe.leaves.empty()) continue;
+            const cpuidleaf* features = findcpuidleaf(probe, 1);
+            if (features && features->eax != identity.signature) mixedsignature = true;
+            if (probe.microcode != first->microcode) mixedmicrocode = true;
+        }
+        
+        std::string identifier = "family " + std::to_string(identity.family) + " model " + std::to_string(identity.model) + " stepping " + std::to_string(identity.stepping);
+        std::string signaturenotes = "cpuid " + hexnumber(identity.signature, 8);
+        if (mixedsignature) signaturenotes += "; differs across processors";
+        
+        items.add("cpu", "cpu", "processor", identity.brand, "");
+        items.add("cpu", "cpu", "vendor", identity.vendor, "");
+        items.add("cpu", "cpu", "identifier", identifier, signaturenotes);
+        
+        if (first->microcode != 0) {
+            items.add("cpu", "cpu", "microcode", hexnumber(first->microcode, 0), mixedmicrocode ? "differs across processors" : "");
+        }
+        
+        std::string_view hypervisor = "none";
+        if (!identity.hypervisor.empty()) hypervisor = identity.hypervisor;
+        else if (identity.virtualized) hypervisor = "present";
+        items.add("cpu", "cpu", "hypervisor", hypervisor, "");
+    }
+    
+    std::vector<uint64_t> packages;
+    std::vector<uint64_t> cores;
+    size_t performance = 0;
+    size_t efficient = 0;
+    for (size_t i = 0; i < probes.size(); i++) {
+        packages.push_back(packageof(i));
+        cores.push_back(coreof(i));
+        if (topologies[i].coretype == cpucoretype::performance) performance++;
+        if (topologies[i].coretype == cpucoretype::efficient) efficient++;
+    }
+    std::sort(packages.begin(), packages.end());
+    std::sort(cores.begin(), cores.end());
+    size_t packagecount = (size_t)(std::unique(packages.begin(), packages.end()) - packages.begin());
+    size_t corecount = (size_t)(std::unique(cores.begin(), cores.end()) - cores.begin());
+    
+    if (!probes.empty()) {
+        items.add("cpu", "cpu", "topology", std::to_string(packagecount) + " packages, " + std::to_string(corecount) + " cores, " + std::to_string(probes.size()) + " threads", "");
+    }
+    if (performance > 0 && efficient > 0) {
+        items.add("cpu", "cpu", "core types", std::to_string(performance) + " performance, " + std::to_string(efficient) + " efficient", "logical processors of each kind");
+    }
+    if (mhz > 0) items.add("cpu", "cpu", "mhz", std::to_string(mhz), "");
+    
+    if (first) {
+        // hybrid parts give each core type its own caches, so the leaves are decoded once per type; an instance is
+        // every processor whose apic id agrees above the bits the cache spans, and a cache both types report is one
+        struct cacheinstances {
+            cpucache cache;
+            std::vector<uint32_t> groups;
+            bool coretypes[3] = {};
+        };
+        
+        std::vector<cpucache> decoded[3];
+        bool decodedtype[3] = {};
+        std::vector<cacheinstances> caches;
+        for (size_t i = 0; i < probes.size(); i++) {
+            if (probes[i].leaves.empty()) continue;
+            
+            size_t type = (size_t)topologies[i].coretype;
+            if (!decodedtype[type]) {
+                decoded[type] = decodecpucaches(probes[i]);
+                decodedtype[type] = true;
+            }
+            
+            for (const auto& cache : decoded[type]) {
+                auto entry = std::find_if(caches.begin(), caches.end(), [&](const cacheinstances& known) {
+                    return known.cache.level == cache.level && known.cache.type == cache.type && known.cache.size == cache.size &&
+                        known.cache.ways == cache.ways && known.cache.linesize == cache.linesize && known.cache.sharing == cache.sharing;
+                });
+                if (entry == caches.end()) entry = caches.insert(caches.end(), {cache, {}, {}});
+                entry->groups.push_back(cpucachegroup(cache, topologies[i].apicid));
+                entry->coretypes[type] = true;
+            }
+        }
+        
+        std::stable_sort(caches.begin(), caches.end(), [](const cacheinstances& a, const cacheinstances& b) {
+            return a.cache.level != b.cache.level ? a.cache.level < b.cache.level : a.cache.type < b.cache.type;
+        });
+        
+        for (auto& entry : caches) {
+            const cpucache& cache = entry.cache;
+            std::string name = "l" + std::to_string(cache.level);
+            if (cache.type != 'u') name += cache.type;
+            
+            // two kinds of the same level only happen on hybrid parts, and then the core type tells them apart
+            bool shared = std::count_if(caches.begin(), caches.end(), [&](const cacheinstances& other) {
+                return other.cache.level == cache.level && other.cache.type == cache.type;
+            }) > 1;
+            if (shared && entry.coretypes[(size_t)cpucoretype::performance] != entry.coretypes[(size_t)cpucoretype::efficient]) {
+                name += entry.coretypes[(size_t)cpucoretype::performance] ? " performance" : " efficient";
+            }
+            
+            std::sort(entry.groups.begin(), entry.groups.end());
+            size_t instances = 0;
+            size_t widest = 0;
+            for (size_t i = 0; i < entry.groups.size();) {
+                size_t end = i;
+                while (end < entry.groups.size() && entry.groups[end] == entry.groups[i]) end++;
+                instances++;
+                widest = std::max(widest, end - i);
+                i = end;
+            }
+            
+            std::string value = cachesize(cache.size) + ", " + std::to_string(cache.ways) + "-way, " + std::to_string(cache.linesize) + " byte lines";
+            std::string notes = std::to_string(instances) + (instances == 1 ? " instance, " : " instances, up to ") +
+                std::to_string(widest) + (widest == 1 ? " logical processor" : " logical processors") + (instances == 1 ? "" : " each");
+            items.add("cpu", "cache", name, value, notes);
+        }
+    } else {
+        items.add("cpu", "cpu", "info", "cpuid is not available on this architecture", "");
+    }
+    
+    std::string name;
+    std::string value;
+    std::string notes;
+    for (size_t i = 0; i < probes.size(); i++) {
+        const cputopology& topology = topologies[i];
+        uint64_t core = probes[i].core >= 0 ? (uint64_t)probes[i].core : (uint64_t)topology.core;
+        value = "package " + std::to_string(packageof(i)) + ", core " + std::to_string(core);
+        if (!probes[i].leaves.empty()) value += ", thread " + std::to_string(topology.thread);
+        
+        notes.clear();
+        if (!probes[i].leaves.empty()) notes = "apic " + hexnumber(topology.apicid, 0);
+        if (topology.coretype == cpucoretype::performance) notes += "; performance core";
+        if (topology.coretype == cpucoretype::efficient) notes += "; efficient core";
+        if (!probes[i].pinned) notes += notes.empty() ? "not pinned" : "; not pinned";
+        
+        name = "cpu " + std::to_string(probes[i].index);
+        items.add("cpu", "logical processor", name, value, notes);
+    }
+    
+    return items;
+}
+
+recordstore hardwareinfo::getprocessorinfo(const std::vector<cpuprobe>& probes) {
+    return decodeprocessors(probes, 0);
+}
+
+#ifdef _WIN32
+recordstore hardwareinfo::getprocessorinfo() {
+    std::vector<cpuprobe> probes = probecpus();
+    if (probes.empty() || probes[0].leaves.empty()) return getregistryprocessorinfo();
+    
+    // the revision the loaded microcode reports sits in the high dword; windows only records it for the first processor
+    registryvalue revision = registry.getvalues(cpukey, {L"Update Revision"})[0];
+    if (revision.type == registryvaluetype::binary && revision.data.size() >= 8) {
+        uint32_t microcode = (uint32_t)revision.data[4] | ((uint32_t)revision.data[5] << 8) | ((uint32_t)revision.data[6] << 16) | ((uint32_t)revision.data[7] << 24);
+        for (auto& probe : probes) probe.microcode = microcode;
+    }
+    
+    registryvalue mhz = registry.getvalues(cpukey, {L"~MHz"})[0];
+    return decodeprocessors(probes, mhz.type == registryvaluetype::dword ? mhz.number : 0);
+}
+#endif
+
+recordstore hardwareinfo::getdiskinfo() {
+    return getdiskinfo(probedisks());
+}
+
+recordstore hardwareinfo::getdiskinfo(const std::vector<diskprobe>& probes) {
+    recordstore items;
+    
+    std::string name;
+    std::string value;
+    std::string notes;
+    std::string scratch;
+    for (const auto& probe : probes) {
+        const diskdescriptor& descriptor = probe.descriptor;
+        std::string index = std::to_string(probe.device.index);
+        notes.clear();
+        appendutf8(notes, probe.device.label);
+        
+        auto add = [&](const char* field, std::string_view text, std::string_view textnotes) {
+            name.assign(field).append(index);
+            items.add("disk", "disk", name, text, textnotes);
+        };
+        
+        if (!descriptor.serial.empty()) {
+            value.assign(latin1toutf8(descriptor.serial, scratch));
+            asciiupper(value);
+            add("serial_", value, serialnotes(value, notes));
+        }
+        
+        if (!descriptor.model.empty()) {
+            value.assign(latin1toutf8(descriptor.model, scratch));
+            asciilower(value);
+            add("model_", value, notes);
+        }
+        
+        if (!descriptor.vendor.empty()) add("vendor_", latin1toutf8(descriptor.vendor, scratch), notes);
+        if (!descriptor.revision.empty()) add("revision_", latin1toutf8(descriptor.revision, scratch), notes);
+        add("bus_", bustypename(descriptor.bustype), notes);
+    }
+    
+    if (items.empty()) {
+        items.add("disk", "disk", "info", "no physical drives found", "may require administrator privileges");
+    }
+    
+    return items;
+}
+
+#ifdef _WIN32
+recordstore hardwareinfo::getvideocontrollerinfo() {
+    return getregistryvideocontrollerinfo();
+}
+
+recordstore hardwareinfo::getnetworkadapterinfo() {
+    recordstore items;
+    
+    appendregistrymacs(items);
+    
+    tracespan span("GetAdaptersInfo");
+    ULONG buffersize = 0;
+    GetAdaptersInfo(nullptr, &buffersize);
+    
+    if (buffersize > 0) {
+        std::vector<BYTE> buffer(buffersize);
+        PIP_ADAPTER_INFO adapterinfo = reinterpret_cast<PIP_ADAPTER_INFO>(buffer.data());
+        
+        if (span.check(GetAdaptersInfo(adapterinfo, &buffersize) == ERROR_SUCCESS)) {
+            span.bytes(buffersize);
+            int kernelindex = 0;
+            PIP_ADAPTER_INFO current = adapterinfo;
+            std::string notes;
+            std::string scratch;
+            
+            while (current) {
+                char mac[MAX_ADAPTER_ADDRESS_LENGTH * 3 + 1];
+                formatmactext(current->Address, std::min<size_t>(current->AddressLength, MAX_ADAPTER_ADDRESS_LENGTH), mac, std::size(mac));
+                
+                notes.assign("adapter: ").append(latin1toutf8(current->Description, scratch));
+                asciilower(notes);
+                
+                items.add("nic", "nic", "kernelmac_" + std::to_string(kernelindex), mac, notes);
+                kernelindex++;
+                
+                current = current->Next;
+            }
+        }
+    }
+    
+    return items;
+}
+
+#endif
+
+void hardwareinfo::appendmonitoritem(recordstore& items, const BYTE* edid, size_t length,
+    std::string_view fallbackname, std::string_view instance) {
+    edidinfo info;
+    if (!decodeedid(edid, length, info)) return;
+    
+    std::string serialtext = edidserial(info);
+    if (serialtext.empty()) return;
+    
+    std::string scratch;
+    std::string serial(latin1toutf8(serialtext, scratch));
+    std::string name(latin1toutf8(edidname(info), scratch));
+    if (name.empty()) name = fallbackname;
+    
+    std::string notes = "instance: ";
+    notes += instance;
+    asciilower(name);
+    asciiupper(serial);
+    asciilower(notes);
+    notes = serialnotes(serial, std::move(notes));
+    
+    // a block that fails its checksum was truncated or corrupted on the way, so its serial may be too
+    if (!info.checksumvalid) notes += "; edid checksum invalid";
+    items.add("monitor", "monitor", name, serial, notes);
+}
+
+recordstore hardwareinfo::getmonitorinfo(const std::vector<std::vector<BYTE>>& edids) {
+    recordstore items;
+    
+    for (size_t i = 0; i < edids.size(); i++) {
+        if (edids[i].size() < 128) continue;
+        std::string index = std::to_string(i);
+        appendmonitoritem(items, edids[i].data(), edids[i].size(), "monitor " + index, "edid " + index);
+    }
+    
+    if (items.empty()) {
+        items.add("monitor", "monitor", "info", "no monitors found with edid serials", "");
+    }
+    
+    return items;
+}
+
+#ifdef _WIN32
+recordstore hardwareinfo::getmonitorinfo() {
+    return getregistrymonitorinfo();
+}
+#endif
+
+recordstore hardwareinfo::getusbdevices() {
+    std::vector<usbdevice> devices;
+    if (!enumerateusbdevices(devices)) {
+        recordstore items;
+        items.add("usb", "usb", "error", "setupdigetclassdevs failed", "");
+        return items;
+    }
+    return getusbdevices(devices);
+}
+
+recordstore hardwareinfo::getusbdevices(const std::vector<usbdevice>& devices) {
+    recordstore items;
+    items.reserve(devices.size());
+    
+    std::string name;
+    std::string serial;
+    std::string notes;
+    for (const auto& device : devices) {
+        name.clear();
+        appendutf8(name, device.name);
+        if (name.empty()) name = "usb device";
+        asciilower(name);
+        
+        serial.clear();
+        appendutf8(serial, device.serial);
+        asciiupper(serial);
+        
+        notes.clear();
+        appendutf8(notes, usbidstring(device));
+        if (device.storage) notes += notes.empty() ? "storage" : "; storage";
+        notes = serialnotes(serial, std::move(notes));
+        
+        items.add("usb", "usb", name, serial, notes);
+    }
+    
+    if (items.empty()) {
+        items.add("usb", "usb", "info", "no connected usb devices found", "");
+    }
+    
+    return items;
+}
+
+// entries stay fixed size in table and are formatted with neighborrecord only where something reads them, so a scan
+// never turns a gateway's whole neighbor table into text
+recordstore hardwareinfo::getarptable(neighbortable& table) {
+    recordstore items;
+    table.clear();
+    if (!readneighbortable(table)) {
+        items.add("arp", "arp", "error", "neighbor table query failed", "");
+    } else if (table.empty()) {
+        items.add("arp", "arp", "info", "no arp entries found", "");
+    }
+    return items;
+}
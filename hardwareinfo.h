@@ -1,60 +1,74 @@
-#pragma once
-
-#include <windows.h>
-#include <string>
-#include <vector>
-#include <map>
-#include <wbemidl.h>
-#include <comdef.h>
-
-#pragma comment(lib, "wbemuuid.lib")
-
-struct hardwareitem {
-    std::wstring category;
-    std::wstring name;
-    std::wstring value;
-    std::wstring notes;
-};
-
-class hardwareinfo {
-public:
-    std::vector<hardwareitem> getbiosinfo();
-    std::vector<hardwareitem> getprocessorinfo();
-    std::vector<hardwareitem> getdiskinfo();
-    std::vector<hardwareitem> getvideocontrollerinfo();
-    std::vector<hardwareitem> getnetworkadapterinfo();
-    std::vector<hardwareitem> getmonitorinfo();
-    std::vector<hardwareitem> getusbdevices();
-    std::vector<hardwareitem> getarptable();
-
-private:
-    std::vector<BYTE> getsmbiosdata();
-    
-    struct smbiosstructure {
-        BYTE type;
-        BYTE length;
-        std::vector<BYTE> data;
-        std::vector<std::string> strings;
-    };
-    
-    std::vector<smbiosstructure> parsesmbiosstructures(const std::vector<BYTE>& data);
-    std::string getsmbiosstring(const smbiosstructure& structure, BYTE index);
-    std::string getsmbiosstringat(const smbiosstructure& structure, int dataindex);
-    std::string formatuuid(const BYTE* uuid);
-    
-    std::vector<hardwareitem> getdiskinfodirect(const std::wstring& devicepath, int index);
-    std::wstring getdiskserial(HANDLE handle);
-    std::wstring getdiskmodel(HANDLE handle);
-    
-    std::wstring getmonitornamefromedid(const BYTE* edid, size_t length);
-    std::wstring getmonitorserialfromedid(const BYTE* edid, size_t length);
-    std::wstring extractedidstring(const BYTE* edid, int start);
-    
-    std::wstring extractserialfrominstance(const std::wstring& instanceid, bool isusbstor);
-    
-    std::wstring readregistrystring(HKEY hkey, const std::wstring& subkey, const std::wstring& valuename);
-    std::wstring readregistrystringraw(HKEY hkey, const std::wstring& subkey, const std::wstring& valuename);
-    DWORD readregistrydword(HKEY hkey, const std::wstring& subkey, const std::wstring& valuename);
-    
-    std::wstring getwmiproperty(const std::wstring& wmiclass, const std::wstring& property);
-};
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "smbios.h"
+#include "diskprobe.h"
+#include "wmisession.h"
+#include "registry.h"
+#include "usb.h"
+#include "neighbor.h"
+#include "cpuprobe.h"
+#include "recordstore.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdint>
+
+typedef uint8_t BYTE;
+typedef uint32_t DWORD;
+#endif
+
+class hardwareinfo {
+public:
+    hardwareinfo() = default;
+    explicit hardwareinfo(std::unique_ptr<wmiprovider> provider) : wmi(std::move(provider)) {}
+    hardwareinfo(std::unique_ptr<wmiprovider> provider, std::unique_ptr<registryprovider> registrysource)
+        : wmi(std::move(provider)), registry(std::move(registrysource)) {}
+    
+    recordstore getbiosinfo();
+    recordstore getprocessorinfo();
+    recordstore getdiskinfo();
+    recordstore getvideocontrollerinfo();
+    recordstore getnetworkadapterinfo();
+    recordstore getmonitorinfo();
+    recordstore getusbdevices();
+    // fills table; the records only carry an info or error line when it ends up empty
+    recordstore getarptable(neighbortable& table);
+    
+    recordstore getbiosinfo(const std::vector<BYTE>& smbiosdata);
+    recordstore getprocessorinfo(const std::vector<cpuprobe>& probes);
+    recordstore getdiskinfo(const std::vector<diskprobe>& probes);
+    recordstore getmonitorinfo(const std::vector<std::vector<BYTE>>& edids);
+    recordstore getusbdevices(const std::vector<usbdevice>& devices);
+    
+    recordstore getregistrybiosinfo();
+    recordstore getregistryprocessorinfo();
+    recordstore getregistryvideocontrollerinfo();
+    recordstore getregistrynetworkadapterinfo();
+    recordstore getregistrymonitorinfo();
+    
+    void endscan();
+    registrystats registrycalls();
+    
+    static std::string formatuuid(const BYTE* uuid);
+
+private:
+    std::vector<BYTE> getsmbiosdata();
+    recordstore decodebiosinfo(const std::vector<BYTE>& smbiosdata, bool localsources);
+    
+    void appendmonitoritem(recordstore& items, const BYTE* edid, size_t length, std::string_view fallbackname, std::string_view instance);
+    
+    std::wstring readbiosfield(const std::wstring& valuename);
+    
+    std::wstring registrybiosfield(const std::wstring& valuename);
+    void appendregistrymacs(recordstore& items);
+    
+    std::wstring getwmiproperty(const std::wstring& wmiclass, const std::wstring& property);
+    
+    wmisession wmi;
+    registrysession registry;
+};
@@ -0,0 +1,95 @@
+#ifndef _WIN32
+#include "hardwareinfo.h"
+#include "sysfs.h"
+#include "textutil.h"
+#include "trace.h"
+
+static const char* dmitablepath = "/sys/firmware/dmi/tables/DMI";
+static const char* dmientrypointpath = "/sys/firmware/dmi/tables/smbios_entry_point";
+static const char* dmiidpath = "/sys/class/dmi/id/";
+static const char* drmpath = "/sys/class/drm/";
+
+std::vector<BYTE> hardwareinfo::getsmbiosdata() {
+    tracespan span("firmware table");
+    std::vector<BYTE> result = readsysfsbinary(dmitablepath);
+    if (!span.check(result.size() >= 4)) return {};
+    span.bytes(result.size());
+    
+    std::vector<BYTE> entrypoint = readsysfsbinary(dmientrypointpath, 64);
+    
+    uint64_t address = 0;
+    uint64_t tablelength = 0;
+    if (parsesmbiosentrypoint(entrypoint.data(), entrypoint.size(), address, tablelength)) {
+        if (tablelength > 0 && tablelength < result.size()) {
+            result.resize((size_t)tablelength);
+        }
+    }
+    
+    return result;
+}
+
+std::wstring hardwareinfo::readbiosfield(const std::wstring& valuename) {
+    if (registry.available()) return registrybiosfield(valuename);
+    
+    static const std::map<std::wstring, const char*> dmiidfiles = {
+        {L"BaseBoardManufacturer", "board_vendor"},
+        {L"BaseBoardProduct", "board_name"},
+        {L"BaseBoardVersion", "board_version"},
+        {L"BaseBoardSerialNumber", "board_serial"},
+        {L"SystemManufacturer", "sys_vendor"},
+        {L"SystemProductName", "product_name"},
+        {L"SystemVersion", "product_version"},
+        {L"SystemSerialNumber", "product_serial"},
+    };
+    
+    auto it = dmiidfiles.find(valuename);
+    if (it == dmiidfiles.end()) return L"n/a";
+    
+    std::string value = readsysfsstring(std::string(dmiidpath) + it->second);
+    if (value.empty()) return L"n/a";
+    
+    // the same smbios strings decodebiosinfo reads, so they are taken as latin-1 the same way
+    std::string scratch;
+    return utf8towide(latin1toutf8(value, scratch));
+}
+
+recordstore hardwareinfo::getprocessorinfo() {
+    if (registry.available()) return getregistryprocessorinfo();
+    return getprocessorinfo(probecpus());
+}
+
+recordstore hardwareinfo::getvideocontrollerinfo() {
+    if (registry.available()) return getregistryvideocontrollerinfo();
+    
+    recordstore items;
+    items.add("gpu", "gpu", "info", "not available on this platform", "");
+    return items;
+}
+
+recordstore hardwareinfo::getnetworkadapterinfo() {
+    if (registry.available()) return getregistrynetworkadapterinfo();
+    
+    recordstore items;
+    items.add("nic", "nic", "info", "not available on this platform", "");
+    return items;
+}
+
+recordstore hardwareinfo::getmonitorinfo() {
+    if (registry.available()) return getregistrymonitorinfo();
+    
+    recordstore items;
+    
+    for (const auto& connector : listsysfsdirectory(drmpath)) {
+        std::vector<BYTE> edid = readsysfsbinary(std::string(drmpath) + connector + "/edid", 32768);
+        if (edid.size() < 128) continue;
+        
+        appendmonitoritem(items, edid.data(), edid.size(), connector, connector);
+    }
+    
+    if (items.empty()) {
+        items.add("monitor", "monitor", "info", "no monitors found with edid serials", "");
+    }
+    
+    return items;
+}
+#endif
@@ -0,0 +1,331 @@
+#include "hive.h"
+#include <algorithm>
+#include <cstring>
+#include <cwchar>
+#include <cwctype>
+
+static const size_t baseblocksize = 4096;
+static const size_t bigdatasegment = 16344;
+
+static uint16_t readle16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t readle32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint32_t foldchar(uint32_t c) {
+    if (c < 128) return (c >= 'a' && c <= 'z') ? c - 32 : c;
+    return (uint32_t)towupper((wint_t)c);
+}
+
+static uint32_t namechar(const uint8_t* name, size_t index, bool compressed) {
+    return compressed ? name[index] : readle16(name + index * 2);
+}
+
+static bool samename(const uint8_t* name, size_t length, bool compressed, std::wstring_view target) {
+    size_t count = compressed ? length : length / 2;
+    if (count != target.size()) return false;
+    
+    for (size_t i = 0; i < count; i++) {
+        uint32_t c = namechar(name, i, compressed);
+        if (c != (uint32_t)target[i] && foldchar(c) != foldchar((uint32_t)target[i])) return false;
+    }
+    return true;
+}
+
+static bool sameletters(std::wstring_view a, std::wstring_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (foldchar((uint32_t)a[i]) != foldchar((uint32_t)b[i])) return false;
+    }
+    return true;
+}
+
+static bool strippath(std::wstring_view& path, std::wstring_view prefix) {
+    if (path.size() < prefix.size() || !sameletters(path.substr(0, prefix.size()), prefix)) return false;
+    if (path.size() > prefix.size() && path[prefix.size()] != L'\\') return false;
+    
+    path.remove_prefix(prefix.size());
+    return true;
+}
+
+static uint32_t namehash(std::wstring_view name) {
+    uint32_t hash = 0;
+    for (wchar_t c : name) hash = hash * 37 + foldchar((uint32_t)c);
+    return hash;
+}
+
+const uint8_t* hiveregistry::cell(uint32_t offset, size_t minimum, size_t& size) const {
+    if ((size_t)offset + 4 > binsize) return nullptr;
+    
+    int32_t raw = (int32_t)readle32(bins + offset);
+    size_t total = raw < 0 ? (size_t)(-(int64_t)raw) : (size_t)raw;
+    if (total < 4 + minimum || (size_t)offset + total > binsize) return nullptr;
+    
+    size = total - 4;
+    return bins + offset + 4;
+}
+
+const uint8_t* hiveregistry::keynode(uint32_t offset) const {
+    size_t size = 0;
+    const uint8_t* node = cell(offset, 0x4C, size);
+    if (!node || node[0] != 'n' || node[1] != 'k') return nullptr;
+    if (0x4C + (size_t)readle16(node + 0x48) > size) return nullptr;
+    return node;
+}
+
+template <typename visitor>
+bool hiveregistry::walksubkeys(uint32_t list, visitor&& visit, int depth) const {
+    size_t size = 0;
+    const uint8_t* entries = cell(list, 4, size);
+    if (!entries || depth > 4) return true;
+    
+    uint16_t count = readle16(entries + 2);
+    
+    if (entries[0] == 'r' && entries[1] == 'i') {
+        for (size_t i = 0; i < count && 4 + (i + 1) * 4 <= size; i++) {
+            if (!walksubkeys(readle32(entries + 4 + i * 4), visit, depth + 1)) return false;
+        }
+        return true;
+    }
+    
+    if (entries[0] != 'l' || (entries[1] != 'f' && entries[1] != 'h' && entries[1] != 'i')) return true;
+    
+    size_t stride = entries[1] == 'i' ? 4 : 8;
+    bool hashed = entries[1] == 'h';
+    
+    for (size_t i = 0; i < count && 4 + (i + 1) * stride <= size; i++) {
+        const uint8_t* entry = entries + 4 + i * stride;
+        if (!visit(readle32(entry), hashed ? readle32(entry + 4) : 0, hashed)) return false;
+    }
+    return true;
+}
+
+uint32_t hiveregistry::findsubkey(uint32_t parent, std::wstring_view name) const {
+    if (parent == root && controlset && sameletters(name, L"CurrentControlSet")) return controlset;
+    
+    const uint8_t* node = keynode(parent);
+    if (!node || readle32(node + 0x14) == 0) return 0;
+    
+    uint32_t hash = namehash(name);
+    uint32_t found = 0;
+    
+    walksubkeys(readle32(node + 0x1C), [&](uint32_t child, uint32_t hint, bool hashed) {
+        if (hashed && hint != hash) return true;
+        
+        const uint8_t* candidate = keynode(child);
+        if (!candidate) return true;
+        
+        if (samename(candidate + 0x4C, readle16(candidate + 0x48), (readle16(candidate + 2) & 0x20) != 0, name)) {
+            found = child;
+            return false;
+        }
+        return true;
+    }, 0);
+    
+    return found;
+}
+
+uint32_t hiveregistry::walk(uint32_t start, std::wstring_view path) const {
+    uint32_t current = start;
+    
+    while (current && !path.empty()) {
+        size_t end = path.find(L'\\');
+        std::wstring_view part = path.substr(0, end);
+        path.remove_prefix(end == std::wstring_view::npos ? path.size() : end + 1);
+        
+        if (!part.empty()) current = findsubkey(current, part);
+    }
+    
+    return current;
+}
+
+bool hiveregistry::readvalue(uint32_t key, std::wstring_view name, registryvalue& value) const {
+    const uint8_t* node = keynode(key);
+    if (!node) return false;
+    
+    uint32_t count = readle32(node + 0x24);
+    size_t listsize = 0;
+    const uint8_t* list = count ? cell(readle32(node + 0x28), 0, listsize) : nullptr;
+    if (!list) return false;
+    
+    for (size_t i = 0; i < count && (i + 1) * 4 <= listsize; i++) {
+        size_t size = 0;
+        const uint8_t* vk = cell(readle32(list + i * 4), 0x14, size);
+        if (!vk || vk[0] != 'v' || vk[1] != 'k') continue;
+        
+        uint16_t namelength = readle16(vk + 2);
+        if (0x14 + (size_t)namelength > size) continue;
+        if (!samename(vk + 0x14, namelength, (readle16(vk + 0x10) & 1) != 0, name)) continue;
+        
+        uint32_t datasize = readle32(vk + 4);
+        uint32_t dataoffset = readle32(vk + 8);
+        uint32_t type = readle32(vk + 12);
+        
+        if (datasize & 0x80000000) {
+            decoderegistryvalue(type, vk + 8, std::min<size_t>(datasize & 0x7FFFFFFF, 4), value);
+            return true;
+        }
+        
+        if (datasize == 0) {
+            decoderegistryvalue(type, nullptr, 0, value);
+            return true;
+        }
+        
+        size_t cellsize = 0;
+        const uint8_t* data = cell(dataoffset, 0, cellsize);
+        if (!data) return false;
+        
+        if (datasize > bigdatasegment && cellsize >= 8 && data[0] == 'd' && data[1] == 'b') {
+            uint16_t segments = readle16(data + 2);
+            size_t segmentlistsize = 0;
+            const uint8_t* segmentlist = cell(readle32(data + 4), (size_t)segments * 4, segmentlistsize);
+            if (!segmentlist) return false;
+            
+            std::vector<uint8_t> joined;
+            joined.reserve(std::min<size_t>(datasize, (size_t)segments * bigdatasegment));
+            for (size_t s = 0; s < segments && joined.size() < datasize; s++) {
+                size_t segmentsize = 0;
+                const uint8_t* segment = cell(readle32(segmentlist + s * 4), 0, segmentsize);
+                if (!segment) return false;
+                
+                size_t take = std::min({segmentsize, bigdatasegment, (size_t)datasize - joined.size()});
+                joined.insert(joined.end(), segment, segment + take);
+            }
+            
+            decoderegistryvalue(type, joined.data(), joined.size(), value);
+            return true;
+        }
+        
+        decoderegistryvalue(type, data, std::min<size_t>(datasize, cellsize), value);
+        return true;
+    }
+    
+    return false;
+}
+
+bool hiveregistry::load(const uint8_t* data, size_t size) {
+    bins = nullptr;
+    binsize = 0;
+    root = 0;
+    controlset = 0;
+    hardwareconfig = 0;
+    mount.clear();
+    
+    if (!data || size < baseblocksize + 32 || memcmp(data, "regf", 4) != 0) return false;
+    if (memcmp(data + baseblocksize, "hbin", 4) != 0) return false;
+    
+    bins = data + baseblocksize;
+    binsize = size - baseblocksize;
+    
+    uint32_t declared = readle32(data + 0x28);
+    if (declared > 0 && declared < binsize) binsize = declared;
+    
+    uint32_t rootcell = readle32(data + 0x24);
+    if (!keynode(rootcell)) return false;
+    
+    std::wstring filename;
+    for (size_t i = 0; i < 32; i++) {
+        uint16_t c = readle16(data + 0x30 + i * 2);
+        if (c == 0) break;
+        filename += (wchar_t)c;
+    }
+    mount = filename.substr(filename.rfind(L'\\') + 1);
+    if (mount.empty()) mount = L"SYSTEM";
+    
+    root = rootcell;
+    
+    // CurrentControlSet is a volatile link, the file only has ControlSet00n and Select\Current
+    registryvalue current;
+    uint32_t select = findsubkey(root, L"Select");
+    if (select && readvalue(select, L"Current", current) && current.type == registryvaluetype::dword) {
+        wchar_t name[32];
+        swprintf(name, 32, L"ControlSet%03u", current.number);
+        controlset = findsubkey(root, name);
+    }
+    if (!controlset) controlset = findsubkey(root, L"ControlSet001");
+    
+    // HARDWARE\DESCRIPTION\System\BIOS is volatile too, HardwareConfig keeps the same fields per boot configuration
+    registryvalue lastconfig;
+    uint32_t config = findsubkey(root, L"HardwareConfig");
+    if (config && readvalue(config, L"LastConfig", lastconfig) && lastconfig.type == registryvaluetype::string) {
+        hardwareconfig = findsubkey(config, registrystring(lastconfig));
+    }
+    if (config && !hardwareconfig) hardwareconfig = findsubkey(config, L"Current");
+    
+    return true;
+}
+
+bool hiveregistry::open(const std::string& path) {
+    if (!file.open(path)) {
+        load(nullptr, 0);
+        return false;
+    }
+    return load(file.data(), file.size());
+}
+
+bool hiveregistry::openkey(registrykey parent, const std::wstring& path, registrykey& key) {
+    calls.opens++;
+    if (!valid()) return false;
+    
+    std::wstring_view rest = path;
+    uint32_t start = (uint32_t)parent;
+    
+    if (parent == registryroot) {
+        if (hardwareconfig && strippath(rest, L"HARDWARE\\DESCRIPTION\\System\\BIOS")) {
+            start = hardwareconfig;
+        } else if (strippath(rest, mount)) {
+            start = root;
+        } else {
+            return false;
+        }
+    }
+    
+    uint32_t found = walk(start, rest);
+    if (!found) return false;
+    
+    key = found;
+    return true;
+}
+
+void hiveregistry::closekey(registrykey key) {
+    if (key == registryroot) return;
+    calls.closes++;
+}
+
+bool hiveregistry::enumeratesubkeys(registrykey key, std::vector<std::wstring>& names) {
+    calls.enumerations++;
+    
+    if (key == registryroot) {
+        if (valid()) names.push_back(mount);
+        return valid();
+    }
+    
+    const uint8_t* node = keynode((uint32_t)key);
+    if (!node) return false;
+    
+    names.reserve(names.size() + std::min<uint32_t>(readle32(node + 0x14), 4096));
+    walksubkeys(readle32(node + 0x1C), [&](uint32_t child, uint32_t, bool) {
+        const uint8_t* candidate = keynode(child);
+        if (!candidate) return true;
+        
+        size_t length = readle16(candidate + 0x48);
+        bool compressed = (readle16(candidate + 2) & 0x20) != 0;
+        size_t count = compressed ? length : length / 2;
+        
+        std::wstring name;
+        name.reserve(count);
+        for (size_t i = 0; i < count; i++) name += (wchar_t)namechar(candidate + 0x4C, i, compressed);
+        names.push_back(std::move(name));
+        return true;
+    }, 0);
+    
+    return true;
+}
+
+bool hiveregistry::queryvalue(registrykey key, const std::wstring& name, registryvalue& value) {
+    calls.queries++;
+    return key != registryroot && readvalue((uint32_t)key, name, value);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "registry.h"
+#include "mappedfile.h"
+#include <string_view>
+
+class hiveregistry : public registryprovider {
+public:
+    bool open(const std::string& path);
+    bool load(const uint8_t* data, size_t size);
+    
+    bool valid() const { return root != 0; }
+    const std::wstring& mountpoint() const { return mount; }
+    
+    bool openkey(registrykey parent, const std::wstring& path, registrykey& key) override;
+    void closekey(registrykey key) override;
+    bool enumeratesubkeys(registrykey key, std::vector<std::wstring>& names) override;
+    bool queryvalue(registrykey key, const std::wstring& name, registryvalue& value) override;
+
+private:
+    const uint8_t* cell(uint32_t offset, size_t minimum, size_t& size) const;
+    const uint8_t* keynode(uint32_t offset) const;
+    
+    template <typename visitor>
+    bool walksubkeys(uint32_t list, visitor&& visit, int depth) const;
+    
+    uint32_t findsubkey(uint32_t parent, std::wstring_view name) const;
+    uint32_t walk(uint32_t start, std::wstring_view path) const;
+    bool readvalue(uint32_t key, std::wstring_view name, registryvalue& value) const;
+    
+    mappedfile file;
+    const uint8_t* bins = nullptr;
+    size_t binsize = 0;
+    uint32_t root = 0;
+    uint32_t controlset = 0;
+    uint32_t hardwareconfig = 0;
+    std::wstring mount;
+};
@@ -0,0 +1,168 @@
+#include "hwid.h"
+#include "collectors.h"
+#include "resultcache.h"
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+struct hwidsession {
+    hardwareinfo hwinfo;
+    std::vector<collectorresult> results;
+    std::vector<collector> collectors = livecollectors(results);
+    std::vector<std::string> tokens = std::vector<std::string>(collectors.size());
+    std::vector<bool> collected = std::vector<bool>(collectors.size());
+    std::mutex lock;
+};
+
+// one block of text and one array of pointers into it, so a result is released in one call
+struct hwidresults {
+    std::vector<hwiditem> items;
+    std::string text;
+};
+
+static bool selectcategories(const std::vector<collector>& collectors, const char* categories, std::vector<bool>& selected) {
+    selected.assign(collectors.size(), categories == nullptr);
+    if (!categories) return true;
+    
+    std::string list(categories);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        
+        std::string key = list.substr(start, end - start);
+        key.erase(0, key.find_first_not_of(' '));
+        key.erase(key.find_last_not_of(' ') + 1);
+        
+        if (!key.empty()) {
+            bool found = false;
+            for (size_t i = 0; i < collectors.size(); i++) {
+                if (collectors[i].key == key) selected[i] = found = true;
+            }
+            if (!found) return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+static void appendfield(std::string& text, std::vector<size_t>& offsets, std::string_view value) {
+    offsets.push_back(text.size());
+    text.append(value);
+    text.push_back('\0');
+}
+
+static hwidresults* buildresults(const hwidsession& session, const std::vector<bool>& selected) {
+    auto results = std::make_unique<hwidresults>();
+    std::vector<size_t> offsets;
+    
+    size_t count = 0;
+    for (size_t i = 0; i < session.collectors.size(); i++) {
+        if (selected[i]) count += session.results[i].size();
+    }
+    results->items.reserve(count);
+    offsets.reserve(count * 5);
+    
+    for (size_t i = 0; i < session.collectors.size(); i++) {
+        if (!selected[i]) continue;
+        
+        session.results[i].each([&](const recordview& record) {
+            appendfield(results->text, offsets, record.section);
+            appendfield(results->text, offsets, record.category);
+            appendfield(results->text, offsets, record.name);
+            appendfield(results->text, offsets, record.value);
+            appendfield(results->text, offsets, record.notes);
+        });
+    }
+    
+    const char* base = results->text.data();
+    for (size_t i = 0; i < offsets.size(); i += 5) {
+        results->items.push_back({base + offsets[i], base + offsets[i + 1], base + offsets[i + 2], base + offsets[i + 3], base + offsets[i + 4]});
+    }
+    return results.release();
+}
+
+uint32_t hwidversion(void) {
+    return HWIDVERSION;
+}
+
+const char* hwidcategories(void) {
+    static const std::string keys = [] {
+        std::vector<collectorresult> results;
+        std::string list;
+        for (const auto& c : livecollectors(results)) {
+            if (!list.empty()) list += ",";
+            list += c.key;
+        }
+        return list;
+    }();
+    return keys.c_str();
+}
+
+hwidsession* hwidopen(void) {
+    try {
+        return new hwidsession();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void hwidclose(hwidsession* session) {
+    delete session;
+}
+
+int hwidcollect(hwidsession* session, const char* categories, uint32_t flags, hwidresults** results) {
+    if (!session || !results) return HWIDBADARGUMENT;
+    *results = nullptr;
+    
+    try {
+        std::lock_guard<std::mutex> guard(session->lock);
+        
+        std::vector<bool> selected;
+        if (!selectcategories(session->collectors, categories, selected)) return HWIDUNKNOWNCATEGORY;
+        
+        // the token is taken before collecting so a change mid-scan still shows up next time
+        std::vector<collector> due;
+        std::vector<size_t> dueindex;
+        std::vector<std::string> duetokens;
+        for (size_t i = 0; i < session->collectors.size(); i++) {
+            if (!selected[i]) continue;
+            
+            std::string token = cachetoken(session->collectors[i].key);
+            bool reusable = (flags & HWIDREUSE) && !(flags & HWIDFRESH) && session->collected[i] && !token.empty() && token == session->tokens[i];
+            if (reusable) continue;
+            
+            due.push_back(session->collectors[i]);
+            dueindex.push_back(i);
+            duetokens.push_back(std::move(token));
+        }
+        
+        std::vector<bool> succeeded = runcollectors(session->hwinfo, due, 0, [](size_t) {});
+        
+        for (size_t i = 0; i < dueindex.size(); i++) {
+            session->tokens[dueindex[i]] = std::move(duetokens[i]);
+            session->collected[dueindex[i]] = succeeded[i];
+        }
+        
+        *results = buildresults(*session, selected);
+        return HWIDOK;
+    } catch (const std::bad_alloc&) {
+        return HWIDNOMEMORY;
+    } catch (...) {
+        return HWIDFAILED;
+    }
+}
+
+size_t hwidcount(const hwidresults* results) {
+    return results ? results->items.size() : 0;
+}
+
+const hwiditem* hwiditems(const hwidresults* results) {
+    return results && !results->items.empty() ? results->items.data() : nullptr;
+}
+
+void hwidfree(hwidresults* results) {
+    delete results;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+// c interface to the collectors; everything a result hands out stays valid until hwidfree
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(HWIDSHARED) && defined(_WIN32)
+#ifdef HWIDBUILD
+#define HWIDAPI __declspec(dllexport)
+#else
+#define HWIDAPI __declspec(dllimport)
+#endif
+#elif defined(HWIDSHARED) && defined(HWIDBUILD)
+#define HWIDAPI __attribute__((visibility("default")))
+#else
+#define HWIDAPI
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HWIDVERSION 2
+
+// hwidcollect flags; HWIDFRESH is the default and only kept for callers that pass it
+#define HWIDFRESH 0x1u
+#define HWIDREUSE 0x2u
+
+// return codes
+#define HWIDOK 0
+#define HWIDBADARGUMENT 1
+#define HWIDUNKNOWNCATEGORY 2
+#define HWIDNOMEMORY 3
+#define HWIDFAILED 4
+
+typedef struct hwidsession hwidsession;
+typedef struct hwidresults hwidresults;
+
+// utf-8 and nul terminated; section is the collector key (bios, disk, ...), category the item's own
+typedef struct hwiditem {
+    const char* section;
+    const char* category;
+    const char* name;
+    const char* value;
+    const char* notes;
+} hwiditem;
+
+HWIDAPI uint32_t hwidversion(void);
+
+// the comma separated keys hwidcollect accepts
+HWIDAPI const char* hwidcategories(void);
+
+HWIDAPI hwidsession* hwidopen(void);
+HWIDAPI void hwidclose(hwidsession* session);
+
+// categories is a comma separated list, or null for all of them, and each is collected again on every call.
+// with HWIDREUSE a category collected earlier in the session is handed back as is while its device list and
+// boot id are unchanged; that does not see a serial changed in place, so only pass it when that is acceptable.
+// a category whose collector failed comes back as one item named "error" and is never reused
+HWIDAPI int hwidcollect(hwidsession* session, const char* categories, uint32_t flags, hwidresults** results);
+
+HWIDAPI size_t hwidcount(const hwidresults* results);
+HWIDAPI const hwiditem* hwiditems(const hwidresults* results);
+HWIDAPI void hwidfree(hwidresults* results);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,296 +1,861 @@
-#include "hardwareinfo.h"
-#include <iostream>
-#include <iomanip>
-#include <algorithm>
-#include <map>
-#include <conio.h>
-
-void setupconsole() {
-    HANDLE hout = GetStdHandle(STD_OUTPUT_HANDLE);
-    HANDLE hin = GetStdHandle(STD_INPUT_HANDLE);
-    
-    if (hout != INVALID_HANDLE_VALUE) {
-        DWORD dwmode = 0;
-        if (GetConsoleMode(hout, &dwmode)) {
-            dwmode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
-            dwmode &= ~DISABLE_NEWLINE_AUTO_RETURN;
-            SetConsoleMode(hout, dwmode);
-        }
-    }
-    
-    if (hin != INVALID_HANDLE_VALUE) {
-        DWORD dwmode = 0;
-        if (GetConsoleMode(hin, &dwmode)) {
-            dwmode &= ~(ENABLE_QUICK_EDIT_MODE | ENABLE_INSERT_MODE);
-            dwmode |= ENABLE_EXTENDED_FLAGS;
-            SetConsoleMode(hin, dwmode);
-        }
-    }
-    
-    SetConsoleOutputCP(CP_UTF8);
-    SetConsoleCP(CP_UTF8);
-    
-    SetConsoleTitleW(L"");
-    
-    HWND consolewindow = GetConsoleWindow();
-    if (consolewindow) {
-        LONG style = GetWindowLong(consolewindow, GWL_STYLE);
-        style &= ~(WS_MAXIMIZEBOX | WS_SIZEBOX);
-        SetWindowLong(consolewindow, GWL_STYLE, style);
-        
-        SMALL_RECT windowsize = {0, 0, 89, 29};
-        SetConsoleWindowInfo(hout, TRUE, &windowsize);
-        
-        COORD buffersize = {90, 300};
-        SetConsoleScreenBufferSize(hout, buffersize);
-    }
-}
-
-void clearscreen() {
-    std::cout << "\033[2J\033[H";
-}
-
-std::string widetoutf8(const std::wstring& wide) {
-    if (wide.empty()) return "";
-    
-    int size = WideCharToMultiByte(CP_UTF8, 0, wide.c_str(), (int)wide.size(), nullptr, 0, nullptr, nullptr);
-    std::string result(size, 0);
-    WideCharToMultiByte(CP_UTF8, 0, wide.c_str(), (int)wide.size(), &result[0], size, nullptr, nullptr);
-    return result;
-}
-
-void printheader() {
-    std::cout << "  hope serial checker" << std::endl;
-}
-
-void printmainmenu() {
-    clearscreen();
-    printheader();
-    
-    std::cout << std::endl;
-    std::cout << "  select a category to view:" << std::endl;
-    std::cout << std::endl;
-    
-    std::cout << "  ______________________________________ " << std::endl;
-    std::cout << "  |  [1] motherboard information       |" << std::endl;
-    std::cout << "  |  [2] cpu information               |" << std::endl;
-    std::cout << "  |  [3] disk information              |" << std::endl;
-    std::cout << "  |  [4] gpu information               |" << std::endl;
-    std::cout << "  |  [5] network adapters              |" << std::endl;
-    std::cout << "  |  [6] monitor information           |" << std::endl;
-    std::cout << "  |  [7] usb devices                   |" << std::endl;
-    std::cout << "  |  [8] arp table                     |" << std::endl;
-    std::cout << "  |____________________________________|" << std::endl;
-    std::cout << "  |  [0] exit                          |" << std::endl;
-    std::cout << "  |____________________________________|" << std::endl;
-    std::cout << std::endl;
-    std::cout << "  press a number key to select..." << std::endl;
-}
-
-void printcategoryheader(const std::string& category) {
-    std::cout << std::endl;
-    std::string lowered = category;
-    std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
-    std::cout << "================================================================================" << std::endl;
-    std::cout << " " << std::left << std::setw(78) << lowered << std::endl;
-    std::cout << "================================================================================" << std::endl;
-}
-
-void printcategoryfooter() {
-    std::cout << "================================================================================" << std::endl;
-}
-
-void printitem(const hardwareitem& item) {
-    std::string name = widetoutf8(item.name);
-    std::string value = widetoutf8(item.value);
-    std::string notes = widetoutf8(item.notes);
-    
-    if (name.length() > 25) name = name.substr(0, 22) + "...";
-    if (value.length() > 35) value = value.substr(0, 32) + "...";
-    if (notes.length() > 15) notes = notes.substr(0, 12) + "...";
-    
-    std::cout << "| ";
-    std::cout << std::left << std::setw(25) << name;
-    std::cout << " | ";
-    std::cout << std::left << std::setw(35) << value;
-    
-    if (!notes.empty()) {
-        std::cout << " | " << notes;
-    }
-    
-    std::cout << std::endl;
-}
-
-void printsection(const std::string& sectionname, const std::vector<hardwareitem>& items) {
-    if (items.empty()) return;
-    
-    printcategoryheader(sectionname);
-    
-    std::map<std::wstring, std::vector<hardwareitem>> grouped;
-    for (const auto& item : items) {
-        grouped[item.category].push_back(item);
-    }
-    
-    bool first = true;
-    for (const auto& [category, categoryitems] : grouped) {
-        if (!first) {
-            std::cout << "--------------------------------------------------------------------------------" << std::endl;
-        }
-        first = false;
-        
-        if (grouped.size() > 1) {
-            std::cout << "| [ " << widetoutf8(category) << " ]" << std::endl;
-        }
-        
-        for (const auto& item : categoryitems) {
-            printitem(item);
-        }
-    }
-    
-    printcategoryfooter();
-}
-
-void showcategorypage(const std::string& title, const std::vector<hardwareitem>& items) {
-    clearscreen();
-    printheader();
-    
-    printsection(title, items);
-    
-    std::cout << std::endl;
-    std::cout << "  press esc to go back to main menu..." << std::endl;
-    
-    while (true) {
-        int key = _getch();
-        if (key == 27) {
-            break;
-        }
-    }
-}
-
-int main() {
-    setupconsole();
-    clearscreen();
-    printheader();
-    
-    hardwareinfo hwinfo;
-    
-    const int delay_per_fetch = 625;
-    
-    std::vector<hardwareitem> biosinfo, cpuinfo, diskinfo, gpuinfo, nicinfo, monitorinfo, usbinfo, arpinfo;
-    
-    int loadingline = 10;
-    
-    auto showfetching = [&](const std::string& name, int index) {
-        std::cout << "\033[" << (loadingline + index) << ";1H";
-        std::cout << "                                                                        ";
-        std::cout << "\033[" << (loadingline + index) << ";1H";
-        std::string lowername = name;
-        std::transform(lowername.begin(), lowername.end(), lowername.begin(), ::tolower);
-        std::cout << "  [" << (index + 1) << "] fetching " << lowername << " information..." << std::flush;
-    };
-    
-    auto showcomplete = [&](const std::string& name, int index, int itemcount) {
-        std::cout << "\033[" << (loadingline + index) << ";1H";
-        std::cout << "                                                                        ";
-        std::cout << "\033[" << (loadingline + index) << ";1H";
-        std::string lowername = name;
-        std::transform(lowername.begin(), lowername.end(), lowername.begin(), ::tolower);
-        std::cout << "  [" << (index + 1) << "] + " << lowername << " (" << itemcount << " items)" << std::flush;
-    };
-    
-    std::cout << "\033[" << (loadingline - 1) << ";1H";
-    std::cout << "  initializing hardware detection..." << std::endl;
-    
-    showfetching("bios/system", 0);
-    Sleep(delay_per_fetch);
-    biosinfo = hwinfo.getbiosinfo();
-    showcomplete("bios/system", 0, (int)biosinfo.size());
-    
-    showfetching("cpu", 1);
-    Sleep(delay_per_fetch);
-    cpuinfo = hwinfo.getprocessorinfo();
-    showcomplete("cpu", 1, (int)cpuinfo.size());
-    
-    showfetching("disk", 2);
-    Sleep(delay_per_fetch);
-    diskinfo = hwinfo.getdiskinfo();
-    showcomplete("disk", 2, (int)diskinfo.size());
-    
-    showfetching("gpu", 3);
-    Sleep(delay_per_fetch);
-    gpuinfo = hwinfo.getvideocontrollerinfo();
-    showcomplete("gpu", 3, (int)gpuinfo.size());
-    
-    showfetching("network adapter", 4);
-    Sleep(delay_per_fetch);
-    nicinfo = hwinfo.getnetworkadapterinfo();
-    showcomplete("network adapter", 4, (int)nicinfo.size());
-    
-    showfetching("monitor", 5);
-    Sleep(delay_per_fetch);
-    monitorinfo = hwinfo.getmonitorinfo();
-    showcomplete("monitor", 5, (int)monitorinfo.size());
-    
-    showfetching("usb device", 6);
-    Sleep(delay_per_fetch);
-    usbinfo = hwinfo.getusbdevices();
-    showcomplete("usb device", 6, (int)usbinfo.size());
-    
-    showfetching("arp table", 7);
-    Sleep(delay_per_fetch);
-    arpinfo = hwinfo.getarptable();
-    showcomplete("arp table", 7, (int)arpinfo.size());
-    
-    std::cout << "\033[" << (loadingline + 9) << ";1H";
-    std::cout << std::endl;
-    std::cout << "  + all hardware information loaded! " << std::endl;
-    std::cout << "  press any key to continue..." << std::flush;
-    
-    _getch();
-    
-    bool running = true;
-    
-    while (running) {
-        printmainmenu();
-        
-        int key = _getch();
-        
-        switch (key) {
-            case '1':
-                showcategorypage("bios / system information", biosinfo);
-                break;
-            case '2':
-                showcategorypage("cpu information", cpuinfo);
-                break;
-            case '3':
-                showcategorypage("disk information", diskinfo);
-                break;
-            case '4':
-                showcategorypage("gpu information", gpuinfo);
-                break;
-            case '5':
-                showcategorypage("network adapter information", nicinfo);
-                break;
-            case '6':
-                showcategorypage("monitor information (edid)", monitorinfo);
-                break;
-            case '7':
-                showcategorypage("usb devices", usbinfo);
-                break;
-            case '8':
-                showcategorypage("arp table", arpinfo);
-                break;
-            case '0':
-            case 27:
-                running = false;
-                break;
-            default:
-                break;
-        }
-    }
-    
-    clearscreen();
-    std::cout << "  goodbye!" << std::endl;
-    
-    return 0;
-}
+#include "hardwareinfo.h"
+#include "collectors.h"
+#include "textutil.h"
+#include "output.h"
+#include "snapshot.h"
+#include "fleet.h"
+#include "hive.h"
+#include "watch.h"
+#include "resultcache.h"
+#include "trace.h"
+#include "fingerprint.h"
+#include "consoleview.h"
+#include <iostream>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <cstdlib>
+#include <thread>
+#include <chrono>
+#include <functional>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <conio.h>
+#else
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+void setupconsole() {
+#ifdef _WIN32
+    HANDLE hout = GetStdHandle(STD_OUTPUT_HANDLE);
+    HANDLE hin = GetStdHandle(STD_INPUT_HANDLE);
+    
+    if (hout != INVALID_HANDLE_VALUE) {
+        DWORD dwmode = 0;
+        if (GetConsoleMode(hout, &dwmode)) {
+            dwmode |= ENABLE_VIRTUAL_TERMINAL_PROCESSING;
+            dwmode &= ~DISABLE_NEWLINE_AUTO_RETURN;
+            SetConsoleMode(hout, dwmode);
+        }
+    }
+    
+    if (hin != INVALID_HANDLE_VALUE) {
+        DWORD dwmode = 0;
+        if (GetConsoleMode(hin, &dwmode)) {
+            dwmode &= ~(ENABLE_QUICK_EDIT_MODE | ENABLE_INSERT_MODE);
+            dwmode |= ENABLE_EXTENDED_FLAGS;
+            SetConsoleMode(hin, dwmode);
+        }
+    }
+    
+    SetConsoleOutputCP(CP_UTF8);
+    SetConsoleCP(CP_UTF8);
+    
+    SetConsoleTitleW(L"");
+    
+    HWND consolewindow = GetConsoleWindow();
+    if (consolewindow) {
+        LONG style = GetWindowLong(consolewindow, GWL_STYLE);
+        style &= ~(WS_MAXIMIZEBOX | WS_SIZEBOX);
+        SetWindowLong(consolewindow, GWL_STYLE, style);
+        
+        SMALL_RECT windowsize = {0, 0, 89, 29};
+        SetConsoleWindowInfo(hout, TRUE, &windowsize);
+        
+        // pages scroll themselves, so the buffer is just the window and nothing spills into scrollback
+        COORD buffersize = {90, 30};
+        SetConsoleScreenBufferSize(hout, buffersize);
+    }
+#endif
+}
+
+int readkey() {
+#ifdef _WIN32
+    return _getch();
+#else
+    termios original;
+    if (tcgetattr(STDIN_FILENO, &original) != 0) {
+        return getchar();
+    }
+    
+    termios raw = original;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    
+    unsigned char key = 0;
+    int result = read(STDIN_FILENO, &key, 1) == 1 ? key : -1;
+    
+    tcsetattr(STDIN_FILENO, TCSANOW, &original);
+    return result;
+#endif
+}
+
+void clearscreen() {
+    std::cout << "\033[2J\033[H";
+}
+
+void printheader() {
+    std::cout << "  hope serial checker" << std::endl;
+}
+
+enum class resultstate {
+    loading,
+    cached,
+    stale,
+    fresh,
+    updated
+};
+
+std::string resultstatetag(resultstate state) {
+    switch (state) {
+        case resultstate::loading: return "  loading";
+        case resultstate::cached: return "  cached";
+        case resultstate::stale: return "  stale";
+        case resultstate::updated: return "  updated";
+        default: return "";
+    }
+}
+
+std::string resultstatenote(resultstate state) {
+    switch (state) {
+        case resultstate::loading: return "still collecting, check back in a moment";
+        case resultstate::cached: return "cached result, confirming in the background";
+        case resultstate::stale: return "stale: cached before a hardware change, refreshing in the background";
+        case resultstate::updated: return "updated: differs from the cached result";
+        default: return "";
+    }
+}
+
+bool sameitems(const collectorresult& a, const collectorresult& b) {
+    if (a.items.size() != b.items.size() || !(a.neighbors == b.neighbors)) return false;
+    for (size_t i = 0; i < a.items.size(); i++) {
+        const recordview& x = a.items[i];
+        const recordview& y = b.items[i];
+        if (x.category != y.category || x.name != y.name || x.value != y.value || x.notes != y.notes) return false;
+    }
+    return true;
+}
+
+void printmainmenu(const std::vector<std::string>& tags) {
+    clearscreen();
+    printheader();
+    
+    std::cout << std::endl;
+    std::cout << "  select a category to view:" << std::endl;
+    std::cout << std::endl;
+    
+    std::cout << "  ______________________________________ " << std::endl;
+    std::cout << "  |  [1] motherboard information       |" << tags[0] << std::endl;
+    std::cout << "  |  [2] cpu information               |" << tags[1] << std::endl;
+    std::cout << "  |  [3] disk information              |" << tags[2] << std::endl;
+    std::cout << "  |  [4] gpu information               |" << tags[3] << std::endl;
+    std::cout << "  |  [5] network adapters              |" << tags[4] << std::endl;
+    std::cout << "  |  [6] monitor information           |" << tags[5] << std::endl;
+    std::cout << "  |  [7] usb devices                   |" << tags[6] << std::endl;
+    std::cout << "  |  [8] arp table                     |" << tags[7] << std::endl;
+    std::cout << "  |____________________________________|" << std::endl;
+    std::cout << "  |  [0] exit                          |" << std::endl;
+    std::cout << "  |____________________________________|" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  press a number key to select..." << std::endl;
+}
+
+enum class pagemode {
+    browsing,
+    filtering,
+    searching
+};
+
+// the whole page goes out as one frame drawn over the last one; only the rows on screen are formatted
+void showcategorypage(const std::string& title, pageview& page, const std::string& status) {
+    static const std::string rule(80, '=');
+    
+    std::string lowered = title;
+    asciilower(lowered);
+    
+    pagemode mode = pagemode::browsing;
+    std::string typed;
+    std::string search;
+    size_t top = 0;
+    size_t marked = pageview::npos;
+    size_t searchstart = 0;
+    std::string frame;
+    
+    clearscreen();
+    
+    while (true) {
+        consolesize size = getconsolesize();
+        size_t fixed = 9 + (status.empty() ? 0 : 2);
+        size_t height = size.rows > fixed + 1 ? size.rows - fixed : 1;
+        size_t columns = size.columns > 1 ? size.columns - 1 : 1;
+        
+        if (marked != pageview::npos && (marked < top || marked >= top + height)) top = marked > height / 3 ? marked - height / 3 : 0;
+        if (top + height > page.size()) top = page.size() > height ? page.size() - height : 0;
+        
+        frame.clear();
+        frame += "\033[H  hope serial checker\033[K\n";
+        if (!status.empty()) {
+            frame += "\033[K\n  [";
+            appendfitted(frame, status, columns > 4 ? columns - 4 : 0, false);
+            frame += "]\033[K\n";
+        }
+        
+        if (page.total() > 0) {
+            frame += "\033[K\n";
+            appendfitted(frame, rule, columns, false);
+            frame += "\033[K\n ";
+            appendfitted(frame, lowered, columns - 1, false);
+            frame += "\033[K\n";
+            appendfitted(frame, rule, columns, false);
+            frame += "\033[K\n";
+            page.render(frame, top, height, columns + 1, marked);
+            appendfitted(frame, rule, columns, false);
+            frame += "\033[K\n";
+        }
+        
+        std::string position = page.size() == 0 ? "  no rows" : "  rows " + std::to_string(top + 1) + "-" +
+            std::to_string(std::min(top + height, page.size())) + " of " + std::to_string(page.size());
+        if (!page.filtertext().empty()) {
+            position += ", filter \"" + page.filtertext() + "\" keeps " + std::to_string(page.matched()) + " of " +
+                std::to_string(page.total()) + " items";
+        }
+        frame += "\033[K\n";
+        appendfitted(frame, position, columns, false);
+        frame += "\033[K\n";
+        
+        std::string prompt;
+        if (mode == pagemode::filtering) prompt = "  filter: " + typed + "_  (enter keeps it, esc clears it)";
+        else if (mode == pagemode::searching) prompt = "  search: " + typed + "_  (enter keeps it, esc cancels)" + (marked == pageview::npos && !typed.empty() ? "  no match" : "");
+        else prompt = "  arrows, pgup/pgdn, home/end scroll, f filter, / search, n/N next/previous match, esc back to main menu";
+        appendfitted(frame, prompt, columns, false);
+        frame += "\033[K\033[J";
+        writeconsole(frame);
+        
+        int key = readconsolekey();
+        
+        if (mode != pagemode::browsing) {
+            bool enter = key == '\r' || key == '\n';
+            bool erase = key == 8 || key == 127;
+            bool text = key >= 0x20 && key < 0x100 && key != 127;
+            
+            if (key == 27) {
+                if (mode == pagemode::filtering) page.filter("");
+                marked = pageview::npos;
+                mode = pagemode::browsing;
+            } else if (enter) {
+                if (mode == pagemode::searching) search = typed;
+                mode = pagemode::browsing;
+            } else if (erase || text) {
+                if (erase) {
+                    // one whole utf-8 character, not just its last byte
+                    while (!typed.empty() && ((unsigned char)typed.back() & 0xC0) == 0x80) typed.pop_back();
+                    if (!typed.empty()) typed.pop_back();
+                } else {
+                    typed.push_back((char)key);
+                }
+                
+                if (mode == pagemode::filtering) {
+                    if (page.filter(typed)) top = 0;
+                } else {
+                    marked = page.find(typed, searchstart, false);
+                }
+            }
+            continue;
+        }
+        
+        switch (key) {
+            case keyup: case 'k': if (top > 0) top--; marked = pageview::npos; break;
+            case keydown: case 'j': top++; marked = pageview::npos; break;
+            case keypageup: case 'b': top = top > height ? top - height : 0; marked = pageview::npos; break;
+            case keypagedown: case ' ': top += height; marked = pageview::npos; break;
+            case keyhome: case 'g': top = 0; marked = pageview::npos; break;
+            case keyend: case 'G': top = page.size(); marked = pageview::npos; break;
+            case 'f':
+                mode = pagemode::filtering;
+                typed = page.filtertext();
+                break;
+            case '/':
+                mode = pagemode::searching;
+                typed.clear();
+                searchstart = top;
+                marked = pageview::npos;
+                break;
+            case 'n':
+            case 'N': {
+                bool backwards = key == 'N';
+                size_t from = marked == pageview::npos ? top : backwards ? (marked > 0 ? marked - 1 : pageview::npos) : marked + 1;
+                size_t found = from == pageview::npos ? pageview::npos : page.find(search, from, backwards);
+                if (found != pageview::npos) marked = found;
+                break;
+            }
+            case 27:
+                if (!page.filtertext().empty()) {
+                    page.filter("");
+                    top = 0;
+                    marked = pageview::npos;
+                    break;
+                }
+                return;
+        }
+    }
+}
+
+struct headlessoptions {
+    outputformat format = outputformat::json;
+    bool formatgiven = false;
+    std::string categories;
+    std::string outputpath;
+    std::string baselinepath;
+    std::string diffpath;
+    std::string exportpath;
+    std::string fleetroot;
+    std::string indexpath;
+    std::string query;
+    bool prefixsearch = false;
+    size_t limit = 100;
+    std::string hivepath;
+    bool watch = false;
+    bool fingerprinting = false;
+    fleetoptions fleet;
+    int delay_per_fetch = 0;
+};
+
+void printusage() {
+    std::cerr << "usage: ud [--delay ms] [--format json|ndjson|csv] [--categories list] [--output path]" << std::endl;
+    std::cerr << "          [--save-baseline path] [--diff path] [--export path]" << std::endl;
+    std::cerr << "          [--fleet dir [--threads n] [--rate hosts/s]] [--hive path] [--watch] [--no-cache]" << std::endl;
+    std::cerr << "          [--index path [--fleet dir [--memory mb]] [--lookup value] [--prefix value [--limit n]]]" << std::endl;
+    std::cerr << "          [--trace path] [--fingerprint]" << std::endl;
+    std::cerr << "  --format        collect without the interactive ui and write results" << std::endl;
+    std::cerr << "  --categories    comma separated: bios,cpu,disk,gpu,nic,monitor,usb,arp (default all)" << std::endl;
+    std::cerr << "  --output        write results to a file instead of stdout" << std::endl;
+    std::cerr << "  --save-baseline store this scan as a binary snapshot" << std::endl;
+    std::cerr << "  --diff          compare this scan against a snapshot and write only what changed" << std::endl;
+    std::cerr << "  --export        write a stored snapshot in the chosen format without scanning" << std::endl;
+    std::cerr << "  --fleet         parse captured inputs (one folder or .snap per host) and report serials seen on more than one host" << std::endl;
+    std::cerr << "  --index         with --fleet, write every identifier of every host to a sorted index file instead of the report;" << std::endl;
+    std::cerr << "                  with --lookup or --prefix, find the hosts and inputs an identifier turned up in" << std::endl;
+    std::cerr << "  --hive          read bios, gpu, nic and monitor values from a saved SYSTEM hive instead of this machine" << std::endl;
+    std::cerr << "  --no-cache      ignore the cached results the menu normally opens with and scan from scratch" << std::endl;
+    std::cerr << "  --watch         keep running and write the changes each usb, disk, monitor, arp or nic event causes (ndjson by default)" << std::endl;
+    std::cerr << "  --fingerprint   write the composite machine id and its per category digests instead of the items (with --diff, --export, --watch too)" << std::endl;
+    std::cerr << "  --trace         time every collector and the os calls it makes and write a chrome trace (chrome://tracing, perfetto) on exit" << std::endl;
+}
+
+void writefingerprintrecords(std::ostream& out, outputformat format, const fingerprint& print, const fingerprint* baseline) {
+    auto writer = createresultwriter(format, out);
+    writer->begin();
+    writefingerprint(*writer, print, baseline);
+    writer->end();
+    out.flush();
+}
+
+int runwatch(hardwareinfo& hwinfo, std::vector<collector> collectors, std::ostream& out, outputformat format, bool fingerprinting) {
+    static const std::map<std::string, unsigned> sources = {
+        {"usb", watchusb}, {"disk", watchdisk}, {"monitor", watchmonitor}, {"arp", watcharp}, {"nic", watchnic},
+    };
+    
+    fingerprinter engine;
+    fingerprint print;
+    if (fingerprinting) {
+        // categories no event touches still belong in the composite, so they are read once up front
+        std::vector<collector> fixed;
+        for (const auto& c : collectors) {
+            if (!sources.count(c.key) && fingerprintcomponent(c.key) >= 0) fixed.push_back(c);
+        }
+        runcollectors(hwinfo, fixed, 0, [](size_t) {});
+        for (const auto& c : fixed) engine.update(print, c.key, c.result->items);
+    }
+    
+    collectors.erase(std::remove_if(collectors.begin(), collectors.end(), [&](const collector& c) { return !sources.count(c.key); }), collectors.end());
+    if (collectors.empty()) {
+        std::cerr << "--watch covers usb, disk, monitor, arp and nic" << std::endl;
+        return 2;
+    }
+    
+    changewatcher watcher;
+    if (!watcher.start()) {
+        std::cerr << "could not subscribe to device and network change notifications" << std::endl;
+        return 1;
+    }
+    
+    auto capture = [&](const collector& c) {
+        snapshot result;
+        c.result->each([&](const recordview& record) { result.add(record); });
+        return result;
+    };
+    
+    runcollectors(hwinfo, collectors, 0, [](size_t) {});
+    std::vector<snapshot> previous;
+    for (const auto& c : collectors) previous.push_back(capture(c));
+    
+    if (fingerprinting) {
+        for (const auto& c : collectors) engine.update(print, c.key, c.result->items);
+        writefingerprintrecords(out, format, print, nullptr);
+    }
+    
+    while (out.good()) {
+        unsigned mask = watcher.wait(-1);
+        
+        std::vector<collector> due;
+        std::vector<size_t> slots;
+        for (size_t i = 0; i < collectors.size(); i++) {
+            if (mask & sources.at(collectors[i].key)) {
+                due.push_back(collectors[i]);
+                slots.push_back(i);
+            }
+        }
+        if (due.empty()) continue;
+        
+        runcollectors(hwinfo, due, 0, [](size_t) {});
+        
+        // only the digests of the categories that ran are recomputed
+        if (fingerprinting) {
+            fingerprint before = print;
+            bool changed = false;
+            for (const auto& c : due) changed |= engine.update(print, c.key, c.result->items);
+            if (changed) writefingerprintrecords(out, format, print, &before);
+            continue;
+        }
+        
+        for (size_t i = 0; i < due.size(); i++) {
+            snapshot current = capture(due[i]);
+            std::vector<snapshotchange> changes = diffsnapshots(previous[slots[i]], current);
+            if (!changes.empty()) writesnapshotchanges(out, format, changes);
+            previous[slots[i]] = std::move(current);
+        }
+    }
+    
+    return 1;
+}
+
+int runheadless(hardwareinfo& hwinfo, std::vector<collector> collectors, const headlessoptions& options) {
+    if (!options.categories.empty()) {
+        std::vector<collector> selected;
+        std::stringstream list(options.categories);
+        std::string key;
+        
+        while (std::getline(list, key, ',')) {
+            if (key.empty()) continue;
+            
+            auto it = std::find_if(collectors.begin(), collectors.end(), [&](const collector& c) { return c.key == key; });
+            if (it == collectors.end()) {
+                std::cerr << "unknown category: " << key << std::endl;
+                return 2;
+            }
+            
+            if (std::none_of(selected.begin(), selected.end(), [&](const collector& c) { return c.key == key; })) {
+                selected.push_back(*it);
+            }
+        }
+        
+        collectors = selected;
+    }
+    
+    snapshot baseline;
+    if (!options.diffpath.empty() && !baseline.load(options.diffpath)) {
+        std::cerr << "could not read snapshot " << options.diffpath << std::endl;
+        return 1;
+    }
+    
+    snapshot stored;
+    if (!options.exportpath.empty() && !stored.load(options.exportpath)) {
+        std::cerr << "could not read snapshot " << options.exportpath << std::endl;
+        return 1;
+    }
+    
+    std::ofstream file;
+    if (!options.outputpath.empty()) {
+        file.open(options.outputpath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            std::cerr << "could not open " << options.outputpath << std::endl;
+            return 1;
+        }
+    }
+    
+    std::ostream& out = options.outputpath.empty() ? std::cout : file;
+    
+    if (options.watch) {
+        return runwatch(hwinfo, collectors, out, options.formatgiven ? options.format : outputformat::ndjson, options.fingerprinting);
+    }
+    
+    if (!options.indexpath.empty() && options.fleetroot.empty()) {
+        serialindex index;
+        if (!index.open(options.indexpath)) {
+            std::cerr << "could not read index " << options.indexpath << std::endl;
+            return 1;
+        }
+        
+        auto matches = options.prefixsearch ? index.prefix(options.query, options.limit) : index.lookup(options.query);
+        writefleetmatches(out, options.format, index, matches);
+        return out.good() ? 0 : 1;
+    }
+    
+    if (!options.fleetroot.empty()) {
+        if (!options.indexpath.empty()) {
+            fleetindexreport report = buildfleetindex(options.fleetroot, options.indexpath, options.fleet);
+            if (!report.written) {
+                std::cerr << "could not write index " << options.indexpath << std::endl;
+                return 1;
+            }
+            writefleetindexreport(out, options.format, report);
+            return out.good() ? 0 : 1;
+        }
+        
+        writefleetreport(out, options.format, scanfleet(options.fleetroot, options.fleet));
+        return out.good() ? 0 : 1;
+    }
+    
+    fingerprinter engine;
+    fingerprint baselineprint;
+    if (options.fingerprinting && !options.diffpath.empty()) engine.compute(baselineprint, baseline.records());
+    const fingerprint* against = options.diffpath.empty() ? nullptr : &baselineprint;
+    
+    if (!options.exportpath.empty()) {
+        if (options.fingerprinting) {
+            fingerprint print;
+            engine.compute(print, stored.records());
+            writefingerprintrecords(out, options.format, print, against);
+            return out.good() ? 0 : 1;
+        }
+        
+        auto writer = createresultwriter(options.format, out);
+        stored.write(*writer);
+        return out.good() ? 0 : 1;
+    }
+    
+    bool streaming = options.diffpath.empty() && !options.fingerprinting && (options.formatgiven || options.baselinepath.empty());
+    auto writer = createresultwriter(options.format, out);
+    
+    if (streaming) writer->begin();
+    runcollectors(hwinfo, collectors, options.delay_per_fetch, [&](size_t index) {
+        if (!streaming) return;
+        collectors[index].result->each([&](const recordview& record) { writer->writerecord(record); });
+    });
+    if (streaming) writer->end();
+    
+    snapshot current;
+    current.host = options.hivepath.empty() ? currenthostname() : options.hivepath;
+    current.timestamp = (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    for (const auto& c : collectors) {
+        c.result->each([&](const recordview& record) { current.add(record); });
+    }
+    
+    if (options.fingerprinting) {
+        // components outside --categories carry over from the baseline, so only the ones scanned can differ from it
+        fingerprint print = against ? *against : fingerprint();
+        for (const auto& c : collectors) engine.update(print, c.key, c.result->items);
+        writefingerprintrecords(out, options.format, print, against);
+    } else if (!options.diffpath.empty()) {
+        // a baseline of every category compared with a scan of some would report the rest as removed
+        if (!options.categories.empty()) {
+            std::vector<std::string> keys;
+            for (const auto& c : collectors) keys.push_back(c.key);
+            baseline.retain(keys);
+        }
+        writesnapshotchanges(out, options.format, diffsnapshots(baseline, current));
+    }
+    
+    if (!options.baselinepath.empty() && !current.save(options.baselinepath)) {
+        std::cerr << "could not write snapshot " << options.baselinepath << std::endl;
+        return 1;
+    }
+    
+    return out.good() ? 0 : 1;
+}
+
+void finishtrace(const std::string& path) {
+    if (path.empty()) return;
+    if (!writetrace(path)) std::cerr << "could not write trace " << path << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int delay_per_fetch = 0;
+    bool nocache = false;
+    bool headless = false;
+    std::string tracepath;
+    headlessoptions options;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--delay" && i + 1 < argc) {
+            delay_per_fetch = std::max(0, atoi(argv[++i]));
+        } else if (arg == "--format" && i + 1 < argc) {
+            headless = true;
+            options.formatgiven = true;
+            if (!parseoutputformat(argv[++i], options.format)) {
+                printusage();
+                return 2;
+            }
+        } else if (arg == "--categories" && i + 1 < argc) {
+            headless = true;
+            options.categories = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            headless = true;
+            options.outputpath = argv[++i];
+        } else if (arg == "--save-baseline" && i + 1 < argc) {
+            headless = true;
+            options.baselinepath = argv[++i];
+        } else if (arg == "--diff" && i + 1 < argc) {
+            headless = true;
+            options.diffpath = argv[++i];
+        } else if (arg == "--export" && i + 1 < argc) {
+            headless = true;
+            options.exportpath = argv[++i];
+        } else if (arg == "--fleet" && i + 1 < argc) {
+            headless = true;
+            options.fleetroot = argv[++i];
+        } else if (arg == "--index" && i + 1 < argc) {
+            headless = true;
+            options.indexpath = argv[++i];
+        } else if ((arg == "--lookup" || arg == "--prefix") && i + 1 < argc) {
+            headless = true;
+            options.prefixsearch = arg == "--prefix";
+            options.query = argv[++i];
+        } else if (arg == "--limit" && i + 1 < argc) {
+            options.limit = (size_t)std::max(1, atoi(argv[++i]));
+        } else if (arg == "--memory" && i + 1 < argc) {
+            options.fleet.memory = (size_t)std::max(1, atoi(argv[++i])) << 20;
+        } else if (arg == "--hive" && i + 1 < argc) {
+            headless = true;
+            options.hivepath = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracepath = argv[++i];
+        } else if (arg == "--no-cache") {
+            nocache = true;
+        } else if (arg == "--fingerprint") {
+            headless = true;
+            options.fingerprinting = true;
+        } else if (arg == "--watch") {
+            headless = true;
+            options.watch = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.fleet.threads = (size_t)std::max(0, atoi(argv[++i]));
+        } else if (arg == "--rate" && i + 1 < argc) {
+            options.fleet.hostspersecond = std::max(0.0, atof(argv[++i]));
+        } else {
+            printusage();
+            return arg == "--help" || arg == "-h" ? 0 : 2;
+        }
+    }
+    
+    // an index is built from --fleet or queried with --lookup or --prefix, and a query needs an index
+    if (options.indexpath.empty() != options.query.empty() && options.fleetroot.empty()) {
+        printusage();
+        return 2;
+    }
+    
+    if (!tracepath.empty()) starttrace();
+    
+    hardwareinfo hwinfo;
+    
+    std::vector<collectorresult> results;
+    const std::vector<collector> collectors = livecollectors(results);
+    
+    if (!options.hivepath.empty()) {
+        auto hive = std::make_unique<hiveregistry>();
+        if (!hive->open(options.hivepath)) {
+            std::cerr << "could not read hive " << options.hivepath << std::endl;
+            return 1;
+        }
+        
+        hardwareinfo hiveinfo(nullptr, std::move(hive));
+        std::vector<collectorresult> hiveresults;
+        const std::vector<collector> hivecollectors = registrycollectors(hiveresults);
+        
+        std::ios::sync_with_stdio(false);
+        options.delay_per_fetch = delay_per_fetch;
+        int result = runheadless(hiveinfo, hivecollectors, options);
+        finishtrace(tracepath);
+        return result;
+    }
+    
+    if (headless) {
+        std::ios::sync_with_stdio(false);
+        options.delay_per_fetch = delay_per_fetch;
+        int result = runheadless(hwinfo, collectors, options);
+        finishtrace(tracepath);
+        return result;
+    }
+    
+    std::string cachepath = defaultcachepath();
+    resultcache cache;
+    if (!nocache && !cachepath.empty()) cache.load(cachepath);
+    
+    std::vector<std::string> tokens(collectors.size());
+    std::vector<resultstate> states(collectors.size(), resultstate::loading);
+    bool warm = !nocache && !cachepath.empty();
+    
+    for (size_t i = 0; i < collectors.size(); i++) {
+        tokens[i] = cachetoken(collectors[i].key);
+        if (tokens[i].empty()) continue;
+        
+        const cachedcategory* hit = cache.find(collectors[i].key);
+        if (!hit) {
+            warm = false;
+            continue;
+        }
+        
+        for (const auto& record : hit->items.records()) collectors[i].result->items.add(record);
+        states[i] = hit->token == tokens[i] ? resultstate::cached : resultstate::stale;
+    }
+    
+    setupconsole();
+    clearscreen();
+    printheader();
+    
+    std::mutex consolelock;
+    std::mutex resultlock;
+    bool onmenu = false;
+    
+    // a page is laid out the first time it is shown after its results change, and kept until they change again
+    std::vector<pageview> pages(collectors.size());
+    std::vector<bool> pagesbuilt(collectors.size(), false);
+    
+    auto savecache = [&] {
+        if (cachepath.empty()) return;
+        // arp has no cache token, so a neighbor table is never one of the categories stored
+        for (size_t i = 0; i < collectors.size(); i++) {
+            cache.store(collectors[i].key, tokens[i], collectors[i].result->items);
+        }
+        cache.save(cachepath);
+    };
+    
+    auto menutags = [&] {
+        std::lock_guard<std::mutex> guard(resultlock);
+        std::vector<std::string> tags;
+        for (resultstate state : states) tags.push_back(resultstatetag(state));
+        return tags;
+    };
+    
+    std::vector<collectorresult> refreshed(collectors.size());
+    std::vector<collector> refreshcollectors = collectors;
+    for (size_t i = 0; i < collectors.size(); i++) {
+        refreshcollectors[i].result = &refreshed[i];
+    }
+    
+    std::thread refresher;
+    
+    if (warm) {
+        refresher = std::thread([&] {
+            runcollectors(hwinfo, refreshcollectors, delay_per_fetch, [&](size_t index) {
+                {
+                    std::lock_guard<std::mutex> guard(resultlock);
+                    bool confirmed = states[index] == resultstate::loading || sameitems(refreshed[index], *collectors[index].result);
+                    states[index] = confirmed ? resultstate::fresh : resultstate::updated;
+                    std::swap(*collectors[index].result, refreshed[index]);
+                    pagesbuilt[index] = false;
+                }
+                
+                std::lock_guard<std::mutex> guard(consolelock);
+                if (onmenu) printmainmenu(menutags());
+            });
+            
+            savecache();
+        });
+    } else {
+        int loadingline = 10;
+        
+        auto showfetching = [&](const std::string& name, int index) {
+            std::cout << "\033[" << (loadingline + index) << ";1H";
+            std::cout << "                                                                        ";
+            std::cout << "\033[" << (loadingline + index) << ";1H";
+            std::string lowername = name;
+            asciilower(lowername);
+            std::cout << "  [" << (index + 1) << "] fetching " << lowername << " information..." << std::flush;
+        };
+        
+        auto showcomplete = [&](const std::string& name, int index, int itemcount) {
+            std::cout << "\033[" << (loadingline + index) << ";1H";
+            std::cout << "                                                                        ";
+            std::cout << "\033[" << (loadingline + index) << ";1H";
+            std::string lowername = name;
+            asciilower(lowername);
+            std::cout << "  [" << (index + 1) << "] + " << lowername << " (" << itemcount << " items)" << std::flush;
+        };
+        
+        std::cout << "\033[" << (loadingline - 1) << ";1H";
+        std::cout << "  initializing hardware detection..." << std::endl;
+        
+        for (size_t i = 0; i < collectors.size(); i++) {
+            showfetching(collectors[i].name, (int)i);
+        }
+        
+        runcollectors(hwinfo, collectors, delay_per_fetch, [&](size_t index) {
+            std::lock_guard<std::mutex> guard(consolelock);
+            showcomplete(collectors[index].name, (int)index, (int)collectors[index].result->size());
+        });
+        
+        std::fill(states.begin(), states.end(), resultstate::fresh);
+        savecache();
+        
+        std::cout << "\033[" << (loadingline + 9) << ";1H";
+        std::cout << std::endl;
+        std::cout << "  + all hardware information loaded! " << std::endl;
+        std::cout << "  press any key to continue..." << std::flush;
+        
+        readkey();
+    }
+    
+    static const char* pagetitles[] = {
+        "bios / system information",
+        "cpu information",
+        "disk information",
+        "gpu information",
+        "network adapter information",
+        "monitor information (edid)",
+        "usb devices",
+        "arp table",
+    };
+    
+    bool running = true;
+    
+    while (running) {
+        {
+            std::lock_guard<std::mutex> guard(consolelock);
+            onmenu = true;
+            printmainmenu(menutags());
+        }
+        
+        int key = readkey();
+        
+        {
+            std::lock_guard<std::mutex> guard(consolelock);
+            onmenu = false;
+        }
+        
+        if (key >= '1' && key <= '8') {
+            size_t index = (size_t)(key - '1');
+            std::string status;
+            {
+                std::lock_guard<std::mutex> guard(resultlock);
+                if (!pagesbuilt[index]) {
+                    const collectorresult& result = *collectors[index].result;
+                    if (result.neighbors.empty()) pages[index].build(result.items);
+                    else pages[index].build(result.neighbors);
+                    pagesbuilt[index] = true;
+                }
+                status = resultstatenote(states[index]);
+            }
+            showcategorypage(pagetitles[index], pages[index], status);
+        } else if (key == '0' || key == 27) {
+            running = false;
+        }
+    }
+    
+    clearscreen();
+    if (refresher.joinable()) {
+        std::cout << "  finishing background refresh..." << std::endl;
+        refresher.join();
+        clearscreen();
+    }
+    std::cout << "  goodbye!" << std::endl;
+    
+    finishtrace(tracepath);
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include "mappedfile.h"
+#include "textutil.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mappedfile::~mappedfile() {
+    close();
+}
+
+#ifdef _WIN32
+bool mappedfile::open(const std::string& path) {
+    close();
+    
+    // paths are utf-8 throughout; the index is binary searched, so no sequential access hint
+    HANDLE handle = CreateFileW(utf8towide(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+    
+    LARGE_INTEGER filesize = {};
+    if (!GetFileSizeEx(handle, &filesize) || filesize.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+    
+    HANDLE section = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!section) {
+        CloseHandle(handle);
+        return false;
+    }
+    
+    view = static_cast<const uint8_t*>(MapViewOfFile(section, FILE_MAP_READ, 0, 0, 0));
+    if (!view) {
+        CloseHandle(section);
+        CloseHandle(handle);
+        return false;
+    }
+    
+    file = handle;
+    mapping = section;
+    length = (size_t)filesize.QuadPart;
+    return true;
+}
+
+void mappedfile::close() {
+    if (view) UnmapViewOfFile(view);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+    view = nullptr;
+    mapping = nullptr;
+    file = nullptr;
+    length = 0;
+}
+#else
+bool mappedfile::open(const std::string& path) {
+    close();
+    
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    void* address = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) return false;
+    
+    view = static_cast<const uint8_t*>(address);
+    length = (size_t)info.st_size;
+    return true;
+}
+
+void mappedfile::close() {
+    if (view) munmap(const_cast<uint8_t*>(view), length);
+    view = nullptr;
+    length = 0;
+}
+#endif
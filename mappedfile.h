@@ -0,0 +1,29 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+class mappedfile {
+public:
+    mappedfile() = default;
+    ~mappedfile();
+    
+    mappedfile(const mappedfile&) = delete;
+    mappedfile& operator=(const mappedfile&) = delete;
+    
+    // path is utf-8
+    bool open(const std::string& path);
+    void close();
+    
+    const uint8_t* data() const { return view; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* view = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
@@ -0,0 +1,309 @@
+#include "neighbor.h"
+#include "textutil.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2ipdef.h>
+#include <iphlpapi.h>
+#include <netioapi.h>
+
+#pragma comment(lib, "iphlpapi.lib")
+#else
+#include <net/if.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
+
+// netlink wire values, kept here so the decoder also builds where the linux headers do not exist
+static const uint16_t netlinkdone = 3;
+static const uint16_t netlinkerror = 2;
+static const uint16_t netlinknewneighbor = 28;
+static const uint16_t neighbordestination = 1;
+static const uint16_t neighborlinkaddress = 2;
+static const uint8_t linuxinet = 2;
+static const uint8_t linuxinet6 = 10;
+static const uint16_t nudincomplete = 0x01;
+static const uint16_t nudfailed = 0x20;
+static const uint16_t nudnoarp = 0x40;
+static const uint16_t nudpermanent = 0x80;
+
+static const size_t netlinkheadersize = 16;
+static const size_t neighbormessagesize = 12;
+
+static uint16_t readhost16(const uint8_t* p) {
+    uint16_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t readhost32(const uint8_t* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static size_t align4(size_t size) {
+    return (size + 3) & ~(size_t)3;
+}
+
+void neighbortable::clear() {
+    entries.clear();
+    names.clear();
+}
+
+void neighbortable::nameinterface(uint32_t index, std::string name) {
+    names[index] = std::move(name);
+}
+
+std::string_view neighbortable::interfacename(uint32_t index) const {
+    auto it = names.find(index);
+    return it != names.end() ? std::string_view(it->second) : std::string_view();
+}
+
+static bool neighborless(const neighborentry& a, const neighborentry& b) {
+    if (a.interfaceindex != b.interfaceindex) return a.interfaceindex < b.interfaceindex;
+    if (a.family != b.family) return a.family < b.family;
+    return memcmp(a.address, b.address, sizeof(a.address)) < 0;
+}
+
+void neighbortable::normalize() {
+    std::stable_sort(entries.begin(), entries.end(), neighborless);
+    
+    auto same = [](const neighborentry& a, const neighborentry& b) {
+        return a.interfaceindex == b.interfaceindex && a.family == b.family && memcmp(a.address, b.address, sizeof(a.address)) == 0;
+    };
+    entries.erase(std::unique(entries.begin(), entries.end(), same), entries.end());
+}
+
+bool neighbortable::operator==(const neighbortable& other) const {
+    auto same = [](const neighborentry& a, const neighborentry& b) {
+        return a.interfaceindex == b.interfaceindex && a.family == b.family && a.maclength == b.maclength && a.kind == b.kind &&
+            memcmp(a.address, b.address, sizeof(a.address)) == 0 && memcmp(a.mac, b.mac, sizeof(a.mac)) == 0;
+    };
+    return names == other.names && std::equal(entries.begin(), entries.end(), other.entries.begin(), other.entries.end(), same);
+}
+
+size_t formatneighboraddress(const neighborentry& entry, char* out, size_t capacity) {
+    if (capacity < 46) return 0;
+    return entry.family == 4 ? formatipv4text(entry.address, out, capacity) : formatipv6text(entry.address, out, capacity);
+}
+
+size_t formatneighbormac(const neighborentry& entry, char* out, size_t capacity) {
+    return formatmactext(entry.mac, std::min<size_t>(entry.maclength, sizeof(entry.mac)), out, capacity);
+}
+
+const char* neighborkindname(neighborkind kind) {
+    return kind == neighborkind::permanent ? "static" : "dynamic";
+}
+
+recordview neighborrecord(const neighbortable& table, const neighborentry& entry, neighbortext& text) {
+    size_t addresslength = formatneighboraddress(entry, text.address, sizeof(text.address));
+    size_t maclength = formatneighbormac(entry, text.mac, sizeof(text.mac));
+    
+    text.notes.assign(neighborkindname(entry.kind)).append("; adapter: ");
+    std::string_view name = table.interfacename(entry.interfaceindex);
+    if (!name.empty()) {
+        text.notes.append(name);
+    } else if (entry.interfaceindex == 0) {
+        text.notes.append("unknown");
+    } else {
+        text.notes.append("ifindex ").append(std::to_string(entry.interfaceindex));
+    }
+    
+    return {"arp", "arp", std::string_view(text.address, addresslength), std::string_view(text.mac, maclength), text.notes};
+}
+
+static bool usablemac(const uint8_t* mac, size_t length) {
+    if (length == 0) return false;
+    
+    bool zero = true;
+    bool broadcast = true;
+    for (size_t i = 0; i < length; i++) {
+        zero = zero && mac[i] == 0x00;
+        broadcast = broadcast && mac[i] == 0xFF;
+    }
+    return !zero && !broadcast;
+}
+
+static void decodeneighbor(const uint8_t* message, size_t size, neighbortable& table) {
+    if (size < neighbormessagesize) return;
+    
+    uint8_t family = message[0];
+    if (family != linuxinet && family != linuxinet6) return;
+    
+    uint16_t state = readhost16(message + 8);
+    if (state & (nudincomplete | nudfailed | nudnoarp)) return;
+    
+    neighborentry entry;
+    entry.interfaceindex = readhost32(message + 4);
+    entry.family = family == linuxinet ? 4 : 6;
+    entry.kind = (state & nudpermanent) ? neighborkind::permanent : neighborkind::dynamic;
+    
+    size_t addresslength = family == linuxinet ? 4 : 16;
+    bool hasaddress = false;
+    
+    size_t cursor = neighbormessagesize;
+    while (cursor + 4 <= size) {
+        uint16_t length = readhost16(message + cursor);
+        uint16_t type = readhost16(message + cursor + 2) & 0x3FFF;
+        if (length < 4 || cursor + length > size) break;
+        
+        const uint8_t* payload = message + cursor + 4;
+        size_t payloadsize = length - 4;
+        
+        if (type == neighbordestination && payloadsize == addresslength) {
+            memcpy(entry.address, payload, addresslength);
+            hasaddress = true;
+        } else if (type == neighborlinkaddress && payloadsize <= sizeof(entry.mac)) {
+            memcpy(entry.mac, payload, payloadsize);
+            entry.maclength = (uint8_t)payloadsize;
+        }
+        
+        cursor += align4(length);
+    }
+    
+    if (hasaddress && usablemac(entry.mac, entry.maclength)) table.add(entry);
+}
+
+bool decodeneighbormessages(const uint8_t* data, size_t size, neighbortable& table, bool& done) {
+    size_t cursor = 0;
+    while (cursor + netlinkheadersize <= size) {
+        uint32_t length = readhost32(data + cursor);
+        uint16_t type = readhost16(data + cursor + 4);
+        if (length < netlinkheadersize || cursor + length > size) return false;
+        
+        if (type == netlinkdone) {
+            done = true;
+            return true;
+        }
+        if (type == netlinkerror) return false;
+        
+        if (type == netlinknewneighbor) {
+            decodeneighbor(data + cursor + netlinkheadersize, length - netlinkheadersize, table);
+        }
+        
+        cursor += align4(length);
+    }
+    return true;
+}
+
+#ifdef _WIN32
+bool readneighbortable(neighbortable& table) {
+    PMIB_IPNET_TABLE2 rows = nullptr;
+    {
+        tracespan span("GetIpNetTable2");
+        if (!span.check(GetIpNetTable2(AF_UNSPEC, &rows) == NO_ERROR)) return false;
+        span.bytes(rows->NumEntries * sizeof(MIB_IPNET_ROW2));
+    }
+    
+    table.reserve(rows->NumEntries);
+    
+    for (ULONG i = 0; i < rows->NumEntries; i++) {
+        const MIB_IPNET_ROW2& row = rows->Table[i];
+        if (row.State == NlnsUnreachable || row.State == NlnsIncomplete || row.IsUnreachable) continue;
+        
+        size_t maclength = std::min<size_t>(row.PhysicalAddressLength, 8);
+        if (!usablemac(row.PhysicalAddress, maclength)) continue;
+        
+        neighborentry entry;
+        entry.interfaceindex = row.InterfaceIndex;
+        entry.maclength = (uint8_t)maclength;
+        memcpy(entry.mac, row.PhysicalAddress, maclength);
+        entry.kind = row.State == NlnsPermanent ? neighborkind::permanent : neighborkind::dynamic;
+        
+        if (row.Address.si_family == AF_INET) {
+            entry.family = 4;
+            memcpy(entry.address, &row.Address.Ipv4.sin_addr, 4);
+        } else if (row.Address.si_family == AF_INET6) {
+            entry.family = 6;
+            memcpy(entry.address, &row.Address.Ipv6.sin6_addr, 16);
+        } else {
+            continue;
+        }
+        
+        table.add(entry);
+    }
+    
+    FreeMibTable(rows);
+    
+    tracespan span("GetAdaptersAddresses");
+    ULONG buffersize = 0;
+    ULONG flags = GAA_FLAG_SKIP_UNICAST | GAA_FLAG_SKIP_ANYCAST | GAA_FLAG_SKIP_MULTICAST | GAA_FLAG_SKIP_DNS_SERVER;
+    if (GetAdaptersAddresses(AF_UNSPEC, flags, nullptr, nullptr, &buffersize) == ERROR_BUFFER_OVERFLOW && buffersize > 0) {
+        std::vector<BYTE> buffer(buffersize);
+        auto adapters = reinterpret_cast<PIP_ADAPTER_ADDRESSES>(buffer.data());
+        
+        if (span.check(GetAdaptersAddresses(AF_UNSPEC, flags, nullptr, adapters, &buffersize) == NO_ERROR)) {
+            span.bytes(buffersize);
+            for (auto current = adapters; current; current = current->Next) {
+                std::string description = widetoutf8(current->Description);
+                asciilower(description);
+                if (current->IfIndex) table.nameinterface(current->IfIndex, description);
+                if (current->Ipv6IfIndex) table.nameinterface(current->Ipv6IfIndex, description);
+            }
+        }
+    }
+    
+    table.normalize();
+    return true;
+}
+#else
+bool readneighbortable(neighbortable& table) {
+    tracespan span("RTM_GETNEIGH dump");
+    int sock = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (!span.check(sock >= 0)) return false;
+    
+    struct {
+        nlmsghdr header;
+        ndmsg message;
+    } request = {};
+    request.header.nlmsg_len = sizeof(request);
+    request.header.nlmsg_type = RTM_GETNEIGH;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = 1;
+    request.message.ndm_family = AF_UNSPEC;
+    
+    if (send(sock, &request, sizeof(request), 0) != (ssize_t)sizeof(request)) {
+        span.fail();
+        close(sock);
+        return false;
+    }
+    
+    std::vector<uint8_t> buffer(1 << 16);
+    bool done = false;
+    bool ok = true;
+    
+    while (!done && ok) {
+        ssize_t received = recv(sock, buffer.data(), buffer.size(), 0);
+        if (received <= 0) {
+            ok = false;
+            break;
+        }
+        span.bytes((size_t)received);
+        ok = decodeneighbormessages(buffer.data(), (size_t)received, table, done);
+    }
+    
+    close(sock);
+    if (!span.check(ok)) return false;
+    
+    table.normalize();
+    
+    uint32_t last = 0;
+    for (const auto& entry : table.records()) {
+        if (entry.interfaceindex == last) continue;
+        last = entry.interfaceindex;
+        
+        char name[IF_NAMESIZE] = {};
+        if (if_indextoname(entry.interfaceindex, name)) {
+            table.nameinterface(entry.interfaceindex, name);
+        }
+    }
+    
+    return true;
+}
+#endif
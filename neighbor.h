@@ -0,0 +1,61 @@
+#pragma once
+
+#include "recordstore.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class neighborkind : uint8_t {
+    dynamic,
+    permanent
+};
+
+struct neighborentry {
+    uint32_t interfaceindex = 0;
+    uint8_t address[16] = {};
+    uint8_t mac[8] = {};
+    uint8_t family = 4;
+    uint8_t maclength = 0;
+    neighborkind kind = neighborkind::dynamic;
+};
+
+class neighbortable {
+public:
+    void add(const neighborentry& entry) { entries.push_back(entry); }
+    void reserve(size_t count) { entries.reserve(count); }
+    void clear();
+    
+    // names are utf-8; an interface nothing named comes back empty
+    void nameinterface(uint32_t index, std::string name);
+    std::string_view interfacename(uint32_t index) const;
+    
+    void normalize();
+    bool operator==(const neighbortable& other) const;
+    
+    const std::vector<neighborentry>& records() const { return entries; }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+private:
+    std::vector<neighborentry> entries;
+    std::map<uint32_t, std::string> names;
+};
+
+size_t formatneighboraddress(const neighborentry& entry, char* out, size_t capacity);
+size_t formatneighbormac(const neighborentry& entry, char* out, size_t capacity);
+const char* neighborkindname(neighborkind kind);
+
+// the arp record an entry is shown and written as, formatted into text; the views last until text is reused
+struct neighbortext {
+    char address[48];
+    char mac[32];
+    std::string notes;
+};
+
+recordview neighborrecord(const neighbortable& table, const neighborentry& entry, neighbortext& text);
+
+bool decodeneighbormessages(const uint8_t* data, size_t size, neighbortable& table, bool& done);
+bool readneighbortable(neighbortable& table);
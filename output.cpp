@@ -0,0 +1,139 @@
+#include "output.h"
+
+void writejsonstring(std::ostream& out, std::string_view value) {
+    static const char hex[] = "0123456789abcdef";
+    
+    out << '"';
+    for (unsigned char c : value) {
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\b': out << "\\b"; break;
+            case '\f': out << "\\f"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    out << "\\u00" << hex[c >> 4] << hex[c & 0xF];
+                } else {
+                    out << (char)c;
+                }
+                break;
+        }
+    }
+    out << '"';
+}
+
+static void writejsonitem(std::ostream& out, const recordview& record) {
+    out << "{\"section\":";
+    writejsonstring(out, record.section);
+    out << ",\"category\":";
+    writejsonstring(out, record.category);
+    out << ",\"name\":";
+    writejsonstring(out, record.name);
+    out << ",\"value\":";
+    writejsonstring(out, record.value);
+    out << ",\"notes\":";
+    writejsonstring(out, record.notes);
+    out << '}';
+}
+
+void writecsvfield(std::ostream& out, std::string_view value) {
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        out << value;
+        return;
+    }
+    
+    out << '"';
+    for (char c : value) {
+        if (c == '"') out << '"';
+        out << c;
+    }
+    out << '"';
+}
+
+class jsonwriter : public resultwriter {
+public:
+    using resultwriter::resultwriter;
+    
+    void begin() override {
+        out << "[";
+    }
+    
+    void writerecord(const recordview& record) override {
+        out << (first ? "\n  " : ",\n  ");
+        first = false;
+        writejsonitem(out, record);
+    }
+    
+    void end() override {
+        out << (first ? "]\n" : "\n]\n");
+        out.flush();
+    }
+
+private:
+    bool first = true;
+};
+
+class ndjsonwriter : public resultwriter {
+public:
+    using resultwriter::resultwriter;
+    
+    void writerecord(const recordview& record) override {
+        writejsonitem(out, record);
+        out << '\n';
+    }
+    
+    void end() override {
+        out.flush();
+    }
+};
+
+class csvwriter : public resultwriter {
+public:
+    using resultwriter::resultwriter;
+    
+    void begin() override {
+        out << "section,category,name,value,notes\r\n";
+    }
+    
+    void writerecord(const recordview& record) override {
+        writecsvfield(out, record.section);
+        out << ',';
+        writecsvfield(out, record.category);
+        out << ',';
+        writecsvfield(out, record.name);
+        out << ',';
+        writecsvfield(out, record.value);
+        out << ',';
+        writecsvfield(out, record.notes);
+        out << "\r\n";
+    }
+    
+    void end() override {
+        out.flush();
+    }
+};
+
+bool parseoutputformat(const std::string& name, outputformat& format) {
+    if (name == "json") {
+        format = outputformat::json;
+    } else if (name == "ndjson") {
+        format = outputformat::ndjson;
+    } else if (name == "csv") {
+        format = outputformat::csv;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<resultwriter> createresultwriter(outputformat format, std::ostream& out) {
+    switch (format) {
+        case outputformat::json: return std::make_unique<jsonwriter>(out);
+        case outputformat::ndjson: return std::make_unique<ndjsonwriter>(out);
+        case outputformat::csv: return std::make_unique<csvwriter>(out);
+    }
+    return nullptr;
+}
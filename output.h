@@ -0,0 +1,33 @@
+#pragma once
+
+#include "recordstore.h"
+#include <ostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+enum class outputformat {
+    json,
+    ndjson,
+    csv
+};
+
+bool parseoutputformat(const std::string& name, outputformat& format);
+
+void writejsonstring(std::ostream& out, std::string_view value);
+void writecsvfield(std::ostream& out, std::string_view value);
+
+class resultwriter {
+public:
+    explicit resultwriter(std::ostream& out) : out(out) {}
+    virtual ~resultwriter() = default;
+    
+    virtual void begin() {}
+    virtual void writerecord(const recordview& record) = 0;
+    virtual void end() {}
+
+protected:
+    std::ostream& out;
+};
+
+std::unique_ptr<resultwriter> createresultwriter(outputformat format, std::ostream& out);
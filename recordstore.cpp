@@ -0,0 +1,71 @@
+#include "recordstore.h"
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+char* recordstore::allocate(size_t size) {
+    if (size > remaining) {
+        size_t blocksize = std::max<size_t>(size, std::min<size_t>(std::max<size_t>(reserved, 4096), 1 << 20));
+        blocks.push_back(std::make_unique<char[]>(blocksize));
+        cursor = blocks.back().get();
+        remaining = blocksize;
+        reserved += blocksize;
+    }
+    
+    char* result = cursor;
+    cursor += size;
+    remaining -= size;
+    return result;
+}
+
+std::string_view recordstore::copy(std::string_view text) {
+    if (text.empty()) return {};
+    
+    char* target = allocate(text.size());
+    memcpy(target, text.data(), text.size());
+    return std::string_view(target, text.size());
+}
+
+void recordstore::growslots() {
+    std::vector<std::string_view> previous(std::max<size_t>(slots.size() * 2, 64));
+    previous.swap(slots);
+    
+    size_t mask = slots.size() - 1;
+    for (const auto& text : previous) {
+        if (text.empty()) continue;
+        size_t slot = std::hash<std::string_view>()(text) & mask;
+        while (!slots[slot].empty()) slot = (slot + 1) & mask;
+        slots[slot] = text;
+    }
+}
+
+std::string_view recordstore::intern(std::string_view text) {
+    if (text.empty()) return {};
+    
+    if ((internedused + 1) * 2 > slots.size()) growslots();
+    
+    size_t mask = slots.size() - 1;
+    size_t slot = std::hash<std::string_view>()(text) & mask;
+    while (!slots[slot].empty()) {
+        if (slots[slot] == text) return slots[slot];
+        slot = (slot + 1) & mask;
+    }
+    
+    slots[slot] = copy(text);
+    internedused++;
+    return slots[slot];
+}
+
+void recordstore::add(std::string_view section, std::string_view category, std::string_view name, std::string_view value, std::string_view notes) {
+    entries.push_back({intern(section), intern(category), intern(name), copy(value), intern(notes)});
+}
+
+void recordstore::clear() {
+    entries.clear();
+    slots = std::vector<std::string_view>();
+    internedused = 0;
+    blocks.clear();
+    cursor = nullptr;
+    remaining = 0;
+    reserved = 0;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct recordview {
+    std::string_view section;
+    std::string_view category;
+    std::string_view name;
+    std::string_view value;
+    std::string_view notes;
+};
+
+class recordstore {
+public:
+    recordstore() = default;
+    recordstore(recordstore&&) = default;
+    recordstore& operator=(recordstore&&) = default;
+    
+    recordstore(const recordstore&) = delete;
+    recordstore& operator=(const recordstore&) = delete;
+    
+    void add(std::string_view section, std::string_view category, std::string_view name, std::string_view value, std::string_view notes);
+    void add(const recordview& record) { add(record.section, record.category, record.name, record.value, record.notes); }
+    void push(const recordview& record) { entries.push_back(record); }
+    
+    std::string_view intern(std::string_view text);
+    std::string_view copy(std::string_view text);
+    
+    void reserve(size_t count) { entries.reserve(count); }
+    void clear();
+    
+    const std::vector<recordview>& records() const { return entries; }
+    const recordview& operator[](size_t index) const { return entries[index]; }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    
+    size_t arenabytes() const { return reserved; }
+    size_t internedcount() const { return internedused; }
+
+private:
+    char* allocate(size_t size);
+    void growslots();
+    
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t reserved = 0;
+    
+    std::vector<std::string_view> slots;
+    size_t internedused = 0;
+    std::vector<recordview> entries;
+};
@@ -0,0 +1,405 @@
+#include "registry.h"
+#include "textutil.h"
+#include "trace.h"
+#include <cstring>
+#include <cwctype>
+
+void decoderegistryvalue(uint32_t type, const uint8_t* data, size_t size, registryvalue& value) {
+    value = registryvalue();
+    
+    if (type == 1 || type == 2) {
+        value.type = registryvaluetype::string;
+        value.text.reserve(size / 2);
+        
+        for (size_t i = 0; i + 1 < size; i += 2) {
+            uint32_t unit = (uint32_t)data[i] | ((uint32_t)data[i + 1] << 8);
+            if (sizeof(wchar_t) == 4 && unit >= 0xD800 && unit < 0xDC00 && i + 3 < size) {
+                uint32_t low = (uint32_t)data[i + 2] | ((uint32_t)data[i + 3] << 8);
+                if (low >= 0xDC00 && low < 0xE000) {
+                    unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                    i += 2;
+                }
+            }
+            value.text += (wchar_t)unit;
+        }
+        
+        while (!value.text.empty() && value.text.back() == 0) value.text.pop_back();
+    } else if (type == 4 && size >= 4) {
+        value.type = registryvaluetype::dword;
+        value.number = (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+    } else {
+        value.type = registryvaluetype::binary;
+        value.data.assign(data, data + size);
+    }
+}
+
+#ifdef _WIN32
+#include <windows.h>
+
+static HKEY tohkey(registrykey key) {
+    return key == registryroot ? HKEY_LOCAL_MACHINE : reinterpret_cast<HKEY>(key);
+}
+
+class win32registryprovider : public registryprovider {
+public:
+    bool openkey(registrykey parent, const std::wstring& path, registrykey& key) override;
+    void closekey(registrykey key) override;
+    bool enumeratesubkeys(registrykey key, std::vector<std::wstring>& names) override;
+    bool queryvalue(registrykey key, const std::wstring& name, registryvalue& value) override;
+    bool queryvalues(registrykey key, const std::vector<std::wstring>& names, std::vector<registryvalue>& values) override;
+
+private:
+    std::vector<BYTE> scratch = std::vector<BYTE>(4096);
+};
+
+bool win32registryprovider::openkey(registrykey parent, const std::wstring& path, registrykey& key) {
+    calls.opens++;
+    tracespan span("RegOpenKeyExW");
+    
+    HKEY result;
+    if (RegOpenKeyExW(tohkey(parent), path.c_str(), 0, KEY_READ, &result) != ERROR_SUCCESS) {
+        span.fail();
+        return false;
+    }
+    
+    key = reinterpret_cast<registrykey>(result);
+    return true;
+}
+
+void win32registryprovider::closekey(registrykey key) {
+    if (key == registryroot) return;
+    calls.closes++;
+    RegCloseKey(tohkey(key));
+}
+
+bool win32registryprovider::enumeratesubkeys(registrykey key, std::vector<std::wstring>& names) {
+    HKEY hkey = tohkey(key);
+    DWORD count = 0;
+    DWORD maxlength = 0;
+    
+    calls.enumerations++;
+    tracespan span("RegEnumKeyExW");
+    if (RegQueryInfoKeyW(hkey, nullptr, nullptr, nullptr, &count, &maxlength, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr) != ERROR_SUCCESS) {
+        span.fail();
+        return false;
+    }
+    
+    std::vector<wchar_t> name(maxlength + 1);
+    names.reserve(names.size() + count);
+    
+    for (DWORD i = 0; i < count; i++) {
+        DWORD size = (DWORD)name.size();
+        calls.enumerations++;
+        LSTATUS status = RegEnumKeyExW(hkey, i, name.data(), &size, nullptr, nullptr, nullptr, nullptr);
+        if (status == ERROR_NO_MORE_ITEMS) break;
+        if (status != ERROR_SUCCESS) continue;
+        names.emplace_back(name.data(), size);
+    }
+    
+    return true;
+}
+
+bool win32registryprovider::queryvalue(registrykey key, const std::wstring& name, registryvalue& value) {
+    DWORD type = 0;
+    DWORD size = (DWORD)scratch.size();
+    
+    calls.queries++;
+    tracespan span("RegQueryValueExW");
+    LSTATUS status = RegQueryValueExW(tohkey(key), name.c_str(), nullptr, &type, scratch.data(), &size);
+    
+    if (status == ERROR_MORE_DATA) {
+        scratch.resize(size);
+        calls.queries++;
+        status = RegQueryValueExW(tohkey(key), name.c_str(), nullptr, &type, scratch.data(), &size);
+    }
+    
+    if (!span.check(status == ERROR_SUCCESS)) return false;
+    
+    span.bytes(size);
+    decoderegistryvalue(type, scratch.data(), size, value);
+    return true;
+}
+
+bool win32registryprovider::queryvalues(registrykey key, const std::vector<std::wstring>& names, std::vector<registryvalue>& values) {
+    if (names.size() < 2) return registryprovider::queryvalues(key, names, values);
+    
+    std::vector<VALENTW> entries(names.size());
+    for (size_t i = 0; i < names.size(); i++) {
+        entries[i] = {};
+        entries[i].ve_valuename = const_cast<LPWSTR>(names[i].c_str());
+    }
+    
+    DWORD size = (DWORD)scratch.size();
+    calls.queries++;
+    tracespan span("RegQueryMultipleValuesW");
+    LSTATUS status = RegQueryMultipleValuesW(tohkey(key), entries.data(), (DWORD)entries.size(), reinterpret_cast<LPWSTR>(scratch.data()), &size);
+    
+    if (status == ERROR_MORE_DATA) {
+        scratch.resize(size);
+        calls.queries++;
+        status = RegQueryMultipleValuesW(tohkey(key), entries.data(), (DWORD)entries.size(), reinterpret_cast<LPWSTR>(scratch.data()), &size);
+    }
+    
+    // the batched call fails as a whole when any one value is missing
+    if (!span.check(status == ERROR_SUCCESS)) return registryprovider::queryvalues(key, names, values);
+    
+    span.bytes(size);
+    values.assign(names.size(), registryvalue());
+    for (size_t i = 0; i < entries.size(); i++) {
+        decoderegistryvalue(entries[i].ve_type, reinterpret_cast<const BYTE*>(entries[i].ve_valueptr), entries[i].ve_valuelen, values[i]);
+    }
+    return true;
+}
+#endif
+
+static std::wstring lowercase(const std::wstring& value) {
+    std::wstring result(value);
+    for (auto& c : result) c = (wchar_t)towlower(c);
+    return result;
+}
+
+bool registryprovider::queryvalues(registrykey key, const std::vector<std::wstring>& names, std::vector<registryvalue>& values) {
+    values.assign(names.size(), registryvalue());
+    for (size_t i = 0; i < names.size(); i++) {
+        if (!queryvalue(key, names[i], values[i])) values[i] = registryvalue();
+    }
+    return true;
+}
+
+fakeregistry::fakeregistry() : nodes(1) {
+}
+
+size_t fakeregistry::find(size_t start, const std::wstring& path, bool create) {
+    size_t current = start;
+    size_t begin = 0;
+    
+    while (begin <= path.size() && current != (size_t)-1) {
+        size_t end = path.find(L'\\', begin);
+        if (end == std::wstring::npos) end = path.size();
+        
+        std::wstring part = path.substr(begin, end - begin);
+        begin = end + 1;
+        if (part.empty()) continue;
+        
+        std::wstring folded = lowercase(part);
+        auto it = nodes[current].index.find(folded);
+        if (it != nodes[current].index.end()) {
+            current = it->second;
+        } else if (create) {
+            size_t child = nodes.size();
+            nodes.push_back(node());
+            nodes[child].name = part;
+            nodes[current].index[folded] = child;
+            nodes[current].children.push_back(child);
+            current = child;
+        } else {
+            current = (size_t)-1;
+        }
+    }
+    
+    return current;
+}
+
+registryvalue& fakeregistry::slot(const std::wstring& path, const std::wstring& name) {
+    return nodes[find(0, path, true)].values[lowercase(name)];
+}
+
+void fakeregistry::addkey(const std::wstring& path) {
+    find(0, path, true);
+}
+
+void fakeregistry::setstring(const std::wstring& path, const std::wstring& name, const std::wstring& value) {
+    registryvalue& target = slot(path, name);
+    target = registryvalue();
+    target.type = registryvaluetype::string;
+    target.text = value;
+}
+
+void fakeregistry::setdword(const std::wstring& path, const std::wstring& name, uint32_t value) {
+    registryvalue& target = slot(path, name);
+    target = registryvalue();
+    target.type = registryvaluetype::dword;
+    target.number = value;
+}
+
+void fakeregistry::setbinary(const std::wstring& path, const std::wstring& name, const std::vector<uint8_t>& value) {
+    registryvalue& target = slot(path, name);
+    target = registryvalue();
+    target.type = registryvaluetype::binary;
+    target.data = value;
+}
+
+bool fakeregistry::openkey(registrykey parent, const std::wstring& path, registrykey& key) {
+    calls.opens++;
+    if (parent >= nodes.size()) return false;
+    
+    size_t found = find(parent, path, false);
+    if (found == (size_t)-1) return false;
+    
+    key = found;
+    return true;
+}
+
+void fakeregistry::closekey(registrykey key) {
+    if (key == registryroot) return;
+    calls.closes++;
+}
+
+bool fakeregistry::enumeratesubkeys(registrykey key, std::vector<std::wstring>& names) {
+    calls.enumerations++;
+    if (key >= nodes.size()) return false;
+    
+    for (size_t child : nodes[key].children) {
+        calls.enumerations++;
+        names.push_back(nodes[child].name);
+    }
+    return true;
+}
+
+bool fakeregistry::queryvalues(registrykey key, const std::vector<std::wstring>& names, std::vector<registryvalue>& values) {
+    if (names.size() < 2 || key >= nodes.size()) return registryprovider::queryvalues(key, names, values);
+    
+    calls.queries++;
+    values.assign(names.size(), registryvalue());
+    for (size_t i = 0; i < names.size(); i++) {
+        auto it = nodes[key].values.find(lowercase(names[i]));
+        if (it == nodes[key].values.end()) return registryprovider::queryvalues(key, names, values);
+        values[i] = it->second;
+    }
+    return true;
+}
+
+bool fakeregistry::queryvalue(registrykey key, const std::wstring& name, registryvalue& value) {
+    calls.queries++;
+    if (key >= nodes.size()) return false;
+    
+    auto it = nodes[key].values.find(lowercase(name));
+    if (it == nodes[key].values.end()) return false;
+    
+    value = it->second;
+    return true;
+}
+
+std::unique_ptr<registryprovider> createdefaultregistryprovider() {
+#ifdef _WIN32
+    return std::make_unique<win32registryprovider>();
+#else
+    return nullptr;
+#endif
+}
+
+registrysession::registrysession(std::unique_ptr<registryprovider> provider) : provider(std::move(provider)) {
+    if (!this->provider) this->provider = createdefaultregistryprovider();
+}
+
+registrysession::~registrysession() {
+    reset();
+}
+
+bool registrysession::open(const std::wstring& path, registrykey& key) {
+    std::wstring folded = lowercase(path);
+    
+    auto it = handles.find(folded);
+    if (it != handles.end()) {
+        key = it->second;
+        return true;
+    }
+    
+    if (!provider || absent.count(folded)) return false;
+    
+    registrykey parent = registryroot;
+    std::wstring relative = path;
+    
+    size_t split = folded.rfind(L'\\');
+    if (split != std::wstring::npos) {
+        auto cached = handles.find(folded.substr(0, split));
+        if (cached != handles.end()) {
+            parent = cached->second;
+            relative = path.substr(split + 1);
+        }
+    }
+    
+    if (!provider->openkey(parent, relative, key)) {
+        absent.insert(folded);
+        return false;
+    }
+    
+    handles[folded] = key;
+    return true;
+}
+
+bool registrysession::subkeys(const std::wstring& path, std::vector<std::wstring>& names) {
+    std::lock_guard<std::mutex> guard(lock);
+    
+    registrykey key;
+    return open(path, key) && provider->enumeratesubkeys(key, names);
+}
+
+std::vector<registryvalue> registrysession::getvalues(const std::wstring& path, const std::vector<std::wstring>& names) {
+    std::lock_guard<std::mutex> guard(lock);
+    
+    std::map<std::wstring, registryvalue>& cached = cache[lowercase(path)];
+    
+    std::vector<std::wstring> folded;
+    std::vector<std::wstring> missing;
+    folded.reserve(names.size());
+    for (const auto& name : names) {
+        folded.push_back(lowercase(name));
+        if (cached.find(folded.back()) == cached.end()) missing.push_back(name);
+    }
+    
+    if (!missing.empty()) {
+        std::vector<registryvalue> values;
+        registrykey key;
+        if (open(path, key)) provider->queryvalues(key, missing, values);
+        values.resize(missing.size());
+        
+        for (size_t i = 0; i < missing.size(); i++) {
+            cached[lowercase(missing[i])] = std::move(values[i]);
+        }
+    }
+    
+    std::vector<registryvalue> result;
+    result.reserve(names.size());
+    for (const auto& name : folded) {
+        result.push_back(cached[name]);
+    }
+    return result;
+}
+
+std::wstring registrystring(const registryvalue& value) {
+    if (value.type != registryvaluetype::string) return L"n/a";
+    
+    return std::wstring(trimascii(value.text));
+}
+
+std::wstring registrysession::getstring(const std::wstring& path, const std::wstring& name) {
+    return registrystring(getvalues(path, {name})[0]);
+}
+
+uint32_t registrysession::getdword(const std::wstring& path, const std::wstring& name) {
+    registryvalue value = std::move(getvalues(path, {name})[0]);
+    return value.type == registryvaluetype::dword ? value.number : 0;
+}
+
+std::vector<uint8_t> registrysession::getbinary(const std::wstring& path, const std::wstring& name) {
+    registryvalue value = std::move(getvalues(path, {name})[0]);
+    return value.type == registryvaluetype::binary ? std::move(value.data) : std::vector<uint8_t>();
+}
+
+void registrysession::reset() {
+    std::lock_guard<std::mutex> guard(lock);
+    
+    for (const auto& handle : handles) {
+        provider->closekey(handle.second);
+    }
+    
+    handles.clear();
+    absent.clear();
+    cache.clear();
+}
+
+registrystats registrysession::stats() {
+    std::lock_guard<std::mutex> guard(lock);
+    return provider ? provider->stats() : registrystats();
+}
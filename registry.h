@@ -0,0 +1,115 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+
+typedef uintptr_t registrykey;
+
+const registrykey registryroot = 0;
+
+enum class registryvaluetype {
+    none,
+    string,
+    dword,
+    binary
+};
+
+struct registryvalue {
+    registryvaluetype type = registryvaluetype::none;
+    std::wstring text;
+    uint32_t number = 0;
+    std::vector<uint8_t> data;
+};
+
+struct registrystats {
+    size_t opens = 0;
+    size_t closes = 0;
+    size_t enumerations = 0;
+    size_t queries = 0;
+    
+    size_t total() const { return opens + closes + enumerations + queries; }
+};
+
+class registryprovider {
+public:
+    virtual ~registryprovider() = default;
+    
+    virtual bool openkey(registrykey parent, const std::wstring& path, registrykey& key) = 0;
+    virtual void closekey(registrykey key) = 0;
+    virtual bool enumeratesubkeys(registrykey key, std::vector<std::wstring>& names) = 0;
+    virtual bool queryvalue(registrykey key, const std::wstring& name, registryvalue& value) = 0;
+    virtual bool queryvalues(registrykey key, const std::vector<std::wstring>& names, std::vector<registryvalue>& values);
+    
+    const registrystats& stats() const { return calls; }
+
+protected:
+    registrystats calls;
+};
+
+class fakeregistry : public registryprovider {
+public:
+    fakeregistry();
+    
+    void addkey(const std::wstring& path);
+    void setstring(const std::wstring& path, const std::wstring& name, const std::wstring& value);
+    void setdword(const std::wstring& path, const std::wstring& name, uint32_t value);
+    void setbinary(const std::wstring& path, const std::wstring& name, const std::vector<uint8_t>& value);
+    
+    bool openkey(registrykey parent, const std::wstring& path, registrykey& key) override;
+    void closekey(registrykey key) override;
+    bool enumeratesubkeys(registrykey key, std::vector<std::wstring>& names) override;
+    bool queryvalue(registrykey key, const std::wstring& name, registryvalue& value) override;
+    bool queryvalues(registrykey key, const std::vector<std::wstring>& names, std::vector<registryvalue>& values) override;
+
+private:
+    struct node {
+        std::wstring name;
+        std::vector<size_t> children;
+        std::map<std::wstring, size_t> index;
+        std::map<std::wstring, registryvalue> values;
+    };
+    
+    size_t find(size_t start, const std::wstring& path, bool create);
+    registryvalue& slot(const std::wstring& path, const std::wstring& name);
+    
+    std::vector<node> nodes;
+};
+
+std::unique_ptr<registryprovider> createdefaultregistryprovider();
+
+std::wstring registrystring(const registryvalue& value);
+void decoderegistryvalue(uint32_t type, const uint8_t* data, size_t size, registryvalue& value);
+
+class registrysession {
+public:
+    explicit registrysession(std::unique_ptr<registryprovider> provider = nullptr);
+    ~registrysession();
+    
+    registrysession(const registrysession&) = delete;
+    registrysession& operator=(const registrysession&) = delete;
+    
+    bool available() const { return provider != nullptr; }
+    
+    bool subkeys(const std::wstring& path, std::vector<std::wstring>& names);
+    std::vector<registryvalue> getvalues(const std::wstring& path, const std::vector<std::wstring>& names);
+    std::wstring getstring(const std::wstring& path, const std::wstring& name);
+    uint32_t getdword(const std::wstring& path, const std::wstring& name);
+    std::vector<uint8_t> getbinary(const std::wstring& path, const std::wstring& name);
+    
+    void reset();
+    registrystats stats();
+
+private:
+    bool open(const std::wstring& path, registrykey& key);
+    
+    std::mutex lock;
+    std::unique_ptr<registryprovider> provider;
+    std::map<std::wstring, registrykey> handles;
+    std::set<std::wstring> absent;
+    std::map<std::wstring, std::map<std::wstring, registryvalue>> cache;
+};
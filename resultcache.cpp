@@ -0,0 +1,227 @@
+#include "resultcache.h"
+#include "snapshot.h"
+#include "sysfs.h"
+#include "textutil.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <cfgmgr32.h>
+#include <iphlpapi.h>
+
+#pragma comment(lib, "cfgmgr32.lib")
+#pragma comment(lib, "iphlpapi.lib")
+#endif
+
+// tokens ride along in the snapshot under a section no collector uses
+static const char* tokensection = "cache-token";
+
+bool resultcache::load(const std::string& path) {
+    categories.clear();
+    timestamp = 0;
+    
+    snapshot stored;
+    if (!stored.load(path)) return false;
+    
+    for (const auto& record : stored.records().records()) {
+        if (record.section == tokensection) {
+            categories[std::string(record.name)].token = std::string(record.value);
+        } else {
+            categories[std::string(record.section)].items.add(record);
+        }
+    }
+    
+    for (auto it = categories.begin(); it != categories.end();) {
+        it = it->second.token.empty() ? categories.erase(it) : std::next(it);
+    }
+    
+    timestamp = stored.timestamp;
+    return true;
+}
+
+bool resultcache::save(const std::string& path) const {
+    snapshot stored;
+    stored.timestamp = (uint64_t)std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    
+    for (const auto& [key, category] : categories) {
+        stored.add({tokensection, "", key, category.token, ""});
+        for (const auto& record : category.items.records()) {
+            stored.add(record);
+        }
+    }
+    
+    std::error_code ec;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), ec);
+    
+    std::string partial = path + ".partial";
+    if (!stored.save(partial)) return false;
+    
+    std::filesystem::rename(partial, target, ec);
+    if (ec) {
+        std::filesystem::remove(partial, ec);
+        return false;
+    }
+    return true;
+}
+
+const cachedcategory* resultcache::find(const std::string& key) const {
+    auto it = categories.find(key);
+    return it == categories.end() ? nullptr : &it->second;
+}
+
+void resultcache::store(const std::string& key, const std::string& token, const recordstore& items) {
+    if (token.empty()) {
+        categories.erase(key);
+        return;
+    }
+    
+    cachedcategory& category = categories[key];
+    category.token = token;
+    category.items.clear();
+    for (const auto& record : items.records()) category.items.add(record);
+}
+
+std::string defaultcachepath() {
+#ifdef _WIN32
+    const char* base = getenv("LOCALAPPDATA");
+    if (!base || !*base) return "";
+    return std::string(base) + "\\ud\\results.snap";
+#else
+    const char* xdg = getenv("XDG_CACHE_HOME");
+    if (xdg && *xdg) return std::string(xdg) + "/ud/results.snap";
+    
+    const char* home = getenv("HOME");
+    if (!home || !*home) return "";
+    return std::string(home) + "/.cache/ud/results.snap";
+#endif
+}
+
+class tokenhash {
+public:
+    void add(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < size; i++) {
+            value = (value ^ bytes[i]) * 0x100000001B3ull;
+        }
+        // keep field boundaries distinct
+        value = (value ^ 0xFF) * 0x100000001B3ull;
+    }
+    
+    void add(const std::string& text) { add(text.data(), text.size()); }
+    
+    std::string text() const {
+        uint8_t bytes[8];
+        for (int i = 0; i < 8; i++) bytes[i] = (uint8_t)(value >> (56 - i * 8));
+        char hex[17];
+        hexencode(bytes, sizeof(bytes), hex, sizeof(hex), false);
+        return hex;
+    }
+
+private:
+    uint64_t value = 0xCBF29CE484222325ull;
+};
+
+#ifdef _WIN32
+static std::string bootid() {
+    // boot time to the minute; a boundary straddle only costs one cold scan
+    ULONGLONG uptime = GetTickCount64();
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    ULONGLONG current = ((ULONGLONG)now.dwHighDateTime << 32) | now.dwLowDateTime;
+    return std::to_string((current / 10000 - uptime) / 60000);
+}
+
+static void adddevicelist(tokenhash& hash, const wchar_t* enumerator) {
+    ULONG flags = CM_GETIDLIST_FILTER_ENUMERATOR | CM_GETIDLIST_FILTER_PRESENT;
+    ULONG length = 0;
+    if (CM_Get_Device_ID_List_SizeW(&length, enumerator, flags) != CR_SUCCESS || length == 0) return;
+    
+    std::vector<wchar_t> list(length);
+    if (CM_Get_Device_ID_ListW(enumerator, list.data(), length, flags) != CR_SUCCESS) return;
+    hash.add(list.data(), list.size() * sizeof(wchar_t));
+}
+
+static void adddiskinterfaces(tokenhash& hash) {
+    static GUID diskinterface = {0x53F56307, 0xB6BF, 0x11D0, {0x94, 0xF2, 0x00, 0xA0, 0xC9, 0x1E, 0xFB, 0x8B}};
+    
+    ULONG length = 0;
+    if (CM_Get_Device_Interface_List_SizeW(&length, &diskinterface, nullptr, CM_GET_DEVICE_INTERFACE_LIST_PRESENT) != CR_SUCCESS || length == 0) return;
+    
+    std::vector<wchar_t> list(length);
+    if (CM_Get_Device_Interface_ListW(&diskinterface, nullptr, list.data(), length, CM_GET_DEVICE_INTERFACE_LIST_PRESENT) != CR_SUCCESS) return;
+    hash.add(list.data(), list.size() * sizeof(wchar_t));
+}
+
+static void addsmbios(tokenhash& hash) {
+    DWORD size = GetSystemFirmwareTable('RSMB', 0, nullptr, 0);
+    if (size == 0) return;
+    
+    std::vector<BYTE> table(size);
+    if (GetSystemFirmwareTable('RSMB', 0, table.data(), size) == size) hash.add(table.data(), table.size());
+}
+
+static void addadapteraddresses(tokenhash& hash) {
+    ULONG size = 0;
+    if (GetAdaptersInfo(nullptr, &size) != ERROR_BUFFER_OVERFLOW || size == 0) return;
+    
+    std::vector<BYTE> buffer(size);
+    auto adapters = reinterpret_cast<PIP_ADAPTER_INFO>(buffer.data());
+    if (GetAdaptersInfo(adapters, &size) != ERROR_SUCCESS) return;
+    
+    for (auto current = adapters; current; current = current->Next) {
+        hash.add(current->Address, current->AddressLength);
+    }
+}
+
+std::string cachetoken(const std::string& key) {
+    tokenhash hash;
+    hash.add(key);
+    hash.add(bootid());
+    
+    if (key == "bios") addsmbios(hash);
+    else if (key == "disk") adddiskinterfaces(hash);
+    else if (key == "monitor") adddevicelist(hash, L"DISPLAY");
+    else if (key == "nic") addadapteraddresses(hash);
+    else if (key == "usb") {
+        adddevicelist(hash, L"USB");
+        adddevicelist(hash, L"USBSTOR");
+    } else if (key != "cpu" && key != "gpu") {
+        return "";
+    }
+    
+    return hash.text();
+}
+#else
+static void addfiles(tokenhash& hash, const std::string& directory, const char* file) {
+    for (const auto& entry : listsysfsdirectory(directory)) {
+        hash.add(entry);
+        if (file) hash.add(readsysfsstring(directory + "/" + entry + "/" + file));
+    }
+}
+
+std::string cachetoken(const std::string& key) {
+    tokenhash hash;
+    hash.add(key);
+    hash.add(readsysfsstring("/proc/sys/kernel/random/boot_id"));
+    
+    if (key == "bios") {
+        std::vector<uint8_t> table = readsysfsbinary("/sys/firmware/dmi/tables/DMI");
+        hash.add(table.data(), table.size());
+    } else if (key == "disk") {
+        addfiles(hash, "/sys/block", "dev");
+    } else if (key == "monitor") {
+        addfiles(hash, "/sys/class/drm", "status");
+    } else if (key == "usb") {
+        addfiles(hash, "/sys/bus/usb/devices", "devnum");
+    } else if (key == "nic") {
+        addfiles(hash, "/sys/class/net", "address");
+    } else if (key != "cpu" && key != "gpu") {
+        return "";
+    }
+    
+    return hash.text();
+}
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "recordstore.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct cachedcategory {
+    std::string token;
+    recordstore items;
+};
+
+class resultcache {
+public:
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+    
+    const cachedcategory* find(const std::string& key) const;
+    void store(const std::string& key, const std::string& token, const recordstore& items);
+    void erase(const std::string& key) { categories.erase(key); }
+    
+    uint64_t savedat() const { return timestamp; }
+
+private:
+    std::map<std::string, cachedcategory> categories;
+    uint64_t timestamp = 0;
+};
+
+std::string defaultcachepath();
+std::string cachetoken(const std::string& key);
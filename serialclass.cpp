@@ -0,0 +1,36 @@
+#include "serialclass.h"
+
+// the table is built by the compiler, so the values the collectors used to special case are checked there too
+static_assert(classifyserial("") == serialclass::blank);
+static_assert(classifyserial(" n/a ") == serialclass::blank);
+static_assert(classifyserial("None") == serialclass::blank);
+static_assert(classifyserial("To Be Filled By O.E.M.") == serialclass::placeholder);
+static_assert(classifyserial("Default string") == serialclass::placeholder);
+static_assert(classifyserial("System Serial Number") == serialclass::placeholder);
+static_assert(classifyserial("0123456789") == serialclass::placeholder);
+static_assert(classifyserial("FFFFFFFF-FFFF") == serialclass::placeholder);
+static_assert(classifyserial("00000000") == serialclass::placeholder);
+static_assert(classifyserial("1") == serialclass::suspicious);
+static_assert(classifyserial("XXXX1234") == serialclass::suspicious);
+static_assert(classifyserial(L"WD-WCC4E1234567") == serialclass::real);
+static_assert(classifyserial("PF3ABCDE") == serialclass::real);
+
+const char* serialclassname(serialclass kind) {
+    switch (kind) {
+        case serialclass::real: return "real";
+        case serialclass::placeholder: return "placeholder";
+        case serialclass::blank: return "blank";
+        case serialclass::suspicious: return "suspicious";
+    }
+    return "unknown";
+}
+
+std::string serialnotes(std::string_view serial, std::string notes) {
+    serialclass kind = classifyserial(serial);
+    if (kind == serialclass::real) return notes;
+    
+    if (!notes.empty()) notes += "; ";
+    notes += serialclassname(kind);
+    notes += " serial";
+    return notes;
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+enum class serialclass : uint8_t {
+    real,
+    placeholder,
+    blank,
+    suspicious
+};
+
+struct serialpattern {
+    std::string_view text;
+    serialclass kind;
+};
+
+// whole values firmware, drivers and wmi hand back instead of a serial, matched after trimming and folding case
+inline constexpr serialpattern exactserials[] = {
+    {"N/A", serialclass::blank}, {"NA", serialclass::blank}, {"NONE", serialclass::blank}, {"NULL", serialclass::blank},
+    {"EMPTY", serialclass::blank}, {"NOT SPECIFIED", serialclass::blank}, {"NOT APPLICABLE", serialclass::blank},
+    {"NOT AVAILABLE", serialclass::blank}, {"UNKNOWN", serialclass::blank}, {"0", serialclass::placeholder},
+    {"OEM", serialclass::placeholder}, {"INVALID", serialclass::placeholder}, {"TBD", serialclass::placeholder},
+    {"SN", serialclass::placeholder}, {"S/N", serialclass::placeholder}, {"1234567890", serialclass::placeholder},
+    {"ABCDEFGHIJ", serialclass::placeholder},
+};
+
+// fragments that mark a value wherever they turn up in it
+inline constexpr serialpattern serialfragments[] = {
+    {"O.E.M.", serialclass::placeholder}, {"TO BE FILLED", serialclass::placeholder}, {"DEFAULT", serialclass::placeholder},
+    {"SERIAL", serialclass::placeholder}, {"DUMMY", serialclass::placeholder}, {"XXXX", serialclass::suspicious},
+    {"TEST", serialclass::suspicious},
+};
+
+// letters fold onto their capitals, digits keep their order so ascending runs can be spotted, anything else is 0
+constexpr size_t serialsymbols = 41;
+
+constexpr uint8_t serialsymbol(uint32_t c) {
+    if (c >= 'a' && c <= 'z') c -= 'a' - 'A';
+    if (c >= 'A' && c <= 'Z') return (uint8_t)(1 + c - 'A');
+    if (c >= '0' && c <= '9') return (uint8_t)(27 + c - '0');
+    if (c == '.') return 37;
+    if (c == ' ') return 38;
+    if (c == '/') return 39;
+    if (c == '-') return 40;
+    return 0;
+}
+
+struct serialsymboltable {
+    uint8_t symbols[128] = {};
+    
+    constexpr serialsymboltable() {
+        for (uint32_t c = 0; c < 128; c++) symbols[c] = serialsymbol(c);
+    }
+};
+
+inline constexpr serialsymboltable serialsymbolmap;
+
+// a dfa over the pattern table, built by the compiler. exact tables anchor at state 1 and fall into state 0
+// on the first miss; fragment tables are aho-corasick, so one pass finds every fragment at once. rows are
+// indexed by the ascii character itself, which keeps the symbol lookup off the state to state dependency
+template <size_t capacity>
+struct serialautomaton {
+    uint8_t next[capacity][128] = {};
+    uint8_t hits[capacity] = {};
+    size_t states = 0;
+};
+
+template <size_t count>
+constexpr size_t serialstates(const serialpattern (&patterns)[count]) {
+    size_t states = 2;
+    for (const auto& pattern : patterns) states += pattern.text.size();
+    return states;
+}
+
+template <size_t capacity, size_t count>
+constexpr serialautomaton<capacity> buildserialautomaton(const serialpattern (&patterns)[count], bool anywhere) {
+    static_assert(capacity <= 256, "serial automaton states must fit a byte");
+    serialautomaton<capacity> automaton;
+    uint8_t next[capacity][serialsymbols] = {};
+    bool present[capacity][serialsymbols] = {};
+    size_t root = anywhere ? 0 : 1;
+    automaton.states = root + 1;
+    
+    for (const auto& pattern : patterns) {
+        size_t state = root;
+        for (char c : pattern.text) {
+            uint8_t symbol = serialsymbol((unsigned char)c);
+            if (!present[state][symbol]) {
+                present[state][symbol] = true;
+                next[state][symbol] = (uint8_t)automaton.states++;
+            }
+            state = next[state][symbol];
+        }
+        automaton.hits[state] |= (uint8_t)(1u << (unsigned)pattern.kind);
+    }
+    
+    if (anywhere) {
+        // breadth first, so a state's failure link is finished before its children need it
+        size_t failure[capacity] = {};
+        size_t queue[capacity] = {};
+        size_t head = 0;
+        size_t tail = 0;
+        for (size_t symbol = 0; symbol < serialsymbols; symbol++) {
+            if (present[root][symbol]) queue[tail++] = next[root][symbol];
+        }
+        while (head < tail) {
+            size_t state = queue[head++];
+            automaton.hits[state] |= automaton.hits[failure[state]];
+            for (size_t symbol = 0; symbol < serialsymbols; symbol++) {
+                if (present[state][symbol]) {
+                    size_t child = next[state][symbol];
+                    failure[child] = state == root ? root : next[failure[state]][symbol];
+                    queue[tail++] = child;
+                } else {
+                    next[state][symbol] = next[failure[state]][symbol];
+                }
+            }
+        }
+    }
+    
+    for (size_t state = 0; state < automaton.states; state++) {
+        for (uint32_t c = 0; c < 128; c++) automaton.next[state][c] = next[state][serialsymbolmap.symbols[c]];
+    }
+    return automaton;
+}
+
+inline constexpr auto exactserialautomaton = buildserialautomaton<serialstates(exactserials)>(exactserials, false);
+inline constexpr auto serialfragmentautomaton = buildserialautomaton<serialstates(serialfragments)>(serialfragments, true);
+
+constexpr bool hasserialclass(uint8_t hits, serialclass kind) {
+    return (hits & (1u << (unsigned)kind)) != 0;
+}
+
+// one pass, no allocation. blank is nothing or an explicit "none", placeholder is filler text or a repeated
+// or counting pattern, suspicious is too short, carries control or non-ascii bytes or a doubtful fragment
+template <typename character>
+constexpr serialclass classifyserialtext(std::basic_string_view<character> value) {
+    using unit = std::make_unsigned_t<character>;
+    
+    auto space = [](uint32_t c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    size_t start = 0;
+    size_t end = value.size();
+    while (start < end && space((unit)value[start])) start++;
+    while (end > start && space((unit)value[end - 1])) end--;
+    if (start == end) return serialclass::blank;
+    
+    uint8_t exact = 1;
+    uint8_t fragment = 0;
+    uint8_t hits = 0;
+    size_t alphanumerics = 0;
+    uint8_t first = 0;
+    uint8_t previous = 0;
+    bool repeated = true;
+    bool counting = true;
+    bool unprintable = false;
+    
+    for (size_t i = start; i < end; i++) {
+        uint32_t c = (unit)value[i];
+        if (c < 0x20 || c >= 0x7F) unprintable = true;
+        
+        uint32_t ascii = c < 128 ? c : 0;
+        exact = exactserialautomaton.next[exact][ascii];
+        fragment = serialfragmentautomaton.next[fragment][ascii];
+        hits |= serialfragmentautomaton.hits[fragment];
+        
+        uint8_t symbol = serialsymbolmap.symbols[ascii];
+        if (symbol == 0 || symbol > 36) continue;
+        if (alphanumerics == 0) {
+            first = symbol;
+            counting = symbol >= 27;
+        } else {
+            repeated = repeated && symbol == first;
+            counting = counting && symbol == previous + 1;
+        }
+        previous = symbol;
+        alphanumerics++;
+    }
+    
+    uint8_t whole = exactserialautomaton.hits[exact];
+    if (hasserialclass(whole, serialclass::blank)) return serialclass::blank;
+    if (hasserialclass(whole, serialclass::placeholder) || hasserialclass(hits, serialclass::placeholder)) return serialclass::placeholder;
+    if (alphanumerics == 0) return unprintable ? serialclass::suspicious : serialclass::blank;
+    if (alphanumerics >= 2 && repeated) return serialclass::placeholder;
+    if (alphanumerics >= 6 && counting) return serialclass::placeholder;
+    if (unprintable || alphanumerics < 4 || hasserialclass(hits, serialclass::suspicious)) return serialclass::suspicious;
+    return serialclass::real;
+}
+
+constexpr serialclass classifyserial(std::string_view value) {
+    return classifyserialtext(value);
+}
+
+constexpr serialclass classifyserial(std::wstring_view value) {
+    return classifyserialtext(value);
+}
+
+const char* serialclassname(serialclass kind);
+
+// the notes a serial item carries: unchanged for a real serial, otherwise with the class appended
+std::string serialnotes(std::string_view serial, std::string notes);
@@ -0,0 +1,496 @@
+#include "serialindex.h"
+#include "serialclass.h"
+#include "textutil.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+
+static const char serialindexmagic[8] = {'U', 'D', 'S', 'I', 'D', 'X', 0, 1};
+
+// magic, then keys, postings, hosts, sources and the offsets of the hosts, sources, keys, postings and pool
+// sections plus the pool size, all little endian
+static const size_t headersize = sizeof(serialindexmagic) + 10 * 8;
+static const size_t namesize = 16;
+static const size_t keysize = 24;
+static const size_t postingsize = 12;
+static const size_t keyhead = 8;
+
+// nothing that long is an identifier, and it keeps a run record's length to one byte
+static const size_t longestidentifier = 255;
+
+// how many runs one merge pass reads at once, each through its own buffer
+static const size_t mergefanin = 64;
+static const size_t runbuffersize = 256 * 1024;
+
+static void putle(std::string& out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) out.push_back((char)(value >> (i * 8)));
+}
+
+static uint64_t loadle(const uint8_t* data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) value |= (uint64_t)data[i] << (i * 8);
+    return value;
+}
+
+static void foldidentifier(std::string_view value, std::string& out) {
+    out.clear();
+    for (char c : trimascii(value)) {
+        if (c == ' ' || c == '\t' || c == ':' || c == '-' || c == '.') continue;
+        out.push_back(asciiupper(c));
+    }
+}
+
+std::string normalizeidentifier(std::string_view value) {
+    std::string out;
+    foldidentifier(value, out);
+    return out;
+}
+
+struct runrecord {
+    std::string value;
+    uint32_t host = 0;
+    uint32_t source = 0;
+    uint8_t kind = 0;
+};
+
+static bool runless(std::string_view avalue, uint32_t ahost, uint32_t asource, uint8_t akind,
+    std::string_view bvalue, uint32_t bhost, uint32_t bsource, uint8_t bkind) {
+    if (avalue != bvalue) return avalue < bvalue;
+    if (ahost != bhost) return ahost < bhost;
+    if (asource != bsource) return asource < bsource;
+    return akind < bkind;
+}
+
+static bool sameposting(const runrecord& a, const runrecord& b) {
+    return a.host == b.host && a.source == b.source && a.kind == b.kind && a.value == b.value;
+}
+
+// a run is records of length, text, kind, host and source, in sorted order
+static void putrunrecord(std::string& out, std::string_view value, uint8_t kind, uint32_t host, uint32_t source) {
+    out.push_back((char)value.size());
+    out.append(value);
+    out.push_back((char)kind);
+    putle(out, host, 4);
+    putle(out, source, 4);
+}
+
+class runreader {
+public:
+    bool open(const std::string& path) {
+        in.open(path, std::ios::binary);
+        buffer.resize(runbuffersize);
+        return (bool)in;
+    }
+    
+    // false at the end of the run; running out in the middle of a record means it was cut short
+    bool next(runrecord& record) {
+        uint8_t length = 0;
+        if (!read(&length, 1)) return false;
+        
+        record.value.resize(length);
+        uint8_t fields[9];
+        if (!read(record.value.data(), length) || !read(fields, sizeof(fields))) {
+            broken = true;
+            return false;
+        }
+        
+        record.kind = fields[0];
+        record.host = (uint32_t)loadle(fields + 1, 4);
+        record.source = (uint32_t)loadle(fields + 5, 4);
+        return true;
+    }
+    
+    bool failed() const { return broken; }
+
+private:
+    bool read(void* out, size_t size) {
+        char* target = static_cast<char*>(out);
+        while (size > 0) {
+            if (position == available) {
+                in.read(buffer.data(), (std::streamsize)buffer.size());
+                available = (size_t)in.gcount();
+                position = 0;
+                if (available == 0) return false;
+            }
+            size_t take = std::min(size, available - position);
+            memcpy(target, buffer.data() + position, take);
+            position += take;
+            target += take;
+            size -= take;
+        }
+        return true;
+    }
+    
+    std::ifstream in;
+    std::vector<char> buffer;
+    size_t position = 0;
+    size_t available = 0;
+    bool broken = false;
+};
+
+// k way merge; the sink sees every record of every run once, in order
+static bool mergeruns(const std::vector<std::string>& paths, const std::function<bool(const runrecord&)>& sink) {
+    std::vector<std::unique_ptr<runreader>> readers;
+    std::vector<runrecord> heads(paths.size());
+    std::vector<size_t> heap;
+    
+    for (size_t i = 0; i < paths.size(); i++) {
+        readers.push_back(std::make_unique<runreader>());
+        if (!readers[i]->open(paths[i])) return false;
+        if (readers[i]->next(heads[i])) heap.push_back(i);
+        else if (readers[i]->failed()) return false;
+    }
+    
+    auto greater = [&](size_t a, size_t b) {
+        return runless(heads[b].value, heads[b].host, heads[b].source, heads[b].kind, heads[a].value, heads[a].host, heads[a].source, heads[a].kind);
+    };
+    std::make_heap(heap.begin(), heap.end(), greater);
+    
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), greater);
+        size_t run = heap.back();
+        if (!sink(heads[run])) return false;
+        
+        if (readers[run]->next(heads[run])) {
+            std::push_heap(heap.begin(), heap.end(), greater);
+        } else {
+            if (readers[run]->failed()) return false;
+            heap.pop_back();
+        }
+    }
+    return true;
+}
+
+static void removefile(const std::string& path) {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+serialindexwriter::serialindexwriter(const std::string& path, size_t memorylimit, size_t buffers)
+    : path(path), budget(std::max<size_t>(memorylimit / std::max<size_t>(buffers, 1), 64 * 1024)), buffers(std::max<size_t>(buffers, 1)) {}
+
+serialindexwriter::~serialindexwriter() {
+    for (const auto& run : runs) removefile(run);
+    removefile(path + ".keys");
+    removefile(path + ".pool");
+}
+
+bool serialindexwriter::add(size_t slot, uint8_t kind, uint32_t host, uint32_t source, std::string_view value) {
+    if (classifyserial(value) != serialclass::real) return true;
+    
+    buffer& pending = buffers[slot];
+    foldidentifier(value, pending.scratch);
+    if (pending.scratch.empty() || pending.scratch.size() > longestidentifier) return true;
+    
+    pending.entries.push_back({pending.text.size(), host, source, (uint8_t)pending.scratch.size(), kind});
+    pending.text += pending.scratch;
+    
+    if (pending.text.size() + pending.entries.size() * sizeof(entry) >= budget) return spill(pending);
+    return true;
+}
+
+bool serialindexwriter::spill(buffer& pending) {
+    if (pending.entries.empty()) return !pending.failed;
+    
+    const char* text = pending.text.data();
+    auto value = [text](const entry& e) { return std::string_view(text + e.offset, e.length); };
+    std::sort(pending.entries.begin(), pending.entries.end(), [&](const entry& a, const entry& b) {
+        return runless(value(a), a.host, a.source, a.kind, value(b), b.host, b.source, b.kind);
+    });
+    
+    std::string run;
+    {
+        std::lock_guard<std::mutex> guard(runlock);
+        run = path + ".run" + std::to_string(runs.size());
+        runs.push_back(run);
+    }
+    
+    std::ofstream out(run, std::ios::binary | std::ios::trunc);
+    std::string chunk;
+    for (const auto& e : pending.entries) {
+        putrunrecord(chunk, value(e), e.kind, e.host, e.source);
+        if (chunk.size() >= runbuffersize) {
+            out.write(chunk.data(), (std::streamsize)chunk.size());
+            chunk.clear();
+        }
+    }
+    out.write(chunk.data(), (std::streamsize)chunk.size());
+    if (!out.good()) pending.failed = true;
+    
+    pending.entries.clear();
+    pending.text.clear();
+    return !pending.failed;
+}
+
+bool serialindexwriter::finish(const std::vector<std::string>& hosts, const std::vector<std::string>& sources, serialindexstats& stats) {
+    for (auto& pending : buffers) {
+        if (!spill(pending)) return false;
+    }
+    stats.runs = runs.size();
+    
+    // merge down to one pass worth of runs first, so the open files and read buffers stay bounded too
+    std::vector<std::string> level = runs;
+    while (level.size() > mergefanin) {
+        std::vector<std::string> merged;
+        for (size_t start = 0; start < level.size(); start += mergefanin) {
+            std::vector<std::string> group(level.begin() + start, level.begin() + std::min(level.size(), start + mergefanin));
+            std::string run = path + ".run" + std::to_string(runs.size());
+            runs.push_back(run);
+            
+            std::ofstream out(run, std::ios::binary | std::ios::trunc);
+            std::string chunk;
+            bool written = mergeruns(group, [&](const runrecord& record) {
+                putrunrecord(chunk, record.value, record.kind, record.host, record.source);
+                if (chunk.size() >= runbuffersize) {
+                    out.write(chunk.data(), (std::streamsize)chunk.size());
+                    chunk.clear();
+                }
+                return true;
+            });
+            out.write(chunk.data(), (std::streamsize)chunk.size());
+            if (!written || !out.good()) return false;
+            
+            for (const auto& done : group) removefile(done);
+            merged.push_back(run);
+        }
+        level = std::move(merged);
+    }
+    
+    // postings go straight into the index behind a placeholder header; keys and text are staged beside it
+    // and appended once their sizes are known
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::ofstream keys(path + ".keys", std::ios::binary | std::ios::trunc);
+    std::ofstream pool(path + ".pool", std::ios::binary | std::ios::trunc);
+    if (!out || !keys || !pool) return false;
+    
+    std::string names;
+    std::string chunk;
+    uint64_t poolsize = 0;
+    auto addname = [&](std::string_view name) {
+        putle(names, poolsize, 8);
+        putle(names, name.size(), 4);
+        putle(names, 0, 4);
+        chunk.append(name);
+        poolsize += name.size();
+    };
+    for (const auto& host : hosts) addname(host);
+    for (const auto& source : sources) addname(source);
+    pool.write(chunk.data(), (std::streamsize)chunk.size());
+    chunk.clear();
+    
+    std::string header(headersize, '\0');
+    out.write(header.data(), (std::streamsize)header.size());
+    out.write(names.data(), (std::streamsize)names.size());
+    
+    std::string postingchunk;
+    std::string keychunk;
+    std::string textchunk;
+    runrecord previous;
+    bool first = true;
+    
+    auto flush = [&](std::ofstream& stream, std::string& pending, size_t threshold) {
+        if (pending.size() < threshold) return;
+        stream.write(pending.data(), (std::streamsize)pending.size());
+        pending.clear();
+    };
+    
+    auto addkey = [&](std::string_view value) {
+        char head[keyhead] = {};
+        memcpy(head, value.data(), std::min(value.size(), keyhead));
+        keychunk.append(head, keyhead);
+        putle(keychunk, poolsize, 8);
+        putle(keychunk, value.size(), 4);
+        putle(keychunk, stats.postings, 4);
+        textchunk.append(value);
+        poolsize += value.size();
+        stats.identifiers++;
+    };
+    
+    bool merged = mergeruns(level, [&](const runrecord& record) {
+        if (!first && sameposting(record, previous)) return true;
+        if (stats.postings >= UINT32_MAX) return false;
+        
+        if (first || record.value != previous.value) addkey(record.value);
+        putle(postingchunk, record.host, 4);
+        putle(postingchunk, record.source, 4);
+        putle(postingchunk, record.kind, 4);
+        stats.postings++;
+        
+        previous.value = record.value;
+        previous.host = record.host;
+        previous.source = record.source;
+        previous.kind = record.kind;
+        first = false;
+        
+        flush(out, postingchunk, runbuffersize);
+        flush(keys, keychunk, runbuffersize);
+        flush(pool, textchunk, runbuffersize);
+        return true;
+    });
+    if (!merged) return false;
+    
+    // the last key's posting count comes from a closing entry, as every other key's does from its successor
+    keychunk.append(keyhead, '\0');
+    putle(keychunk, poolsize, 8);
+    putle(keychunk, 0, 4);
+    putle(keychunk, stats.postings, 4);
+    
+    flush(out, postingchunk, 0);
+    flush(keys, keychunk, 0);
+    flush(pool, textchunk, 0);
+    keys.close();
+    pool.close();
+    if (!keys.good() || !pool.good()) return false;
+    
+    uint64_t hostsoffset = headersize;
+    uint64_t sourcesoffset = hostsoffset + hosts.size() * namesize;
+    uint64_t postingsoffset = sourcesoffset + sources.size() * namesize;
+    uint64_t keysoffset = postingsoffset + stats.postings * postingsize;
+    uint64_t pooloffset = keysoffset + (stats.identifiers + 1) * keysize;
+    
+    for (const char* staged : {".keys", ".pool"}) {
+        std::ifstream in(path + staged, std::ios::binary);
+        std::vector<char> copy(runbuffersize);
+        while (in.read(copy.data(), (std::streamsize)copy.size()) || in.gcount() > 0) {
+            out.write(copy.data(), in.gcount());
+        }
+        in.close();
+        removefile(path + staged);
+    }
+    
+    header.assign(serialindexmagic, sizeof(serialindexmagic));
+    for (uint64_t field : {stats.identifiers, stats.postings, (uint64_t)hosts.size(), (uint64_t)sources.size(),
+             hostsoffset, sourcesoffset, keysoffset, postingsoffset, pooloffset, poolsize}) {
+        putle(header, field, 8);
+    }
+    out.seekp(0);
+    out.write(header.data(), (std::streamsize)header.size());
+    out.close();
+    
+    for (const auto& done : level) removefile(done);
+    runs.clear();
+    
+    stats.bytes = pooloffset + poolsize;
+    return out.good();
+}
+
+bool serialindex::open(const std::string& path) {
+    close();
+    if (!file.open(path)) return false;
+    
+    const uint8_t* data = file.data();
+    uint64_t size = file.size();
+    if (size < headersize || memcmp(data, serialindexmagic, sizeof(serialindexmagic)) != 0) {
+        close();
+        return false;
+    }
+    
+    uint64_t fields[10];
+    for (size_t i = 0; i < 10; i++) fields[i] = loadle(data + sizeof(serialindexmagic) + i * 8, 8);
+    keycount = fields[0];
+    postingcount = fields[1];
+    hostcount = fields[2];
+    sourcecount = fields[3];
+    hostsoffset = fields[4];
+    sourcesoffset = fields[5];
+    keysoffset = fields[6];
+    postingsoffset = fields[7];
+    pooloffset = fields[8];
+    poolsize = fields[9];
+    
+    // every section has to lie inside the file before anything in it is trusted
+    auto fits = [size](uint64_t offset, uint64_t count, uint64_t width) {
+        return offset <= size && count <= (size - offset) / width;
+    };
+    bool valid = fits(hostsoffset, hostcount, namesize) && fits(sourcesoffset, sourcecount, namesize) &&
+        fits(postingsoffset, postingcount, postingsize) && keycount < size && fits(keysoffset, keycount + 1, keysize) &&
+        fits(pooloffset, poolsize, 1) && hostcount <= UINT32_MAX && sourcecount <= UINT32_MAX;
+    if (!valid) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void serialindex::close() {
+    file.close();
+    keycount = postingcount = hostcount = sourcecount = 0;
+    hostsoffset = sourcesoffset = keysoffset = postingsoffset = pooloffset = poolsize = 0;
+}
+
+std::string_view serialindex::name(uint64_t table, uint64_t count, uint64_t index) const {
+    if (index >= count) return {};
+    const uint8_t* entry = file.data() + table + index * namesize;
+    uint64_t offset = loadle(entry, 8);
+    uint64_t length = loadle(entry + 8, 4);
+    if (offset > poolsize || length > poolsize - offset) return {};
+    return std::string_view(reinterpret_cast<const char*>(file.data() + pooloffset + offset), (size_t)length);
+}
+
+std::string_view serialindex::hostname(uint32_t host) const {
+    return name(hostsoffset, hostcount, host);
+}
+
+std::string_view serialindex::sourcename(uint32_t source) const {
+    return name(sourcesoffset, sourcecount, source);
+}
+
+std::string_view serialindex::keyvalue(size_t key) const {
+    const uint8_t* entry = file.data() + keysoffset + key * keysize;
+    uint64_t offset = loadle(entry + keyhead, 8);
+    uint64_t length = loadle(entry + keyhead + 8, 4);
+    if (offset > poolsize || length > poolsize - offset) return {};
+    return std::string_view(reinterpret_cast<const char*>(file.data() + pooloffset + offset), (size_t)length);
+}
+
+size_t serialindex::lowerbound(std::string_view value) const {
+    uint8_t head[keyhead] = {};
+    memcpy(head, value.data(), std::min(value.size(), keyhead));
+    
+    size_t low = 0;
+    size_t high = (size_t)keycount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int order = memcmp(file.data() + keysoffset + middle * keysize, head, keyhead);
+        if (order == 0) order = keyvalue(middle).compare(value);
+        if (order < 0) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+void serialindex::appendpostings(std::vector<serialindexmatch>& matches, size_t key, size_t limit) const {
+    const uint8_t* entry = file.data() + keysoffset + key * keysize;
+    uint64_t first = loadle(entry + keyhead + 12, 4);
+    uint64_t last = std::min(loadle(entry + keysize + keyhead + 12, 4), postingcount);
+    std::string_view value = keyvalue(key);
+    
+    for (uint64_t i = first; i < last && matches.size() < limit; i++) {
+        const uint8_t* posting = file.data() + postingsoffset + i * postingsize;
+        matches.push_back({value, (uint8_t)loadle(posting + 8, 4), (uint32_t)loadle(posting, 4), (uint32_t)loadle(posting + 4, 4)});
+    }
+}
+
+std::vector<serialindexmatch> serialindex::lookup(std::string_view identifier) const {
+    std::vector<serialindexmatch> matches;
+    std::string value = normalizeidentifier(identifier);
+    if (value.empty()) return matches;
+    
+    size_t key = lowerbound(value);
+    if (key < keycount && keyvalue(key) == value) appendpostings(matches, key, SIZE_MAX);
+    return matches;
+}
+
+std::vector<serialindexmatch> serialindex::prefix(std::string_view identifier, size_t limit) const {
+    std::vector<serialindexmatch> matches;
+    std::string value = normalizeidentifier(identifier);
+    
+    for (size_t key = lowerbound(value); key < keycount && matches.size() < limit; key++) {
+        if (keyvalue(key).substr(0, value.size()) != value) break;
+        appendpostings(matches, key, limit);
+    }
+    return matches;
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "mappedfile.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// upper cased with spaces, tabs and the ':', '-' and '.' separators dropped, so a mac or uuid matches
+// however it was written; the same folding the fingerprints use
+std::string normalizeidentifier(std::string_view value);
+
+struct serialindexstats {
+    uint64_t identifiers = 0;
+    uint64_t postings = 0;
+    uint64_t runs = 0;
+    uint64_t bytes = 0;
+};
+
+// collects (identifier, kind, host, source) entries from several threads, one buffer each, and spills a
+// buffer to a sorted run file beside the index once it outgrows its share of the memory limit; finish
+// merges the runs into the index, so memory stays bounded however many identifiers come in
+class serialindexwriter {
+public:
+    serialindexwriter(const std::string& path, size_t memorylimit, size_t buffers);
+    ~serialindexwriter();
+    
+    serialindexwriter(const serialindexwriter&) = delete;
+    serialindexwriter& operator=(const serialindexwriter&) = delete;
+    
+    // normalizes the value and keeps it only if the serial classifier takes it for real; false on a write error
+    bool add(size_t buffer, uint8_t kind, uint32_t host, uint32_t source, std::string_view value);
+    
+    // hosts and sources are the names postings refer to by number
+    bool finish(const std::vector<std::string>& hosts, const std::vector<std::string>& sources, serialindexstats& stats);
+
+private:
+    struct entry {
+        uint64_t offset;
+        uint32_t host;
+        uint32_t source;
+        uint8_t length;
+        uint8_t kind;
+    };
+    
+    struct buffer {
+        std::string text;
+        std::vector<entry> entries;
+        std::string scratch;
+        bool failed = false;
+    };
+    
+    bool spill(buffer& pending);
+    
+    std::string path;
+    size_t budget;
+    std::vector<buffer> buffers;
+    std::vector<std::string> runs;
+    std::mutex runlock;
+};
+
+struct serialindexmatch {
+    std::string_view value;
+    uint8_t kind;
+    uint32_t host;
+    uint32_t source;
+};
+
+// the index file mapped read only: a fixed width key table sorted by identifier, with the first eight bytes
+// of each key inline so a binary search rarely leaves the table, then the postings and the text they point to
+class serialindex {
+public:
+    bool open(const std::string& path);
+    void close();
+    
+    uint64_t identifiers() const { return keycount; }
+    uint64_t postings() const { return postingcount; }
+    uint32_t hosts() const { return (uint32_t)hostcount; }
+    
+    std::string_view hostname(uint32_t host) const;
+    std::string_view sourcename(uint32_t source) const;
+    
+    // every posting for one identifier, which is normalized first
+    std::vector<serialindexmatch> lookup(std::string_view identifier) const;
+    
+    // postings for identifiers starting with the normalized prefix, in identifier order, up to limit of them
+    std::vector<serialindexmatch> prefix(std::string_view identifier, size_t limit) const;
+
+private:
+    size_t lowerbound(std::string_view value) const;
+    std::string_view keyvalue(size_t key) const;
+    void appendpostings(std::vector<serialindexmatch>& matches, size_t key, size_t limit) const;
+    std::string_view name(uint64_t table, uint64_t count, uint64_t index) const;
+    
+    mappedfile file;
+    uint64_t keycount = 0;
+    uint64_t postingcount = 0;
+    uint64_t hostcount = 0;
+    uint64_t sourcecount = 0;
+    uint64_t hostsoffset = 0;
+    uint64_t sourcesoffset = 0;
+    uint64_t keysoffset = 0;
+    uint64_t postingsoffset = 0;
+    uint64_t pooloffset = 0;
+    uint64_t poolsize = 0;
+};
@@ -0,0 +1,194 @@
+#include "smbios.h"
+#include <cstring>
+#include <algorithm>
+
+static uint16_t readle16(const uint8_t* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t readle32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t readle64(const uint8_t* p) {
+    return (uint64_t)readle32(p) | ((uint64_t)readle32(p + 4) << 32);
+}
+
+std::string_view smbiosview::string(uint8_t index) const {
+    if (index == 0 || !strings) return {};
+    
+    const char* cursor = strings;
+    const char* end = strings + stringslength;
+    uint8_t current = 0;
+    
+    while (cursor < end) {
+        const char* nul = static_cast<const char*>(memchr(cursor, 0, (size_t)(end - cursor)));
+        const char* stop = nul ? nul : end;
+        
+        if (stop != cursor) {
+            current++;
+            if (current == index) return std::string_view(cursor, (size_t)(stop - cursor));
+        }
+        
+        cursor = stop + 1;
+    }
+    
+    return {};
+}
+
+std::string_view smbiosview::stringat(int dataindex) const {
+    size_t actualoffset = 4 + (size_t)dataindex;
+    if (length <= actualoffset) return "n/a";
+    return string(formatted[actualoffset]);
+}
+
+const uint8_t* smbiosview::field(size_t offset, size_t size) const {
+    if (offset + size > length) return nullptr;
+    return formatted + offset;
+}
+
+smbiostable::smbiostable(const uint8_t* data, size_t size) {
+    parse(data, size);
+}
+
+void smbiostable::parse(const uint8_t* data, size_t size) {
+    views.clear();
+    typeorder.clear();
+    handleorder.clear();
+    memset(typestart, 0, sizeof(typestart));
+    
+    if (!data || size == 0) return;
+    
+    views.reserve(size / 48 + 1);
+    
+    size_t offset = 0;
+    size_t end = size;
+    
+    while (offset + 4 < end) {
+        uint8_t type = data[offset];
+        uint8_t length = data[offset + 1];
+        
+        if (type == 127) break;
+        if (length < 4 || offset + length > end) break;
+        
+        smbiosview view;
+        view.type = type;
+        view.length = length;
+        view.handle = readle16(&data[offset + 2]);
+        view.formatted = &data[offset];
+        
+        size_t stringsstart = offset + length;
+        size_t cursor = stringsstart;
+        bool terminated = false;
+        
+        while (cursor + 1 < end) {
+            const uint8_t* nul = static_cast<const uint8_t*>(memchr(&data[cursor], 0, end - cursor - 1));
+            if (!nul) break;
+            
+            cursor = (size_t)(nul - data);
+            if (data[cursor + 1] == 0) {
+                terminated = true;
+                break;
+            }
+            cursor++;
+        }
+        
+        view.strings = reinterpret_cast<const char*>(&data[std::min(stringsstart, end)]);
+        if (terminated) {
+            view.stringslength = cursor - stringsstart;
+            offset = cursor + 2;
+        } else {
+            view.stringslength = stringsstart < end ? end - stringsstart : 0;
+            offset = end;
+        }
+        
+        views.push_back(view);
+        
+        if (offset >= end) break;
+    }
+    
+    uint32_t counts[256] = {};
+    for (const auto& view : views) {
+        counts[view.type]++;
+    }
+    
+    for (int t = 0; t < 256; t++) {
+        typestart[t + 1] = typestart[t] + counts[t];
+    }
+    
+    uint32_t cursors[256];
+    memcpy(cursors, typestart, sizeof(cursors));
+    
+    typeorder.resize(views.size());
+    handleorder.resize(views.size());
+    for (uint32_t i = 0; i < (uint32_t)views.size(); i++) {
+        typeorder[cursors[views[i].type]++] = i;
+        handleorder[i] = {views[i].handle, i};
+    }
+    
+    std::sort(handleorder.begin(), handleorder.end());
+}
+
+smbiostable::range smbiostable::bytype(uint8_t type) const {
+    const uint32_t* base = typeorder.data();
+    return range(this, base + typestart[type], base + typestart[type + 1]);
+}
+
+const smbiosview* smbiostable::byhandle(uint16_t handle) const {
+    auto it = std::lower_bound(handleorder.begin(), handleorder.end(), std::make_pair(handle, (uint32_t)0));
+    if (it == handleorder.end() || it->first != handle) return nullptr;
+    return &views[it->second];
+}
+
+bool parsesmbiosentrypoint(const uint8_t* data, size_t size, uint64_t& address, uint64_t& length) {
+    address = 0;
+    length = 0;
+    
+    if (!data) return false;
+    
+    if (size >= 0x18 && memcmp(data, "_SM3_", 5) == 0) {
+        length = readle32(&data[0x0C]);
+        address = readle64(&data[0x10]);
+        return true;
+    }
+    
+    if (size >= 0x1F && memcmp(data, "_SM_", 4) == 0) {
+        length = readle16(&data[0x16]);
+        address = readle32(&data[0x18]);
+        return true;
+    }
+    
+    if (size >= 0x0F && memcmp(data, "_DMI_", 5) == 0) {
+        length = readle16(&data[0x06]);
+        address = readle32(&data[0x08]);
+        return true;
+    }
+    
+    return false;
+}
+
+bool locatesmbiostable(const uint8_t* data, size_t size, size_t& offset, size_t& length) {
+    offset = 0;
+    length = 0;
+    
+    if (!data || size < 4) return false;
+    
+    uint64_t address = 0;
+    uint64_t tablelength = 0;
+    
+    if (!parsesmbiosentrypoint(data, size, address, tablelength)) {
+        if (size >= 8 && (data[1] == 2 || data[1] == 3) && readle32(&data[4]) > 0 && readle32(&data[4]) <= size - 8) {
+            offset = 8;
+            length = readle32(&data[4]);
+        } else {
+            length = size;
+        }
+        return true;
+    }
+    
+    if (address >= size) return false;
+    
+    offset = (size_t)address;
+    length = (size_t)std::min<uint64_t>(tablelength, size - offset);
+    return length > 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+#include <utility>
+
+struct smbiosview {
+    uint8_t type = 0;
+    uint8_t length = 0;
+    uint16_t handle = 0;
+    const uint8_t* formatted = nullptr;
+    const char* strings = nullptr;
+    size_t stringslength = 0;
+    
+    std::string_view string(uint8_t index) const;
+    std::string_view stringat(int dataindex) const;
+    const uint8_t* field(size_t offset, size_t size) const;
+};
+
+class smbiostable {
+public:
+    class range {
+    public:
+        class iterator {
+        public:
+            iterator(const smbiostable* table, const uint32_t* position) : table(table), position(position) {}
+            const smbiosview& operator*() const { return table->views[*position]; }
+            const smbiosview* operator->() const { return &table->views[*position]; }
+            iterator& operator++() { position++; return *this; }
+            bool operator!=(const iterator& other) const { return position != other.position; }
+            bool operator==(const iterator& other) const { return position == other.position; }
+        
+        private:
+            const smbiostable* table;
+            const uint32_t* position;
+        };
+        
+        range(const smbiostable* table, const uint32_t* first, const uint32_t* last) : table(table), first(first), last(last) {}
+        iterator begin() const { return iterator(table, first); }
+        iterator end() const { return iterator(table, last); }
+        size_t size() const { return (size_t)(last - first); }
+        bool empty() const { return first == last; }
+    
+    private:
+        const smbiostable* table;
+        const uint32_t* first;
+        const uint32_t* last;
+    };
+    
+    smbiostable() = default;
+    smbiostable(const uint8_t* data, size_t size);
+    
+    void parse(const uint8_t* data, size_t size);
+    
+    const std::vector<smbiosview>& structures() const { return views; }
+    range bytype(uint8_t type) const;
+    const smbiosview* byhandle(uint16_t handle) const;
+    
+    bool empty() const { return views.empty(); }
+    size_t size() const { return views.size(); }
+
+private:
+    std::vector<smbiosview> views;
+    std::vector<uint32_t> typeorder;
+    std::vector<std::pair<uint16_t, uint32_t>> handleorder;
+    uint32_t typestart[257] = {};
+};
+
+bool parsesmbiosentrypoint(const uint8_t* data, size_t size, uint64_t& address, uint64_t& length);
+bool locatesmbiostable(const uint8_t* data, size_t size, size_t& offset, size_t& length);
@@ -0,0 +1,318 @@
+#include "snapshot.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+static const char snapshotmagic[8] = {'U', 'D', 'S', 'N', 'A', 'P', 0, 1};
+
+static void writevarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back((uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((uint8_t)value);
+}
+
+static bool readvarint(const uint8_t*& cursor, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        uint8_t b = *cursor++;
+        value |= (uint64_t)(b & 0x7F) << shift;
+        if ((b & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+void snapshot::retain(const std::vector<std::string>& sections) {
+    recordstore kept;
+    for (const auto& record : store.records()) {
+        bool selected = std::any_of(sections.begin(), sections.end(), [&](const std::string& section) { return section == record.section; });
+        if (!selected) continue;
+        kept.add(record);
+    }
+    store = std::move(kept);
+}
+
+void snapshot::clear() {
+    store.clear();
+    host.clear();
+    timestamp = 0;
+}
+
+std::vector<uint8_t> snapshot::encode() const {
+    std::vector<std::string_view> strings;
+    std::unordered_map<std::string_view, uint32_t> interned;
+    std::vector<uint32_t> fields;
+    fields.reserve(store.size() * 5 + 1);
+    interned.reserve(store.size() + 1);
+    
+    auto intern = [&](std::string_view value) {
+        auto result = interned.emplace(value, (uint32_t)strings.size());
+        if (result.second) strings.push_back(value);
+        return result.first->second;
+    };
+    
+    fields.push_back(intern(host));
+    for (const auto& record : store.records()) {
+        fields.push_back(intern(record.section));
+        fields.push_back(intern(record.category));
+        fields.push_back(intern(record.name));
+        fields.push_back(intern(record.value));
+        fields.push_back(intern(record.notes));
+    }
+    
+    std::vector<uint8_t> out(snapshotmagic, snapshotmagic + sizeof(snapshotmagic));
+    writevarint(out, timestamp);
+    
+    writevarint(out, strings.size());
+    for (const auto& s : strings) {
+        writevarint(out, s.size());
+        out.insert(out.end(), s.begin(), s.end());
+    }
+    
+    writevarint(out, fields[0]);
+    writevarint(out, store.size());
+    for (size_t i = 1; i < fields.size(); i++) {
+        writevarint(out, fields[i]);
+    }
+    
+    return out;
+}
+
+bool snapshot::decode(const uint8_t* data, size_t size) {
+    clear();
+    
+    if (!data || size < sizeof(snapshotmagic) || memcmp(data, snapshotmagic, sizeof(snapshotmagic)) != 0) return false;
+    
+    const uint8_t* cursor = data + sizeof(snapshotmagic);
+    const uint8_t* end = data + size;
+    uint64_t value = 0;
+    
+    if (!readvarint(cursor, end, timestamp)) return false;
+    
+    if (!readvarint(cursor, end, value) || value > size) return false;
+    
+    std::vector<std::string_view> strings;
+    strings.reserve((size_t)value);
+    for (uint64_t i = 0, count = value; i < count; i++) {
+        if (!readvarint(cursor, end, value) || value > (uint64_t)(end - cursor)) {
+            clear();
+            return false;
+        }
+        strings.push_back(store.intern(std::string_view(reinterpret_cast<const char*>(cursor), (size_t)value)));
+        cursor += value;
+    }
+    
+    if (!readvarint(cursor, end, value) || value >= strings.size()) {
+        clear();
+        return false;
+    }
+    std::string hostname(strings[(size_t)value]);
+    
+    uint64_t count = 0;
+    if (!readvarint(cursor, end, count) || count > size) {
+        clear();
+        return false;
+    }
+    
+    store.reserve((size_t)count);
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t index[5];
+        for (auto& field : index) {
+            if (!readvarint(cursor, end, field) || field >= strings.size()) {
+                clear();
+                return false;
+            }
+        }
+        
+        store.push({strings[(size_t)index[0]], strings[(size_t)index[1]], strings[(size_t)index[2]], strings[(size_t)index[3]], strings[(size_t)index[4]]});
+    }
+    
+    host = hostname;
+    return true;
+}
+
+bool snapshot::save(const std::string& path) const {
+    std::vector<uint8_t> data = encode();
+    
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    
+    file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+    return file.good();
+}
+
+bool snapshot::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        clear();
+        return false;
+    }
+    
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return decode(data.data(), data.size());
+}
+
+void snapshot::write(resultwriter& writer) const {
+    writer.begin();
+    for (const auto& record : store.records()) {
+        writer.writerecord(record);
+    }
+    writer.end();
+}
+
+struct recordkey {
+    std::string_view section;
+    std::string_view category;
+    std::string_view name;
+    uint32_t instance;
+    
+    bool operator==(const recordkey& other) const {
+        return instance == other.instance && name == other.name && category == other.category && section == other.section;
+    }
+};
+
+struct recordkeyhash {
+    size_t operator()(const recordkey& key) const {
+        std::hash<std::string_view> hash;
+        size_t h = hash(key.section);
+        h = h * 31 + hash(key.category);
+        h = h * 31 + hash(key.name);
+        return h * 31 + key.instance;
+    }
+};
+
+static recordkey makerecordkey(const recordview& record, std::unordered_map<recordkey, uint32_t, recordkeyhash>& ordinals) {
+    recordkey key = {record.section, record.category, record.name, 0};
+    key.instance = ordinals[key]++;
+    return key;
+}
+
+std::vector<snapshotchange> diffsnapshots(const snapshot& baseline, const snapshot& current) {
+    const auto& before = baseline.records().records();
+    const auto& after = current.records().records();
+    
+    std::unordered_map<recordkey, uint32_t, recordkeyhash> ordinals;
+    std::unordered_map<recordkey, size_t, recordkeyhash> index;
+    std::vector<uint32_t> instances(before.size());
+    ordinals.reserve(before.size());
+    index.reserve(before.size());
+    
+    for (size_t i = 0; i < before.size(); i++) {
+        recordkey key = makerecordkey(before[i], ordinals);
+        instances[i] = key.instance;
+        index.emplace(key, i);
+    }
+    
+    std::vector<bool> matched(before.size(), false);
+    std::vector<snapshotchange> changes;
+    ordinals.clear();
+    
+    auto report = [&](snapshotchangekind kind, const recordview& record, uint32_t instance, std::string_view oldvalue, std::string_view newvalue) {
+        changes.push_back({kind, std::string(record.section), std::string(record.category), std::string(record.name), instance,
+            std::string(oldvalue), std::string(newvalue)});
+    };
+    
+    for (const auto& record : after) {
+        recordkey key = makerecordkey(record, ordinals);
+        auto it = index.find(key);
+        
+        if (it == index.end()) {
+            report(snapshotchangekind::added, record, key.instance, {}, record.value);
+            continue;
+        }
+        
+        matched[it->second] = true;
+        const recordview& old = before[it->second];
+        if (old.value != record.value) {
+            report(snapshotchangekind::changed, record, key.instance, old.value, record.value);
+        }
+    }
+    
+    for (size_t i = 0; i < before.size(); i++) {
+        if (matched[i]) continue;
+        report(snapshotchangekind::removed, before[i], instances[i], before[i].value, {});
+    }
+    
+    return changes;
+}
+
+static const char* changekindname(snapshotchangekind kind) {
+    switch (kind) {
+        case snapshotchangekind::added: return "added";
+        case snapshotchangekind::removed: return "removed";
+        case snapshotchangekind::changed: return "changed";
+    }
+    return "";
+}
+
+static void writejsonchange(std::ostream& out, const snapshotchange& change) {
+    out << "{\"change\":\"" << changekindname(change.kind) << "\",\"section\":";
+    writejsonstring(out, change.section);
+    out << ",\"category\":";
+    writejsonstring(out, change.category);
+    out << ",\"name\":";
+    writejsonstring(out, change.name);
+    out << ",\"instance\":" << change.instance << ",\"before\":";
+    writejsonstring(out, change.before);
+    out << ",\"after\":";
+    writejsonstring(out, change.after);
+    out << '}';
+}
+
+void writesnapshotchanges(std::ostream& out, outputformat format, const std::vector<snapshotchange>& changes) {
+    switch (format) {
+        case outputformat::json:
+            out << "[";
+            for (size_t i = 0; i < changes.size(); i++) {
+                out << (i == 0 ? "\n  " : ",\n  ");
+                writejsonchange(out, changes[i]);
+            }
+            out << (changes.empty() ? "]\n" : "\n]\n");
+            break;
+        case outputformat::ndjson:
+            for (const auto& change : changes) {
+                writejsonchange(out, change);
+                out << '\n';
+            }
+            break;
+        case outputformat::csv:
+            out << "change,section,category,name,instance,before,after\r\n";
+            for (const auto& change : changes) {
+                out << changekindname(change.kind) << ',';
+                writecsvfield(out, change.section);
+                out << ',';
+                writecsvfield(out, change.category);
+                out << ',';
+                writecsvfield(out, change.name);
+                out << ',' << change.instance << ',';
+                writecsvfield(out, change.before);
+                out << ',';
+                writecsvfield(out, change.after);
+                out << "\r\n";
+            }
+            break;
+    }
+    out.flush();
+}
+
+std::string currenthostname() {
+#ifdef _WIN32
+    char name[MAX_COMPUTERNAME_LENGTH + 1] = {};
+    DWORD size = sizeof(name);
+    if (GetComputerNameA(name, &size)) return std::string(name, size);
+    return "";
+#else
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) == 0) return name;
+    return "";
+#endif
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "output.h"
+#include "recordstore.h"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class snapshot {
+public:
+    std::string host;
+    uint64_t timestamp = 0;
+    
+    void add(const recordview& record) { store.add(record); }
+    void clear();
+    
+    // drops every record outside the given sections
+    void retain(const std::vector<std::string>& sections);
+    
+    const recordstore& records() const { return store; }
+    size_t size() const { return store.size(); }
+    bool empty() const { return store.empty(); }
+    
+    std::vector<uint8_t> encode() const;
+    bool decode(const uint8_t* data, size_t size);
+    
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+    
+    void write(resultwriter& writer) const;
+
+private:
+    recordstore store;
+};
+
+enum class snapshotchangekind {
+    added,
+    removed,
+    changed
+};
+
+struct snapshotchange {
+    snapshotchangekind kind;
+    std::string section;
+    std::string category;
+    std::string name;
+    uint32_t instance = 0;
+    std::string before;
+    std::string after;
+};
+
+std::vector<snapshotchange> diffsnapshots(const snapshot& baseline, const snapshot& current);
+void writesnapshotchanges(std::ostream& out, outputformat format, const std::vector<snapshotchange>& changes);
+
+std::string currenthostname();
@@ -0,0 +1,61 @@
+#include "sysfs.h"
+#include "textutil.h"
+#include "trace.h"
+#include <cstdio>
+#include <algorithm>
+
+#ifndef _WIN32
+#include <dirent.h>
+#endif
+
+std::vector<uint8_t> readsysfsbinary(const std::string& path, size_t limit) {
+    std::vector<uint8_t> result;
+    tracespan span("sysfs read");
+    
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        span.fail();
+        return result;
+    }
+    
+    uint8_t chunk[4096];
+    while (result.size() < limit) {
+        size_t wanted = std::min(sizeof(chunk), limit - result.size());
+        size_t got = fread(chunk, 1, wanted, file);
+        if (got == 0) break;
+        result.insert(result.end(), chunk, chunk + got);
+    }
+    
+    fclose(file);
+    span.bytes(result.size());
+    return result;
+}
+
+std::string readsysfsstring(const std::string& path) {
+    std::vector<uint8_t> data = readsysfsbinary(path, 4096);
+    
+    return std::string(trimascii(std::string_view(reinterpret_cast<const char*>(data.data()), data.size())));
+}
+
+std::vector<std::string> listsysfsdirectory(const std::string& path) {
+    std::vector<std::string> entries;
+    
+#ifndef _WIN32
+    tracespan span("sysfs list");
+    DIR* directory = opendir(path.c_str());
+    if (!directory) {
+        span.fail();
+        return entries;
+    }
+    
+    while (dirent* entry = readdir(directory)) {
+        if (entry->d_name[0] == '.') continue;
+        entries.push_back(entry->d_name);
+    }
+    
+    closedir(directory);
+    std::sort(entries.begin(), entries.end());
+#endif
+    
+    return entries;
+}
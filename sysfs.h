@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+std::vector<uint8_t> readsysfsbinary(const std::string& path, size_t limit = 1 << 20);
+std::string readsysfsstring(const std::string& path);
+std::vector<std::string> listsysfsdirectory(const std::string& path);
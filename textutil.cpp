@@ -0,0 +1,267 @@
+#include "textutil.h"
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TEXTUTILSSE2
+#endif
+
+std::string widetoutf8(const std::wstring& wide) {
+    std::string result;
+    appendutf8(result, wide);
+    return result;
+}
+
+void appendutf8(std::string& out, std::wstring_view wide) {
+    if (wide.empty()) return;
+    
+#ifdef _WIN32
+    int size = WideCharToMultiByte(CP_UTF8, 0, wide.data(), (int)wide.size(), nullptr, 0, nullptr, nullptr);
+    size_t start = out.size();
+    out.resize(start + size);
+    WideCharToMultiByte(CP_UTF8, 0, wide.data(), (int)wide.size(), &out[start], size, nullptr, nullptr);
+#else
+    out.reserve(out.size() + wide.size());
+    for (wchar_t wc : wide) {
+        uint32_t c = (uint32_t)wc;
+        if (c < 0x80) {
+            out += (char)c;
+        } else if (c < 0x800) {
+            out += (char)(0xC0 | (c >> 6));
+            out += (char)(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            out += (char)(0xE0 | (c >> 12));
+            out += (char)(0x80 | ((c >> 6) & 0x3F));
+            out += (char)(0x80 | (c & 0x3F));
+        } else {
+            out += (char)(0xF0 | (c >> 18));
+            out += (char)(0x80 | ((c >> 12) & 0x3F));
+            out += (char)(0x80 | ((c >> 6) & 0x3F));
+            out += (char)(0x80 | (c & 0x3F));
+        }
+    }
+#endif
+}
+
+std::string_view latin1toutf8(std::string_view text, std::string& scratch) {
+    size_t ascii = 0;
+    while (ascii < text.size() && (uint8_t)text[ascii] < 0x80) ascii++;
+    if (ascii == text.size()) return text;
+    
+    scratch.assign(text.data(), ascii);
+    for (size_t i = ascii; i < text.size(); i++) {
+        uint8_t c = (uint8_t)text[i];
+        if (c < 0x80) {
+            scratch += (char)c;
+        } else {
+            scratch += (char)(0xC0 | (c >> 6));
+            scratch += (char)(0x80 | (c & 0x3F));
+        }
+    }
+    return scratch;
+}
+
+std::wstring utf8towide(std::string_view utf8) {
+    if (utf8.empty()) return L"";
+    
+#ifdef _WIN32
+    int size = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), (int)utf8.size(), nullptr, 0);
+    std::wstring result(size, 0);
+    MultiByteToWideChar(CP_UTF8, 0, utf8.data(), (int)utf8.size(), &result[0], size);
+    return result;
+#else
+    std::wstring result;
+    result.reserve(utf8.size());
+    size_t i = 0;
+    while (i < utf8.size()) {
+        uint8_t lead = (uint8_t)utf8[i];
+        size_t extra = lead < 0x80 ? 0 : (lead >> 5) == 0x6 ? 1 : (lead >> 4) == 0xE ? 2 : (lead >> 3) == 0x1E ? 3 : 0;
+        uint32_t c = extra == 0 ? lead : extra == 1 ? (lead & 0x1F) : extra == 2 ? (lead & 0x0F) : (lead & 0x07);
+        
+        if (lead >= 0x80 && extra == 0) {
+            result += (wchar_t)0xFFFD;
+            i++;
+            continue;
+        }
+        
+        size_t j = 1;
+        for (; j <= extra && i + j < utf8.size() && ((uint8_t)utf8[i + j] & 0xC0) == 0x80; j++) {
+            c = (c << 6) | ((uint8_t)utf8[i + j] & 0x3F);
+        }
+        
+        result += j == extra + 1 ? (wchar_t)c : (wchar_t)0xFFFD;
+        i += j;
+    }
+    return result;
+#endif
+}
+
+static const char lowerhex[] = "0123456789abcdef";
+static const char upperhex[] = "0123456789ABCDEF";
+
+#ifdef TEXTUTILSSE2
+static __m128i hexdigits(__m128i nibbles, __m128i letters) {
+    __m128i digits = _mm_add_epi8(nibbles, _mm_set1_epi8('0'));
+    return _mm_add_epi8(digits, _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), letters));
+}
+#endif
+
+size_t hexencode(const uint8_t* data, size_t size, char* out, size_t capacity, bool uppercase) {
+    if (capacity < size * 2 + 1) return 0;
+    
+    const char* digits = uppercase ? upperhex : lowerhex;
+    size_t i = 0;
+    
+#ifdef TEXTUTILSSE2
+    // sixteen bytes a round: split the nibbles, turn each into '0' + n, lift the ones past 9 into the
+    // letters, then interleave high and low back into byte order
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    const __m128i letters = _mm_set1_epi8((char)((uppercase ? 'A' : 'a') - '0' - 10));
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i high = hexdigits(_mm_and_si128(_mm_srli_epi16(bytes, 4), mask), letters);
+        __m128i low = hexdigits(_mm_and_si128(bytes, mask), letters);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2 + 16), _mm_unpackhi_epi8(high, low));
+    }
+#endif
+    
+    for (; i < size; i++) {
+        out[i * 2] = digits[data[i] >> 4];
+        out[i * 2 + 1] = digits[data[i] & 0xF];
+    }
+    out[size * 2] = 0;
+    return size * 2;
+}
+
+size_t formatuuidtext(const uint8_t* uuid, char* out, size_t capacity) {
+    if (capacity < 37) return 0;
+    
+    // smbios byte order as stored, the way the tool has always printed it
+    char hex[33];
+    hexencode(uuid, 16, hex, sizeof(hex), true);
+    memcpy(out, hex, 8);
+    out[8] = '-';
+    memcpy(out + 9, hex + 8, 4);
+    out[13] = '-';
+    memcpy(out + 14, hex + 12, 4);
+    out[18] = '-';
+    memcpy(out + 19, hex + 16, 4);
+    out[23] = '-';
+    memcpy(out + 24, hex + 20, 12);
+    out[36] = 0;
+    return 36;
+}
+
+size_t formatmactext(const uint8_t* mac, size_t size, char* out, size_t capacity) {
+    if (capacity < size * 3 + 1) return 0;
+    
+    size_t length = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (i > 0) out[length++] = ':';
+        out[length++] = lowerhex[mac[i] >> 4];
+        out[length++] = lowerhex[mac[i] & 0xF];
+    }
+    out[length] = 0;
+    return length;
+}
+
+static size_t putdecimal(char* out, unsigned value) {
+    if (value >= 100) {
+        out[0] = (char)('0' + value / 100);
+        out[1] = (char)('0' + value / 10 % 10);
+        out[2] = (char)('0' + value % 10);
+        return 3;
+    }
+    if (value >= 10) {
+        out[0] = (char)('0' + value / 10);
+        out[1] = (char)('0' + value % 10);
+        return 2;
+    }
+    out[0] = (char)('0' + value);
+    return 1;
+}
+
+static size_t puthexgroup(char* out, unsigned value) {
+    size_t length = 0;
+    bool started = false;
+    for (int shift = 12; shift >= 0; shift -= 4) {
+        unsigned digit = (value >> shift) & 0xF;
+        if (digit == 0 && !started && shift > 0) continue;
+        started = true;
+        out[length++] = lowerhex[digit];
+    }
+    return length;
+}
+
+size_t formatipv4text(const uint8_t* address, char* out, size_t capacity) {
+    if (capacity < 16) return 0;
+    
+    size_t length = 0;
+    for (int i = 0; i < 4; i++) {
+        if (i > 0) out[length++] = '.';
+        length += putdecimal(out + length, address[i]);
+    }
+    out[length] = 0;
+    return length;
+}
+
+size_t formatipv6text(const uint8_t* address, char* out, size_t capacity) {
+    if (capacity < 46) return 0;
+    
+    unsigned groups[8];
+    for (int i = 0; i < 8; i++) {
+        groups[i] = ((unsigned)address[i * 2] << 8) | address[i * 2 + 1];
+    }
+    
+    // rfc 5952: collapse the longest run of two or more zero groups, the first one on ties
+    int beststart = -1;
+    int bestlength = 1;
+    for (int i = 0; i < 8;) {
+        if (groups[i] != 0) { i++; continue; }
+        int start = i;
+        while (i < 8 && groups[i] == 0) i++;
+        if (i - start > bestlength) {
+            beststart = start;
+            bestlength = i - start;
+        }
+    }
+    
+    size_t length = 0;
+    for (int i = 0; i < 8; i++) {
+        if (i == beststart) {
+            out[length++] = ':';
+            out[length++] = ':';
+            i += bestlength - 1;
+            continue;
+        }
+        if (i > 0 && i != beststart + bestlength) out[length++] = ':';
+        length += puthexgroup(out + length, groups[i]);
+    }
+    
+    out[length] = 0;
+    return length;
+}
+
+template <typename character>
+static std::basic_string_view<character> trimmed(std::basic_string_view<character> text) {
+    auto space = [](character c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; };
+    size_t start = 0;
+    size_t end = text.size();
+    while (start < end && space(text[start])) start++;
+    while (end > start && space(text[end - 1])) end--;
+    return text.substr(start, end - start);
+}
+
+std::string_view trimascii(std::string_view text) {
+    return trimmed(text);
+}
+
+std::wstring_view trimascii(std::wstring_view text) {
+    return trimmed(text);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+std::string widetoutf8(const std::wstring& wide);
+void appendutf8(std::string& out, std::wstring_view wide);
+std::wstring utf8towide(std::string_view utf8);
+
+// firmware and descriptor strings are single bytes, taken as latin-1; plain ascii comes back as it is and
+// anything else is converted into scratch
+std::string_view latin1toutf8(std::string_view text, std::string& scratch);
+
+// the formatters write into the caller's buffer and never allocate; each nul terminates and returns
+// the characters written, or 0 when the buffer is too small
+size_t hexencode(const uint8_t* data, size_t size, char* out, size_t capacity, bool uppercase);
+size_t formatuuidtext(const uint8_t* uuid, char* out, size_t capacity);
+size_t formatmactext(const uint8_t* mac, size_t size, char* out, size_t capacity);
+size_t formatipv4text(const uint8_t* address, char* out, size_t capacity);
+size_t formatipv6text(const uint8_t* address, char* out, size_t capacity);
+
+// ascii only, which is all the c locale the tool runs in ever folded
+template <typename character>
+constexpr character asciilower(character c) {
+    return c >= 'A' && c <= 'Z' ? (character)(c + ('a' - 'A')) : c;
+}
+
+template <typename character>
+constexpr character asciiupper(character c) {
+    return c >= 'a' && c <= 'z' ? (character)(c - ('a' - 'A')) : c;
+}
+
+template <typename character>
+void asciilower(std::basic_string<character>& text) {
+    for (auto& c : text) c = asciilower(c);
+}
+
+template <typename character>
+void asciiupper(std::basic_string<character>& text) {
+    for (auto& c : text) c = asciiupper(c);
+}
+
+// strips spaces, tabs and line breaks from both ends
+std::string_view trimascii(std::string_view text);
+std::wstring_view trimascii(std::wstring_view text);
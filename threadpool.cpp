@@ -0,0 +1,111 @@
+#include "threadpool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+threadpool::threadpool(size_t threadcount) {
+    if (threadcount == 0) threadcount = defaultthreadcount();
+    
+    workers.reserve(threadcount);
+    for (size_t i = 0; i < threadcount; i++) {
+        workers.emplace_back([this] { workerloop(); });
+    }
+}
+
+threadpool::~threadpool() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    taskready.notify_all();
+    
+    for (auto& worker : workers) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+size_t threadpool::defaultthreadcount() {
+    size_t count = std::thread::hardware_concurrency();
+    return count > 0 ? count : 4;
+}
+
+void threadpool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.push_back(std::move(task));
+        pending++;
+    }
+    taskready.notify_one();
+}
+
+void threadpool::wait() {
+    std::unique_lock<std::mutex> guard(lock);
+    idle.wait(guard, [this] { return pending == 0; });
+    
+    if (failure) {
+        std::exception_ptr first = failure;
+        failure = nullptr;
+        std::rethrow_exception(first);
+    }
+}
+
+void threadpool::parallelfor(size_t count, const std::function<void(size_t worker, size_t index)>& body) {
+    if (count == 0) return;
+    
+    struct lane {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+    };
+    
+    size_t lanecount = std::min(std::max<size_t>(workers.size(), 1), count);
+    std::unique_ptr<lane[]> lanes(new lane[lanecount]);
+    for (size_t i = 0; i < lanecount; i++) {
+        lanes[i].next = count * i / lanecount;
+        lanes[i].end = count * (i + 1) / lanecount;
+    }
+    
+    for (size_t worker = 0; worker < lanecount; worker++) {
+        submit([&, worker] {
+            for (size_t offset = 0; offset < lanecount; offset++) {
+                lane& victim = lanes[(worker + offset) % lanecount];
+                
+                while (true) {
+                    size_t index = victim.next.fetch_add(1, std::memory_order_relaxed);
+                    if (index >= victim.end) break;
+                    body(worker, index);
+                }
+            }
+        });
+    }
+    
+    wait();
+}
+
+void threadpool::workerloop() {
+    while (true) {
+        std::function<void()> task;
+        
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            taskready.wait(guard, [this] { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        
+        std::exception_ptr thrown;
+        try {
+            task();
+        } catch (...) {
+            thrown = std::current_exception();
+        }
+        
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            if (thrown && !failure) failure = thrown;
+            pending--;
+            if (pending == 0) idle.notify_all();
+        }
+    }
+}
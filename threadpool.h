@@ -0,0 +1,40 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <vector>
+
+class threadpool {
+public:
+    explicit threadpool(size_t threadcount = 0);
+    ~threadpool();
+    
+    threadpool(const threadpool&) = delete;
+    threadpool& operator=(const threadpool&) = delete;
+    
+    void submit(std::function<void()> task);
+    
+    // rethrows the first exception a task let escape since the last wait
+    void wait();
+    void parallelfor(size_t count, const std::function<void(size_t worker, size_t index)>& body);
+    
+    size_t size() const { return workers.size(); }
+    
+    static size_t defaultthreadcount();
+
+private:
+    void workerloop();
+    
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable taskready;
+    std::condition_variable idle;
+    size_t pending = 0;
+    bool stopping = false;
+    std::exception_ptr failure;
+};
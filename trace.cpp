@@ -0,0 +1,126 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> tracing{false};
+
+struct traceevent {
+    std::string name;
+    const char* category;
+    uint64_t start;
+    uint64_t end;
+    size_t bytes;
+    bool failed;
+};
+
+// each thread appends to its own buffer; the lock is only taken the first time a thread records
+struct tracebuffer {
+    uint32_t thread;
+    std::vector<traceevent> events;
+};
+
+static std::chrono::steady_clock::time_point traceorigin;
+static std::mutex bufferlock;
+static std::vector<std::unique_ptr<tracebuffer>> buffers;
+static thread_local tracebuffer* localbuffer = nullptr;
+
+static uint64_t tracenow() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - traceorigin).count() + 1;
+}
+
+void starttrace() {
+    traceorigin = std::chrono::steady_clock::now();
+    tracing.store(true);
+}
+
+void tracespan::begin() {
+    start = tracenow();
+}
+
+void tracespan::end() {
+    uint64_t finish = tracenow();
+    
+    if (!localbuffer) {
+        std::lock_guard<std::mutex> guard(bufferlock);
+        buffers.push_back(std::make_unique<tracebuffer>());
+        buffers.back()->thread = (uint32_t)buffers.size();
+        localbuffer = buffers.back().get();
+    }
+    localbuffer->events.push_back({name, category, start, finish, transferred, failed});
+}
+
+static void writejsonstring(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if ((unsigned char)c < 0x20) out << ' ';
+        else out << c;
+    }
+    out << '"';
+}
+
+static void writemicroseconds(std::ostream& out, uint64_t nanoseconds) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%llu.%03llu", (unsigned long long)(nanoseconds / 1000), (unsigned long long)(nanoseconds % 1000));
+    out << buffer;
+}
+
+struct tracecounter {
+    uint64_t calls = 0;
+    uint64_t bytes = 0;
+    uint64_t failures = 0;
+    uint64_t nanoseconds = 0;
+};
+
+bool writetrace(const std::string& path) {
+    tracing.store(false);
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+    
+    std::lock_guard<std::mutex> guard(bufferlock);
+    std::map<std::string, tracecounter> counters;
+    bool first = true;
+    
+    out << "{\"traceEvents\":[";
+    for (const auto& buffer : buffers) {
+        out << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->thread
+            << ",\"args\":{\"name\":\"thread " << buffer->thread << "\"}}";
+        first = false;
+        
+        for (const auto& event : buffer->events) {
+            out << ",\n{\"name\":";
+            writejsonstring(out, event.name);
+            out << ",\"cat\":\"" << event.category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread << ",\"ts\":";
+            writemicroseconds(out, event.start);
+            out << ",\"dur\":";
+            writemicroseconds(out, event.end - event.start);
+            out << ",\"args\":{\"bytes\":" << event.bytes << ",\"failed\":" << (event.failed ? 1 : 0) << "}}";
+            
+            tracecounter& counter = counters[event.name];
+            counter.calls++;
+            counter.bytes += event.bytes;
+            counter.failures += event.failed ? 1 : 0;
+            counter.nanoseconds += event.end - event.start;
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{";
+    
+    first = true;
+    for (const auto& [name, counter] : counters) {
+        out << (first ? "\n" : ",\n");
+        writejsonstring(out, name);
+        out << ":{\"calls\":" << counter.calls << ",\"bytes\":" << counter.bytes << ",\"failures\":" << counter.failures << ",\"us\":";
+        writemicroseconds(out, counter.nanoseconds);
+        out << "}";
+        first = false;
+    }
+    out << "\n}}\n";
+    
+    return out.good();
+}
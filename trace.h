@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// a single relaxed load is all a span costs while tracing is off
+extern std::atomic<bool> tracing;
+
+void starttrace();
+bool writetrace(const std::string& path);
+
+class tracespan {
+public:
+    explicit tracespan(const char* name, const char* category = "os") : name(name), category(category) {
+        if (tracing.load(std::memory_order_relaxed)) begin();
+    }
+    
+    ~tracespan() {
+        if (start) end();
+    }
+    
+    tracespan(const tracespan&) = delete;
+    tracespan& operator=(const tracespan&) = delete;
+    
+    void bytes(size_t count) { transferred += count; }
+    void fail() { failed = true; }
+    
+    bool check(bool ok) {
+        if (!ok) failed = true;
+        return ok;
+    }
+
+private:
+    void begin();
+    void end();
+    
+    const char* name;
+    const char* category;
+    uint64_t start = 0;
+    size_t transferred = 0;
+    bool failed = false;
+};
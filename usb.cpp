@@ -0,0 +1,247 @@
+#include "usb.h"
+#include "sysfs.h"
+#include "textutil.h"
+#include "trace.h"
+#include <cwchar>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <setupapi.h>
+#include <cfgmgr32.h>
+
+#pragma comment(lib, "setupapi.lib")
+#pragma comment(lib, "cfgmgr32.lib")
+#endif
+
+std::wstring extractserialfrominstance(const std::wstring& instanceid, bool isusbstor) {
+    if (instanceid.empty()) return L"";
+    
+    size_t idx = instanceid.rfind(L'\\');
+    std::wstring tail = (idx != std::wstring::npos) ? instanceid.substr(idx + 1) : instanceid;
+    
+    if (isusbstor) {
+        // a real serial only carries the lun suffix; generated ids look like 7&2a1b3c&0
+        size_t amp = tail.find(L'&');
+        if (amp != std::wstring::npos && tail.find(L'&', amp + 1) != std::wstring::npos) return L"";
+        
+        std::wstring serial = tail;
+        if (amp != std::wstring::npos && amp > 0) {
+            serial = serial.substr(0, amp);
+        }
+        
+        serial = std::wstring(trimascii(serial));
+        if (serial.empty()) return L"";
+        
+        bool allzeros = true;
+        for (wchar_t c : serial) {
+            if (c != L'0') { allzeros = false; break; }
+        }
+        if (allzeros) return L"";
+        
+        return serial;
+    } else {
+        if (tail.find(L'&') != std::wstring::npos) return L"";
+        return std::wstring(trimascii(tail));
+    }
+}
+
+static bool parsehex16(const wchar_t* text, size_t length, uint16_t& value) {
+    if (length < 4) return false;
+    
+    uint16_t result = 0;
+    for (size_t i = 0; i < 4; i++) {
+        wchar_t c = text[i];
+        int digit;
+        if (c >= L'0' && c <= L'9') digit = c - L'0';
+        else if (c >= L'a' && c <= L'f') digit = c - L'a' + 10;
+        else if (c >= L'A' && c <= L'F') digit = c - L'A' + 10;
+        else return false;
+        result = (uint16_t)((result << 4) | digit);
+    }
+    
+    value = result;
+    return true;
+}
+
+static bool findusbfield(const std::wstring& hardwareid, const wchar_t* tag, uint16_t& value) {
+    for (size_t i = 0; i + 4 <= hardwareid.size(); i++) {
+        if (i > 0 && hardwareid[i - 1] != L'\\' && hardwareid[i - 1] != L'&') continue;
+        
+        bool match = true;
+        for (size_t j = 0; j < 4; j++) {
+            if (asciiupper(hardwareid[i + j]) != tag[j]) { match = false; break; }
+        }
+        
+        if (match) return parsehex16(hardwareid.c_str() + i + 4, hardwareid.size() - i - 4, value);
+    }
+    return false;
+}
+
+bool parseusbhardwareid(const std::wstring& hardwareid, usbdevice& device) {
+    uint16_t vendor = 0;
+    uint16_t product = 0;
+    if (!findusbfield(hardwareid, L"VID_", vendor) || !findusbfield(hardwareid, L"PID_", product)) return false;
+    
+    device.vendorid = vendor;
+    device.productid = product;
+    findusbfield(hardwareid, L"REV_", device.revision);
+    device.hasids = true;
+    return true;
+}
+
+std::wstring usbidstring(const usbdevice& device) {
+    if (!device.hasids) return L"";
+    
+    wchar_t buffer[32];
+    swprintf(buffer, 32, L"VID_%04X&PID_%04X&REV_%04X", device.vendorid, device.productid, device.revision);
+    return buffer;
+}
+
+static bool parsesysfshex(const std::string& text, uint16_t& value) {
+    std::wstring wide = utf8towide(text);
+    return wide.size() == 4 && parsehex16(wide.c_str(), wide.size(), value);
+}
+
+// windows only keeps a descriptor serial as the instance id tail when every character is printable and not a comma
+static bool instanceserial(const std::string& serial) {
+    if (serial.empty()) return false;
+    for (unsigned char c : serial) {
+        if (c < 0x20 || c > 0x7F || c == ',') return false;
+    }
+    return true;
+}
+
+std::vector<usbdevice> readsysfsusbdevices(const std::string& root) {
+    std::vector<usbdevice> devices;
+    std::vector<std::string> entries = listsysfsdirectory(root);
+    
+    std::unordered_set<std::string> storage;
+    for (const auto& entry : entries) {
+        size_t colon = entry.find(':');
+        if (colon == std::string::npos) continue;
+        if (readsysfsstring(root + "/" + entry + "/bInterfaceClass") == "08") storage.insert(entry.substr(0, colon));
+    }
+    
+    for (const auto& entry : entries) {
+        if (entry.find(':') != std::string::npos) continue;
+        
+        std::string base = root + "/" + entry + "/";
+        usbdevice device;
+        if (!parsesysfshex(readsysfsstring(base + "idVendor"), device.vendorid) ||
+            !parsesysfshex(readsysfsstring(base + "idProduct"), device.productid)) {
+            continue;
+        }
+        parsesysfshex(readsysfsstring(base + "bcdDevice"), device.revision);
+        device.hasids = true;
+        
+        // the kernel hands descriptor strings over as utf-8
+        std::string product = readsysfsstring(base + "product");
+        device.name = product.empty() ? L"USB Device" : utf8towide(product);
+        
+        // root hubs report their pci address as a serial
+        std::string serial = entry.rfind("usb", 0) == 0 ? "" : readsysfsstring(base + "serial");
+        bool hasserial = instanceserial(serial);
+        
+        wchar_t prefix[32];
+        swprintf(prefix, 32, L"USB\\VID_%04X&PID_%04X\\", device.vendorid, device.productid);
+        device.instanceid = prefix + utf8towide(hasserial ? serial : entry);
+        if (hasserial) device.serial = extractserialfrominstance(device.instanceid, false);
+        
+        if (storage.count(entry)) {
+            std::string manufacturer = readsysfsstring(base + "manufacturer");
+            
+            usbdevice disk = device;
+            disk.storage = true;
+            disk.name = utf8towide(manufacturer.empty() ? product : manufacturer + " " + product) + L" USB Device";
+            disk.instanceid = L"USBSTOR\\Disk\\" + utf8towide(hasserial ? serial + "&0" : entry);
+            disk.serial = hasserial ? extractserialfrominstance(disk.instanceid, true) : L"";
+            
+            devices.push_back(std::move(device));
+            devices.push_back(std::move(disk));
+        } else {
+            devices.push_back(std::move(device));
+        }
+    }
+    
+    return devices;
+}
+
+#ifdef _WIN32
+static std::wstring deviceproperty(HDEVINFO deviceinfoset, SP_DEVINFO_DATA& deviceinfodata, DWORD property) {
+    tracespan span("SetupDiGetDeviceRegistryPropertyW");
+    wchar_t buffer[512] = {};
+    DWORD size = 0;
+    if (!SetupDiGetDeviceRegistryPropertyW(deviceinfoset, &deviceinfodata, property,
+        nullptr, reinterpret_cast<PBYTE>(buffer), sizeof(buffer) - sizeof(wchar_t), &size)) {
+        span.fail();
+        return L"";
+    }
+    span.bytes(size);
+    return buffer;
+}
+
+static void parentids(DEVINST instance, usbdevice& device) {
+    tracespan span("CM_Get_Parent hardware id");
+    DEVINST parent = 0;
+    if (!span.check(CM_Get_Parent(&parent, instance, 0) == CR_SUCCESS)) return;
+    
+    wchar_t buffer[512] = {};
+    ULONG size = sizeof(buffer) - sizeof(wchar_t);
+    if (span.check(CM_Get_DevNode_Registry_PropertyW(parent, CM_DRP_HARDWAREID, nullptr, buffer, &size, 0) == CR_SUCCESS)) {
+        span.bytes(size);
+        parseusbhardwareid(buffer, device);
+    }
+}
+
+bool enumerateusbdevices(std::vector<usbdevice>& devices) {
+    std::unordered_set<std::wstring> seen;
+    bool enumerated = false;
+    
+    SP_DEVINFO_DATA deviceinfodata;
+    deviceinfodata.cbSize = sizeof(SP_DEVINFO_DATA);
+    wchar_t instanceidbuf[512];
+    
+    for (const wchar_t* enumerator : {L"USB", L"USBSTOR"}) {
+        tracespan span("SetupDi usb devices");
+        HDEVINFO deviceinfoset = SetupDiGetClassDevsW(nullptr, enumerator, nullptr, DIGCF_PRESENT | DIGCF_ALLCLASSES);
+        if (!span.check(deviceinfoset != INVALID_HANDLE_VALUE)) continue;
+        enumerated = true;
+        
+        bool isusbstor = wcscmp(enumerator, L"USBSTOR") == 0;
+        
+        for (DWORD i = 0; SetupDiEnumDeviceInfo(deviceinfoset, i, &deviceinfodata); i++) {
+            if (!SetupDiGetDeviceInstanceIdW(deviceinfoset, &deviceinfodata, instanceidbuf, 512, nullptr)) {
+                continue;
+            }
+            
+            std::wstring instanceid(instanceidbuf);
+            if (!seen.insert(instanceid).second) continue;
+            
+            usbdevice device;
+            device.storage = isusbstor;
+            device.name = deviceproperty(deviceinfoset, deviceinfodata, SPDRP_FRIENDLYNAME);
+            if (device.name.empty()) device.name = deviceproperty(deviceinfoset, deviceinfodata, SPDRP_DEVICEDESC);
+            
+            if (isusbstor) {
+                parentids(deviceinfodata.DevInst, device);
+            } else {
+                parseusbhardwareid(deviceproperty(deviceinfoset, deviceinfodata, SPDRP_HARDWAREID), device);
+            }
+            
+            device.serial = extractserialfrominstance(instanceid, isusbstor);
+            device.instanceid = std::move(instanceid);
+            devices.push_back(std::move(device));
+        }
+        
+        SetupDiDestroyDeviceInfoList(deviceinfoset);
+    }
+    
+    return enumerated;
+}
+#else
+bool enumerateusbdevices(std::vector<usbdevice>& devices) {
+    devices = readsysfsusbdevices("/sys/bus/usb/devices");
+    return true;
+}
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct usbdevice {
+    std::wstring instanceid;
+    std::wstring name;
+    std::wstring serial;
+    uint16_t vendorid = 0;
+    uint16_t productid = 0;
+    uint16_t revision = 0;
+    bool hasids = false;
+    bool storage = false;
+};
+
+std::wstring extractserialfrominstance(const std::wstring& instanceid, bool isusbstor);
+bool parseusbhardwareid(const std::wstring& hardwareid, usbdevice& device);
+std::wstring usbidstring(const usbdevice& device);
+
+std::vector<usbdevice> readsysfsusbdevices(const std::string& root);
+bool enumerateusbdevices(std::vector<usbdevice>& devices);
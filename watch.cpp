@@ -0,0 +1,277 @@
+#include "watch.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <cfgmgr32.h>
+
+#pragma comment(lib, "cfgmgr32.lib")
+#else
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#endif
+
+// burst of events from one plug or one link flap are folded into a single re-collection
+static const int settlems = 100;
+static const int settlelimitms = 400;
+
+unsigned classifyuevent(const char* data, size_t size) {
+    unsigned mask = 0;
+    size_t cursor = 0;
+    
+    while (cursor < size) {
+        const char* field = data + cursor;
+        size_t length = strnlen(field, size - cursor);
+        std::string_view text(field, length);
+        cursor += length + 1;
+        
+        if (text.rfind("SUBSYSTEM=", 0) != 0) continue;
+        std::string_view subsystem = text.substr(10);
+        
+        if (subsystem == "usb") mask |= watchusb;
+        else if (subsystem == "block") mask |= watchdisk;
+        else if (subsystem == "drm") mask |= watchmonitor;
+        else if (subsystem == "net") mask |= watchnic | watcharp;
+    }
+    
+    return mask;
+}
+
+unsigned classifyroutemessages(const uint8_t* data, size_t size) {
+    unsigned mask = 0;
+    size_t cursor = 0;
+    
+    while (cursor + 16 <= size) {
+        uint32_t length;
+        uint16_t type;
+        memcpy(&length, data + cursor, sizeof(length));
+        memcpy(&type, data + cursor + 4, sizeof(type));
+        if (length < 16 || cursor + length > size) break;
+        
+        // rtm_newlink/dellink and rtm_newneigh/delneigh
+        if (type == 16 || type == 17) mask |= watchnic | watcharp;
+        else if (type == 28 || type == 29) mask |= watcharp;
+        
+        cursor += (length + 3) & ~(size_t)3;
+    }
+    
+    return mask;
+}
+
+#ifdef _WIN32
+static const GUID usbinterface = {0xA5DCBF10, 0x6530, 0x11D2, {0x90, 0x1F, 0x00, 0xC0, 0x4F, 0xB9, 0x51, 0xED}};
+static const GUID diskinterface = {0x53F56307, 0xB6BF, 0x11D0, {0x94, 0xF2, 0x00, 0xA0, 0xC9, 0x1E, 0xFB, 0x8B}};
+static const GUID monitorinterface = {0xE6F07B5F, 0xEE97, 0x4A90, {0xB0, 0x76, 0x33, 0xF5, 0x7B, 0xF4, 0xEA, 0xA7}};
+
+struct registrywatch {
+    const wchar_t* path;
+    unsigned mask;
+    HKEY key;
+    HANDLE event;
+};
+
+struct devicenotify {
+    std::atomic<unsigned> pending{0};
+    HANDLE wake = nullptr;
+};
+
+struct changewatcher::subscriptions {
+    HCMNOTIFICATION notification = nullptr;
+    devicenotify devices;
+    std::vector<registrywatch> keys;
+};
+
+static DWORD CALLBACK ondeviceinterface(HCMNOTIFICATION, PVOID context, CM_NOTIFY_ACTION action, PCM_NOTIFY_EVENT_DATA data, DWORD) {
+    if (action != CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL && action != CM_NOTIFY_ACTION_DEVICEINTERFACEREMOVAL) return ERROR_SUCCESS;
+    
+    auto state = static_cast<devicenotify*>(context);
+    const GUID& interfaceclass = data->u.DeviceInterface.ClassGuid;
+    
+    unsigned mask = 0;
+    if (IsEqualGUID(interfaceclass, usbinterface)) mask = watchusb;
+    else if (IsEqualGUID(interfaceclass, diskinterface)) mask = watchdisk;
+    else if (IsEqualGUID(interfaceclass, monitorinterface)) mask = watchmonitor;
+    
+    if (mask) {
+        state->pending.fetch_or(mask);
+        SetEvent(state->wake);
+    }
+    return ERROR_SUCCESS;
+}
+
+static bool armregistrywatch(registrywatch& watch) {
+    return RegNotifyChangeKeyValue(watch.key, TRUE, REG_NOTIFY_CHANGE_NAME | REG_NOTIFY_CHANGE_LAST_SET, watch.event, TRUE) == ERROR_SUCCESS;
+}
+
+bool changewatcher::start() {
+    stop();
+    active = std::make_unique<subscriptions>();
+    
+    active->devices.wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (!active->devices.wake) {
+        active.reset();
+        return false;
+    }
+    
+    CM_NOTIFY_FILTER filter = {};
+    filter.cbSize = sizeof(filter);
+    filter.Flags = CM_NOTIFY_FILTER_FLAG_ALL_INTERFACE_CLASSES;
+    filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+    bool devices = CM_Register_Notification(&filter, &active->devices, ondeviceinterface, &active->notification) == CR_SUCCESS;
+    
+    const registrywatch watches[] = {
+        {L"SYSTEM\\CurrentControlSet\\Enum\\DISPLAY", watchmonitor, nullptr, nullptr},
+        {L"SYSTEM\\CurrentControlSet\\Services\\Tcpip\\Parameters\\Interfaces", watcharp | watchnic, nullptr, nullptr},
+        {L"SYSTEM\\CurrentControlSet\\Control\\Class\\{4D36E972-E325-11CE-BFC1-08002BE10318}", watchnic, nullptr, nullptr},
+    };
+    
+    for (registrywatch watch : watches) {
+        if (RegOpenKeyExW(HKEY_LOCAL_MACHINE, watch.path, 0, KEY_NOTIFY, &watch.key) != ERROR_SUCCESS) continue;
+        watch.event = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+        if (!watch.event || !armregistrywatch(watch)) {
+            if (watch.event) CloseHandle(watch.event);
+            RegCloseKey(watch.key);
+            continue;
+        }
+        active->keys.push_back(watch);
+    }
+    
+    if (!devices && active->keys.empty()) {
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void changewatcher::stop() {
+    if (!active) return;
+    
+    if (active->notification) CM_Unregister_Notification(active->notification);
+    for (auto& watch : active->keys) {
+        RegCloseKey(watch.key);
+        CloseHandle(watch.event);
+    }
+    if (active->devices.wake) CloseHandle(active->devices.wake);
+    active.reset();
+}
+
+unsigned changewatcher::pollonce(int timeoutms) {
+    if (!active) return 0;
+    
+    std::vector<HANDLE> handles = {active->devices.wake};
+    for (const auto& watch : active->keys) handles.push_back(watch.event);
+    
+    DWORD result = WaitForMultipleObjects((DWORD)handles.size(), handles.data(), FALSE, timeoutms < 0 ? INFINITE : (DWORD)timeoutms);
+    if (result == WAIT_TIMEOUT || result == WAIT_FAILED) return 0;
+    
+    unsigned mask = active->devices.pending.exchange(0);
+    for (size_t i = 0; i < active->keys.size(); i++) {
+        registrywatch& watch = active->keys[i];
+        if (result == WAIT_OBJECT_0 + 1 + i || WaitForSingleObject(watch.event, 0) == WAIT_OBJECT_0) {
+            mask |= watch.mask;
+            armregistrywatch(watch);
+        }
+    }
+    return mask;
+}
+#else
+struct changewatcher::subscriptions {
+    int uevents = -1;
+    int routes = -1;
+    std::vector<uint8_t> buffer = std::vector<uint8_t>(1 << 16);
+};
+
+static int opennetlink(int protocol, uint32_t groups) {
+    int sock = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, protocol);
+    if (sock < 0) return -1;
+    
+    sockaddr_nl address = {};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = groups;
+    if (bind(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+bool changewatcher::start() {
+    stop();
+    active = std::make_unique<subscriptions>();
+    
+    active->uevents = opennetlink(NETLINK_KOBJECT_UEVENT, 1);
+    active->routes = opennetlink(NETLINK_ROUTE, RTMGRP_LINK | RTMGRP_NEIGH);
+    
+    if (active->uevents < 0 && active->routes < 0) {
+        active.reset();
+        return false;
+    }
+    return true;
+}
+
+void changewatcher::stop() {
+    if (!active) return;
+    
+    if (active->uevents >= 0) close(active->uevents);
+    if (active->routes >= 0) close(active->routes);
+    active.reset();
+}
+
+unsigned changewatcher::pollonce(int timeoutms) {
+    if (!active) return 0;
+    
+    pollfd sockets[2] = {{active->uevents, POLLIN, 0}, {active->routes, POLLIN, 0}};
+    if (poll(sockets, 2, timeoutms) <= 0) return 0;
+    
+    unsigned mask = 0;
+    for (const auto& entry : sockets) {
+        if (entry.fd < 0 || !(entry.revents & POLLIN)) continue;
+        
+        ssize_t received;
+        while ((received = recv(entry.fd, active->buffer.data(), active->buffer.size(), 0)) > 0) {
+            if (entry.fd == active->uevents) {
+                mask |= classifyuevent(reinterpret_cast<const char*>(active->buffer.data()), (size_t)received);
+            } else {
+                mask |= classifyroutemessages(active->buffer.data(), (size_t)received);
+            }
+        }
+        
+        // the kernel dropped messages for us; assume everything this socket covers changed
+        if (received < 0 && errno == ENOBUFS) {
+            mask |= entry.fd == active->uevents ? watchusb | watchdisk | watchmonitor : watcharp | watchnic;
+        }
+    }
+    return mask;
+}
+#endif
+
+changewatcher::changewatcher() = default;
+
+changewatcher::~changewatcher() {
+    stop();
+}
+
+unsigned changewatcher::wait(int timeoutms) {
+    unsigned mask = pollonce(timeoutms);
+    if (!mask) return 0;
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(settlelimitms);
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0) break;
+        
+        unsigned more = pollonce((int)std::min<long long>(settlems, remaining));
+        if (!more) break;
+        mask |= more;
+    }
+    return mask;
+}
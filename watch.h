@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+const unsigned watchusb = 1 << 0;
+const unsigned watchdisk = 1 << 1;
+const unsigned watchmonitor = 1 << 2;
+const unsigned watcharp = 1 << 3;
+const unsigned watchnic = 1 << 4;
+
+unsigned classifyuevent(const char* data, size_t size);
+unsigned classifyroutemessages(const uint8_t* data, size_t size);
+
+class changewatcher {
+public:
+    changewatcher();
+    ~changewatcher();
+    
+    changewatcher(const changewatcher&) = delete;
+    changewatcher& operator=(const changewatcher&) = delete;
+    
+    bool start();
+    void stop();
+    
+    unsigned wait(int timeoutms);
+
+private:
+    unsigned pollonce(int timeoutms);
+    
+    struct subscriptions;
+    std::unique_ptr<subscriptions> active;
+};
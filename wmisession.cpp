@@ -0,0 +1,222 @@
+#include "wmisession.h"
+#include "trace.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <wbemidl.h>
+#include <comdef.h>
+
+#pragma comment(lib, "wbemuuid.lib")
+
+class comwmiprovider : public wmiprovider {
+public:
+    ~comwmiprovider() override;
+    
+    bool connect() override;
+    bool query(const std::wstring& wmiclass, const std::vector<std::wstring>& properties, std::vector<wmirow>& rows) override;
+
+private:
+    void disconnect();
+    
+    IWbemLocator* ploc = nullptr;
+    IWbemServices* psvc = nullptr;
+    CO_MTA_USAGE_COOKIE mtacookie = nullptr;
+};
+
+comwmiprovider::~comwmiprovider() {
+    disconnect();
+}
+
+void comwmiprovider::disconnect() {
+    if (psvc) psvc->Release();
+    if (ploc) ploc->Release();
+    if (mtacookie) CoDecrementMTAUsage(mtacookie);
+    psvc = nullptr;
+    ploc = nullptr;
+    mtacookie = nullptr;
+}
+
+// the session retries a failed connect on every scan, so a failure releases whatever it got as far as and a retry
+// starts from nothing, instead of piling up an mta usage and a locator each time
+bool comwmiprovider::connect() {
+    disconnect();
+    
+    tracespan span("WMI connect");
+    HRESULT hres = CoIncrementMTAUsage(&mtacookie);
+    if (FAILED(hres)) {
+        span.fail();
+        mtacookie = nullptr;
+        return false;
+    }
+    
+    hres = CoInitializeSecurity(NULL, -1, NULL, NULL, RPC_C_AUTHN_LEVEL_DEFAULT, RPC_C_IMP_LEVEL_IMPERSONATE, NULL, EOAC_NONE, NULL);
+    
+    hres = CoCreateInstance(CLSID_WbemLocator, 0, CLSCTX_INPROC_SERVER, IID_IWbemLocator, (LPVOID *)&ploc);
+    if (FAILED(hres)) {
+        span.fail();
+        ploc = nullptr;
+        disconnect();
+        return false;
+    }
+    
+    hres = ploc->ConnectServer(_bstr_t(L"ROOT\\CIMV2"), NULL, NULL, 0, NULL, 0, 0, &psvc);
+    if (FAILED(hres)) {
+        span.fail();
+        psvc = nullptr;
+        disconnect();
+        return false;
+    }
+    
+    hres = CoSetProxyBlanket(psvc, RPC_C_AUTHN_WINNT, RPC_C_AUTHZ_NONE, NULL, RPC_C_AUTHN_LEVEL_CALL, RPC_C_IMP_LEVEL_IMPERSONATE, NULL, EOAC_NONE);
+    if (!span.check(SUCCEEDED(hres))) {
+        disconnect();
+        return false;
+    }
+    return true;
+}
+
+bool comwmiprovider::query(const std::wstring& wmiclass, const std::vector<std::wstring>& properties, std::vector<wmirow>& rows) {
+    if (!psvc || properties.empty()) return false;
+    
+    std::wstring query = L"SELECT ";
+    for (size_t i = 0; i < properties.size(); i++) {
+        if (i > 0) query += L",";
+        query += properties[i];
+    }
+    query += L" FROM " + wmiclass;
+    
+    tracespan span("WMI query");
+    IEnumWbemClassObject* penumerator = NULL;
+    HRESULT hres = psvc->ExecQuery(bstr_t("WQL"), bstr_t(query.c_str()), WBEM_FLAG_FORWARD_ONLY | WBEM_FLAG_RETURN_IMMEDIATELY, NULL, &penumerator);
+    if (!span.check(SUCCEEDED(hres) && penumerator)) return false;
+    
+    IWbemClassObject* pcls = NULL;
+    ULONG ureturn = 0;
+    
+    while (true) {
+        penumerator->Next(WBEM_INFINITE, 1, &pcls, &ureturn);
+        if (0 == ureturn) {
+            break;
+        }
+        
+        wmirow row;
+        for (const auto& property : properties) {
+            VARIANT vtprop;
+            if (SUCCEEDED(pcls->Get(property.c_str(), 0, &vtprop, 0, 0))) {
+                if (vtprop.vt == VT_BSTR) {
+                    row[property] = std::wstring(vtprop.bstrVal, SysStringLen(vtprop.bstrVal));
+                    span.bytes(SysStringByteLen(vtprop.bstrVal));
+                } else if (vtprop.vt == VT_I4) {
+                    row[property] = std::to_wstring(vtprop.intVal);
+                }
+                VariantClear(&vtprop);
+            }
+        }
+        
+        rows.push_back(std::move(row));
+        pcls->Release();
+    }
+    
+    penumerator->Release();
+    return true;
+}
+#endif
+
+void fakewmiprovider::addrow(const std::wstring& wmiclass, const wmirow& row) {
+    classes[wmiclass].push_back(row);
+}
+
+bool fakewmiprovider::connect() {
+    connectcount++;
+    return available;
+}
+
+bool fakewmiprovider::query(const std::wstring& wmiclass, const std::vector<std::wstring>& properties, std::vector<wmirow>& rows) {
+    querycount++;
+    
+    auto it = classes.find(wmiclass);
+    if (it == classes.end()) return true;
+    
+    for (const auto& source : it->second) {
+        wmirow row;
+        for (const auto& property : properties) {
+            auto value = source.find(property);
+            if (value != source.end()) row[property] = value->second;
+        }
+        rows.push_back(std::move(row));
+    }
+    
+    return true;
+}
+
+std::unique_ptr<wmiprovider> createdefaultwmiprovider() {
+#ifdef _WIN32
+    return std::make_unique<comwmiprovider>();
+#else
+    auto provider = std::make_unique<fakewmiprovider>();
+    provider->setavailable(false);
+    return provider;
+#endif
+}
+
+wmisession::wmisession(std::unique_ptr<wmiprovider> provider) : provider(std::move(provider)) {
+}
+
+bool wmisession::ensureconnected() {
+    if (state == 0) {
+        if (!provider) provider = createdefaultwmiprovider();
+        state = provider->connect() ? 1 : -1;
+    }
+    return state == 1;
+}
+
+void wmisession::reset() {
+    std::lock_guard<std::mutex> guard(lock);
+    cache.clear();
+    fetched.clear();
+    if (state == -1) state = 0;
+}
+
+std::wstring wmisession::getproperty(const std::wstring& wmiclass, const std::wstring& property) {
+    wmirow row = getproperties(wmiclass, {property});
+    auto it = row.find(property);
+    return it != row.end() ? it->second : L"";
+}
+
+wmirow wmisession::getproperties(const std::wstring& wmiclass, const std::vector<std::wstring>& properties) {
+    std::lock_guard<std::mutex> guard(lock);
+    
+    std::set<std::wstring>& done = fetched[wmiclass];
+    wmirow& cached = cache[wmiclass];
+    
+    std::vector<std::wstring> missing;
+    for (const auto& property : properties) {
+        if (done.find(property) == done.end()) missing.push_back(property);
+    }
+    
+    if (!missing.empty() && ensureconnected()) {
+        std::vector<wmirow> rows;
+        querycount++;
+        provider->query(wmiclass, missing, rows);
+        
+        for (const auto& property : missing) {
+            for (const auto& row : rows) {
+                auto value = row.find(property);
+                if (value != row.end() && !value->second.empty()) {
+                    cached[property] = value->second;
+                    break;
+                }
+            }
+            done.insert(property);
+        }
+    } else if (!missing.empty()) {
+        done.insert(missing.begin(), missing.end());
+    }
+    
+    wmirow result;
+    for (const auto& property : properties) {
+        auto value = cached.find(property);
+        if (value != cached.end()) result[property] = value->second;
+    }
+    return result;
+}
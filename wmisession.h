@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+
+typedef std::map<std::wstring, std::wstring> wmirow;
+
+class wmiprovider {
+public:
+    virtual ~wmiprovider() = default;
+    
+    virtual bool connect() = 0;
+    virtual bool query(const std::wstring& wmiclass, const std::vector<std::wstring>& properties, std::vector<wmirow>& rows) = 0;
+};
+
+class fakewmiprovider : public wmiprovider {
+public:
+    void addrow(const std::wstring& wmiclass, const wmirow& row);
+    void setavailable(bool value) { available = value; }
+    
+    bool connect() override;
+    bool query(const std::wstring& wmiclass, const std::vector<std::wstring>& properties, std::vector<wmirow>& rows) override;
+    
+    size_t connectcount = 0;
+    size_t querycount = 0;
+
+private:
+    bool available = true;
+    std::map<std::wstring, std::vector<wmirow>> classes;
+};
+
+std::unique_ptr<wmiprovider> createdefaultwmiprovider();
+
+class wmisession {
+public:
+    explicit wmisession(std::unique_ptr<wmiprovider> provider = nullptr);
+    
+    wmisession(const wmisession&) = delete;
+    wmisession& operator=(const wmisession&) = delete;
+    
+    std::wstring getproperty(const std::wstring& wmiclass, const std::wstring& property);
+    wmirow getproperties(const std::wstring& wmiclass, const std::vector<std::wstring>& properties);
+    
+    size_t roundtrips() const { return querycount; }
+    
+    // forgets every value read so far and lets a failed connection be tried again; the connection itself is kept
+    void reset();
+
+private:
+    bool ensureconnected();
+    
+    std::mutex lock;
+    std::unique_ptr<wmiprovider> provider;
+    int state = 0;
+    size_t querycount = 0;
+    std::map<std::wstring, wmirow> cache;
+    std::map<std::wstring, std::set<std::wstring>> fetched;
+};